@@ -2,8 +2,10 @@ INCLUDEPATH += $$PWD
 
 HEADERS  += \
     controller/poseseditingcontroller.hpp \
+    controller/imageprefetcher.hpp \
     controller/maincontroller.hpp
 
 SOURCES += \
     controller/poseseditingcontroller.cpp \
+    controller/imageprefetcher.cpp \
     controller/maincontroller.cpp
@@ -0,0 +1,122 @@
+#include "imageprefetcher.hpp"
+#include "view/rendering/imagecache.hpp"
+#include "view/rendering/meshcache.hpp"
+
+#include <QPointer>
+
+ImagePrefetcher::ImagePrefetcher(QObject *parent, ModelManager *modelManager)
+    : QObject(parent)
+    , m_modelManager(modelManager) {
+    connect(ImageCache::instance(), &ImageCache::imageLoaded,
+            this, &ImagePrefetcher::onImageLoaded);
+    setWindow(m_window);
+}
+
+int ImagePrefetcher::window() const {
+    return m_window;
+}
+
+void ImagePrefetcher::setWindow(int window) {
+    m_window = qMax(0, window);
+    // The images on both sides, the selected one and the one it replaces
+    ImageCache::instance()->setMaxImages(2 * m_window + 2);
+    if (m_window == 0) {
+        cancel();
+    }
+}
+
+void ImagePrefetcher::setImages(const QList<ImagePtr> &images) {
+    cancel();
+    m_images = images;
+    m_currentIndex = -1;
+}
+
+void ImagePrefetcher::setCurrentIndex(int index) {
+    if (index < 0 || index >= m_images.size()) {
+        cancel();
+        m_currentIndex = -1;
+        return;
+    }
+    if (m_currentIndex != -1 && index != m_currentIndex) {
+        m_direction = index > m_currentIndex ? 1 : -1;
+    }
+    m_currentIndex = index;
+
+    // The window moved, images that left it are dropped
+    m_queue.clear();
+    for (int offset = 1; offset <= m_window; offset++) {
+        int ahead = index + offset * m_direction;
+        if (ahead >= 0 && ahead < m_images.size()) {
+            m_queue.enqueue(m_images[ahead]);
+        }
+    }
+    for (int offset = 1; offset <= m_window; offset++) {
+        int behind = index - offset * m_direction;
+        if (behind >= 0 && behind < m_images.size()) {
+            m_queue.enqueue(m_images[behind]);
+        }
+    }
+    if (m_prefetchingImage.isEmpty()) {
+        prefetchNext();
+    }
+}
+
+void ImagePrefetcher::cancel() {
+    // The image that is being decoded can't be stopped, it still ends up in the cache
+    m_queue.clear();
+}
+
+void ImagePrefetcher::onImageLoaded(const QString &path) {
+    if (path == m_prefetchingImage) {
+        m_prefetchingImage.clear();
+        prefetchNext();
+    }
+}
+
+void ImagePrefetcher::prefetchNext() {
+    ImageCache *imageCache = ImageCache::instance();
+    while (!m_queue.isEmpty()) {
+        ImagePtr image = m_queue.dequeue();
+        prefetchMeshes(image);
+        const QString path = image->absoluteImagePath();
+        QImage decodedImage;
+        if (imageCache->isLoading(path) || imageCache->find(path, decodedImage)) {
+            continue;
+        }
+        m_prefetchingImage = path;
+        // Continues in onImageLoaded
+        imageCache->load(path);
+        return;
+    }
+}
+
+void ImagePrefetcher::prefetchMeshes(const ImagePtr &image) {
+    // Loading the poses lazily reads them from disk, which must not block the GUI thread
+    ModelManager *modelManager = m_modelManager;
+    QPointer<ImagePrefetcher> prefetcher(this);
+    QMetaObject::invokeMethod(modelManager, [modelManager, prefetcher, image]() {
+        QSet<QString> objectModelPaths;
+        for (const PosePtr &pose : modelManager->posesForImage(*image)) {
+            objectModelPaths.insert(pose->objectModel()->absolutePath());
+        }
+        if (objectModelPaths.isEmpty() || prefetcher.isNull()) {
+            return;
+        }
+        // The MeshCache is only used on the GUI thread
+        QMetaObject::invokeMethod(prefetcher.data(), [prefetcher, objectModelPaths]() {
+            if (prefetcher) {
+                prefetcher->loadMeshes(objectModelPaths);
+            }
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void ImagePrefetcher::loadMeshes(const QSet<QString> &objectModelPaths) {
+    MeshCache *meshCache = MeshCache::instance();
+    for (const QString &objectModelPath : objectModelPaths) {
+        // Formats the MeshLoader doesn't support need a scene and are loaded once displayed
+        if (meshCache->status(objectModelPath) == MeshCache::NotLoaded) {
+            meshCache->load(objectModelPath);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef IMAGEPREFETCHER_H
+#define IMAGEPREFETCHER_H
+
+#include "model/image.hpp"
+#include "model/modelmanager.hpp"
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QQueue>
+#include <QSet>
+
+/*!
+ * \brief The ImagePrefetcher class loads the images around the selected one in the background, so
+ * that stepping through the images doesn't wait for decoding and loading each of them.
+ *
+ * For every image in the window before and after the selected one, the poses are requested on the
+ * thread of the model manager, which fills its pose cache when loading poses lazily. The meshes of
+ * their object models are parsed into the MeshCache afterwards, which evicts them again if they
+ * aren't displayed before its limit is reached. The image is decoded into the ImageCache. The
+ * images ahead in the direction of navigation come first. Only one image is decoded at a time, the
+ * queued images are replaced whenever the selected image changes.
+ */
+class ImagePrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    ImagePrefetcher(QObject *parent, ModelManager *modelManager);
+
+    //! The number of images before and after the selected one, 0 disables prefetching
+    int window() const;
+    void setWindow(int window);
+
+public Q_SLOTS:
+    void setImages(const QList<ImagePtr> &images);
+    //! Prefetches the images around the image at the given index of the images
+    void setCurrentIndex(int index);
+    //! Drops all images that are queued for prefetching
+    void cancel();
+
+private Q_SLOTS:
+    void onImageLoaded(const QString &path);
+
+private:
+    void prefetchNext();
+    //! Resolves the object models of the poses of the image on the thread of the model manager
+    void prefetchMeshes(const ImagePtr &image);
+    void loadMeshes(const QSet<QString> &objectModelPaths);
+
+private:
+    ModelManager *m_modelManager;
+    QList<ImagePtr> m_images;
+    int m_window = 2;
+    int m_currentIndex = -1;
+    //! 1 when navigating forward, -1 when navigating backward
+    int m_direction = 1;
+    QQueue<ImagePtr> m_queue;
+    //! The image that is being decoded, empty if none is
+    QString m_prefetchingImage;
+};
+
+#endif // IMAGEPREFETCHER_H
@@ -2,10 +2,12 @@
 #include "view/gallery/galleryimagemodel.hpp"
 #include "model/jsonloadandstorestrategy.hpp"
 #include "model/pythonloadandstorestrategy.hpp"
+#include "model/journalloadandstorestrategy.hpp"
 
 #include <QSplashScreen>
 #include <QFile>
 #include <QApplication>
+#include <QMutexLocker>
 
 MainController::MainController(int &argc, char **argv, int)
     : QApplication(argc, argv)
@@ -36,6 +38,7 @@ void MainController::initialize() {
     selectCurrentStrategy();
 
     m_modelManager.reset(new CachingModelManager(m_currentStrategy));
+    m_modelManager->applySettings(m_currentSettings);
     // This connects the signal of the MainController to the ModelManager's reload
     // method to ensure that data loading happens on the model manager thread
     connect(this, &MainController::reloadingData,
@@ -66,6 +69,7 @@ void MainController::initialize() {
 
     // Call here since we need the model manager and the main window
     m_poseEditingModel.reset(new PosesEditingController(Q_NULLPTR, m_modelManager.get(), m_mainWindow.get()));
+    m_poseEditingModel->applySettings(m_currentSettings);
 
     // This makes the ModelManager load data - don't call it before creating the MainWindow as we
     // want to show the progress loading view in the ModelManager state change callback
@@ -82,6 +86,8 @@ void MainController::initializeStrategies() {
             = JsonLoadAndStoreStrategyPtr(new JsonLoadAndStoreStrategy);
     m_strategies[Settings::UsedLoadAndStoreStrategy::Python]
             = PythonLoadAndStoreStrategyPtr(new PythonLoadAndStoreStrategy);
+    m_strategies[Settings::UsedLoadAndStoreStrategy::Journal]
+            = JournalLoadAndStoreStrategyPtr(new JournalLoadAndStoreStrategy);
 
     // Move the strategies to a new thread to allow threadded data loading
     // This also means that we have to call the strategy's methods
@@ -94,7 +100,15 @@ void MainController::initializeStrategies() {
 
 void MainController::selectCurrentStrategy() {
     // Get strategy from the pre-loaded strategies
-    m_currentStrategy = m_strategies[m_currentSettings->usedLoadAndStoreStrategy()];
+    LoadAndStoreStrategyPtr strategy = m_strategies[m_currentSettings->usedLoadAndStoreStrategy()];
+    if (m_currentStrategy && m_currentStrategy != strategy) {
+        // The new strategy only sees what the previous one has written to the poses file
+        QMutexLocker locker(m_currentStrategy->mutex());
+        m_currentStrategy->flush();
+    }
+    m_currentStrategy = strategy;
+    // The strategy might still be loading on the model manager's thread
+    QMutexLocker locker(m_currentStrategy->mutex());
     m_currentStrategy->applySettings(m_currentSettings);
 }
 
@@ -110,7 +124,8 @@ void MainController::onSettingsChanged(SettingsPtr settings) {
                    m_currentSettings->objectModelsPath() != settings->objectModelsPath() ||
                    m_currentSettings->posesFilePath() != settings->posesFilePath() ||
                    m_currentSettings->usedLoadAndStoreStrategy() != settings->usedLoadAndStoreStrategy() ||
-                   m_currentSettings->loadSaveScriptPath() != settings->loadSaveScriptPath();
+                   m_currentSettings->loadSaveScriptPath() != settings->loadSaveScriptPath() ||
+                   m_currentSettings->lazyPoseLoading() != settings->lazyPoseLoading();
     // We need to reset the stored currentSettings like this here because we need settings
     // that are independend of the settings of the settings store because those might get
     // altered but we want to be able to compare if something has changed
@@ -118,6 +133,8 @@ void MainController::onSettingsChanged(SettingsPtr settings) {
     m_currentSettings.reset(new Settings(tmp));
     selectCurrentStrategy();
     m_modelManager->setLoadAndStoreStrategy(m_currentStrategy);
+    m_modelManager->applySettings(m_currentSettings);
+    m_poseEditingModel->applySettings(m_currentSettings);
     if (changed) {
         // Emit the signal to load data threadded, directly calling the methods
         // does not do anything threadded
@@ -131,7 +148,19 @@ void MainController::onReloadViewsRequested() {
     Q_EMIT reloadingData();
 }
 
-void MainController::onModelManagerStateChanged(ModelManager::State state, const QString &error) {
+void MainController::onModelManagerStateChanged(ModelManager::State state,
+                                                const QString &error,
+                                                int progress) {
+    if (state == ModelManager::Loading && progress >= 0) {
+        // Progress update while the progress view or splash screen is already shown
+        if (m_initialized) {
+            m_mainWindow->setDataLoadingProgress(progress);
+        } else {
+            m_splashScreen->setMaximum(100);
+            m_splashScreen->setProgress(progress);
+        }
+        return;
+    }
     // First hide the progress viwe (e.g. for Ready or ErrorOccured)
     m_mainWindow->showDataLoadingProgressView(false);
     if (state == ModelManager::Ready && !m_initialized) {
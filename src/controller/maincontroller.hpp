@@ -42,7 +42,8 @@ private Q_SLOTS:
     void onSettingsChanged(SettingsPtr settings);
     void onReloadViewsRequested();
     void onModelManagerStateChanged(ModelManager::State state,
-                                    const QString &error);
+                                    const QString &error,
+                                    int progress);
 
 private:
     /*!
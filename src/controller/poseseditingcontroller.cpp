@@ -13,13 +13,25 @@
 PosesEditingController::PosesEditingController(QObject *parent, ModelManager *modelManager, MainWindow *mainWindow)
     : QObject(parent)
     , m_modelManager(modelManager)
-    , m_mainWindow(mainWindow) {
+    , m_mainWindow(mainWindow)
+    , m_imagePrefetcher(new ImagePrefetcher(this, modelManager)) {
 
     // Check whether we have poses to save before the manager reloads
     connect(modelManager, &ModelManager::stateChanged,
             this, &PosesEditingController::modelManagerStateChanged);
     connect(modelManager, &ModelManager::dataChanged,
             this, &PosesEditingController::onDataChanged);
+    // Fine-grained changes of the folders don't require resetting the editor
+    connect(modelManager, &ModelManager::imagesAdded,
+            this, &PosesEditingController::onImagesAddedOrRemoved);
+    connect(modelManager, &ModelManager::imagesRemoved,
+            this, &PosesEditingController::onImagesAddedOrRemoved);
+    connect(modelManager, &ModelManager::imagesModified,
+            this, &PosesEditingController::onImagesModified);
+    connect(modelManager, &ModelManager::objectModelsAdded,
+            this, &PosesEditingController::onObjectModelsAdded);
+    connect(modelManager, &ModelManager::objectModelsRemoved,
+            this, &PosesEditingController::onObjectModelsRemoved);
 
     // Connect the PoseEditor and PoseViewer to the PoseEditingController
     connect(this, &PosesEditingController::selectedPoseChanged,
@@ -73,6 +85,10 @@ PosesEditingController::PosesEditingController(QObject *parent, ModelManager *mo
             this, &PosesEditingController::onSelectedObjectModelChanged);
 }
 
+void PosesEditingController::applySettings(SettingsPtr settings) {
+    m_imagePrefetcher->setWindow(settings->prefetchWindow());
+}
+
 void PosesEditingController::selectPose(PosePtr pose) {
     if (!m_selectedPose.isNull()) {
         disconnect(m_selectedPose.get(), &Pose::positionChanged,
@@ -182,10 +198,13 @@ void PosesEditingController::onPoseRotationChanged(QQuaternion /*rotation*/) {
     onPoseChanged();
 }
 
-void PosesEditingController::modelManagerStateChanged(ModelManager::State state) {
+void PosesEditingController::modelManagerStateChanged(ModelManager::State state,
+                                                      const QString &/*error*/,
+                                                      int progress) {
     // We do not need to disable the UI here because the main window is
-    // displaying a modal progress bar
-    if (state == ModelManager::Loading) {
+    // displaying a modal progress bar. Only save when loading starts, not
+    // on every progress update.
+    if (state == ModelManager::Loading && progress < 0) {
         _savePoses(true);
     }
 }
@@ -207,11 +226,42 @@ void PosesEditingController::onDataChanged(int /*data*/) {
     m_unmodifiedPoses.clear();
     m_images = m_modelManager->images();
     m_objectModels = m_modelManager->objectModels();
+    m_imagePrefetcher->setImages(m_images);
     m_mainWindow->poseEditor()->reset();
     m_mainWindow->poseEditor()->setImages(m_images);
     m_mainWindow->poseViewer()->reset();
 }
 
+void PosesEditingController::onImagesAddedOrRemoved() {
+    QList<ImagePtr> images = m_modelManager->images();
+    if (!m_currentImage.isNull() && !images.contains(m_currentImage)) {
+        // The image that is being edited is gone, i.e. we have to reset everything
+        onDataChanged(Data::Images);
+        return;
+    }
+    m_images = images;
+    m_imagePrefetcher->setImages(m_images);
+    if (!m_currentImage.isNull()) {
+        m_imagePrefetcher->setCurrentIndex(m_images.indexOf(m_currentImage));
+    }
+    m_mainWindow->poseEditor()->setImages(m_images);
+}
+
+void PosesEditingController::onImagesModified(const QList<ImagePtr> &images) {
+    if (!m_currentImage.isNull() && images.contains(m_currentImage)) {
+        m_mainWindow->poseViewer()->setImage(m_currentImage);
+    }
+}
+
+void PosesEditingController::onObjectModelsAdded() {
+    m_objectModels = m_modelManager->objectModels();
+}
+
+void PosesEditingController::onObjectModelsRemoved() {
+    // The poses of the removed object models have been removed, too
+    onDataChanged(Data::ObjectModels);
+}
+
 void PosesEditingController::saveUnsavedChanges() {
     _savePoses(true);
 }
@@ -252,30 +302,24 @@ bool PosesEditingController::_savePoses(bool showDialog) {
         // If show dialog, check result (which is the result from showing the dialog)
         // else result will be true because result = !showDialog (the latter is false in this case)
         if (!showDialog || result) {
-            qDebug() << "Adding " << m_posesToAdd.size() << " poses.";
-            for (const PosePtr &pose : m_posesToAdd) {
-                PosePtr newPose = m_modelManager->addPose(*pose);
-                // If there was an error saving the pose, the returned pointer will be null
-                noErrorSavingPoses &= !newPose.isNull();
+            qDebug() << "Adding " << m_posesToAdd.size() << " poses, saving "
+                     << posesToSave.size() << " poses and removing "
+                     << m_posesToRemove.size() << " poses.";
+            QList<QString> idsToRemove;
+            for (const PosePtr &pose : m_posesToRemove) {
+                idsToRemove.append(pose->id());
             }
-            qDebug() << "Saving " << posesToSave.size() << " poses.";
-            for (const PosePtr &pose : posesToSave) {
-                // No need to display a warning here because if something goes wrong
-                // the LoadAndStoreStrategy already notifies the MainWindow
-                bool updatedPoseSuccessfully = m_modelManager->updatePose(pose->id(),
-                                                                          pose->position(),
-                                                                          pose->rotation().toRotationMatrix());
-                noErrorSavingPoses &= updatedPoseSuccessfully;
-                if (updatedPoseSuccessfully) {
+            // All changes are persisted at once. No need to display a warning here
+            // because if something goes wrong the LoadAndStoreStrategy already
+            // notifies the MainWindow
+            noErrorSavingPoses = m_modelManager->savePoses(m_posesToAdd, posesToSave, idsToRemove);
+            if (noErrorSavingPoses) {
+                for (const PosePtr &pose : posesToSave) {
                     m_dirtyPoses[pose] = false;
                     m_unmodifiedPoses[pose->id()] = {.position = pose->position(),
                                                      .rotation = pose->rotation()};
                 }
             }
-            qDebug() << "Removing " << m_posesToRemove.size() << " poses.";
-            for (const PosePtr &pose : m_posesToRemove) {
-                noErrorSavingPoses  &= m_modelManager->removePose(pose->id());
-            }
         } else if (showDialog && !result) {
             qDebug() << "Not saving poses as requested.";
         }
@@ -334,6 +378,8 @@ void PosesEditingController::onSelectedImageChanged(int index) {
         m_mainWindow->poseViewer()->setImage(m_currentImage);
         m_mainWindow->poseViewer()->setPoses(m_posesForImage);
     }
+    // After displaying the image, its decoding and meshes come first
+    m_imagePrefetcher->setCurrentIndex(index);
     m_mainWindow->poseEditor()->reset3DViewOnPoseSelectionChange(true);
 }
 
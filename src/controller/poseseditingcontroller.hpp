@@ -4,6 +4,8 @@
 #include "model/pose.hpp"
 #include "model/image.hpp"
 #include "model/modelmanager.hpp"
+#include "settings/settings.hpp"
+#include "controller/imageprefetcher.hpp"
 
 #include "view/mainwindow.hpp"
 
@@ -20,6 +22,8 @@ public:
                                     ModelManager *modelManager,
                                     MainWindow *mainWindow);
 
+    void applySettings(SettingsPtr settings);
+
 Q_SIGNALS:
     void selectedPoseChanged(PosePtr selected, PosePtr deselected);
     void poseValuesChanged(PosePtr pose);
@@ -35,8 +39,12 @@ private Q_SLOTS:
     void onPoseChanged();
     void onPosePositionChanged(QVector3D position);
     void onPoseRotationChanged(QQuaternion rotation);
-    void modelManagerStateChanged(ModelManager::State state);
+    void modelManagerStateChanged(ModelManager::State state, const QString &error, int progress);
     void onDataChanged(int data);
+    void onImagesAddedOrRemoved();
+    void onImagesModified(const QList<ImagePtr> &images);
+    void onObjectModelsAdded();
+    void onObjectModelsRemoved();
 
     // Pose Recovering
     void add2DPoint(QPoint imagePoint);
@@ -83,6 +91,7 @@ private:
     PosePtr m_selectedPose;
     ModelManager *m_modelManager;
     MainWindow *m_mainWindow;
+    ImagePrefetcher *m_imagePrefetcher;
 
     ImagePtr m_currentImage;
     QList<ImagePtr> m_images;
@@ -2,12 +2,56 @@
 #include "misc/generalhelper.hpp"
 
 #include <QApplication>
+#include <QSet>
+#include <QFileInfo>
+#include <QCollator>
+#include <QThread>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+//! Share of the overall loading progress that loading the images takes, the
+//! rest is taken by the poses, loading the object models is quick
+static const int IMAGES_PROGRESS_RANGE = 20;
+
+const qint64 CachingModelManager::ESTIMATED_POSE_SIZE = 1024;
+
+//! The paths reported by the strategy and the ones of the entities might differ in
+//! separators or relative parts
+static QSet<QString> absoluteFilePaths(const QStringList &filePaths) {
+    QSet<QString> absolutePaths;
+    for (const QString &filePath : filePaths) {
+        absolutePaths.insert(QFileInfo(filePath).absoluteFilePath());
+    }
+    return absolutePaths;
+}
+
+//! Removes the pose from the list in constant time by moving the last pose of the
+//! list to its position, the indices hold the positions of the poses by their ID
+static void removeIndexedPose(QList<PosePtr> &poses, QHash<QString, int> &indices,
+                              const PosePtr &pose) {
+    auto it = indices.find(pose->id());
+    if (it == indices.end()) {
+        return;
+    }
+    int index = it.value();
+    indices.erase(it);
+    if (index != poses.size() - 1) {
+        poses[index] = poses.last();
+        indices[poses[index]->id()] = index;
+    }
+    poses.removeLast();
+}
 
 CachingModelManager::CachingModelManager(LoadAndStoreStrategyPtr loadAndStoreStrategy) : ModelManager(loadAndStoreStrategy) {
     connect(loadAndStoreStrategy.get(), &LoadAndStoreStrategy::dataChanged,
             this, &CachingModelManager::dataChanged);
     connect(loadAndStoreStrategy.get(), &LoadAndStoreStrategy::error,
             this, &CachingModelManager::onLoadAndStoreStrategyError);
+    connect(loadAndStoreStrategy.get(), &LoadAndStoreStrategy::progressChanged,
+            this, &CachingModelManager::onLoadAndStoreStrategyProgressChanged);
+    connect(loadAndStoreStrategy.get(), &LoadAndStoreStrategy::entitiesChanged,
+            this, &CachingModelManager::onLoadAndStoreStrategyEntitiesChanged);
 }
 
 CachingModelManager::~CachingModelManager() {
@@ -18,55 +62,459 @@ void CachingModelManager::setLoadAndStoreStrategy(LoadAndStoreStrategyPtr strate
             this, &CachingModelManager::dataChanged);
     disconnect(m_loadAndStoreStrategy.get(), &LoadAndStoreStrategy::error,
             this, &CachingModelManager::onLoadAndStoreStrategyError);
+    disconnect(m_loadAndStoreStrategy.get(), &LoadAndStoreStrategy::progressChanged,
+            this, &CachingModelManager::onLoadAndStoreStrategyProgressChanged);
+    disconnect(m_loadAndStoreStrategy.get(), &LoadAndStoreStrategy::entitiesChanged,
+            this, &CachingModelManager::onLoadAndStoreStrategyEntitiesChanged);
     m_loadAndStoreStrategy = strategy;
     connect(m_loadAndStoreStrategy.get(), &LoadAndStoreStrategy::dataChanged,
             this, &CachingModelManager::dataChanged);
     connect(m_loadAndStoreStrategy.get(), &LoadAndStoreStrategy::error,
             this, &CachingModelManager::onLoadAndStoreStrategyError);
+    connect(m_loadAndStoreStrategy.get(), &LoadAndStoreStrategy::progressChanged,
+            this, &CachingModelManager::onLoadAndStoreStrategyProgressChanged);
+    connect(m_loadAndStoreStrategy.get(), &LoadAndStoreStrategy::entitiesChanged,
+            this, &CachingModelManager::onLoadAndStoreStrategyEntitiesChanged);
+}
+
+void CachingModelManager::applySettings(SettingsPtr settings) {
+    QMutexLocker locker(&m_mutex);
+    m_lazyPoseLoading = settings->lazyPoseLoading();
+    m_poseCacheSize = qint64(settings->poseCacheSize()) * 1024 * 1024;
 }
 
 void CachingModelManager::createConditionalCache() {
     m_posesForImages.clear();
     m_posesForObjectModels.clear();
+    m_posesForIds.clear();
+    m_posesForImagesAndObjectModels.clear();
+    m_imageKeys.clear();
+    m_objectModelKeys.clear();
+    m_poseIndices.clear();
+    m_objectModelPoseIndices.clear();
+    m_poseIndices.reserve(m_poses.size());
+    m_objectModelPoseIndices.reserve(m_poses.size());
     for (int i = 0; i < m_poses.size(); i++) {
-        PosePtr pose = m_poses[i];
+        m_poseIndices.insert(m_poses[i]->id(), i);
+        addPoseToConditionalCache(m_poses[i]);
+    }
+}
+
+void CachingModelManager::appendPose(const PosePtr &pose) {
+    m_poseIndices.insert(pose->id(), m_poses.size());
+    m_poses.append(pose);
+    addPoseToConditionalCache(pose);
+}
+
+void CachingModelManager::addPoseToConditionalCache(const PosePtr &pose) {
+    //! Setup cache of poses that can be retrieved via an image
+    m_posesForImages[pose->image()->imagePath()].append(pose);
+    //! Setup cache of poses that can be retrieved via an object model
+    QList<PosePtr> &posesForObjectModel = m_posesForObjectModels[pose->objectModel()->path()];
+    m_objectModelPoseIndices.insert(pose->id(), posesForObjectModel.size());
+    posesForObjectModel.append(pose);
+    m_posesForIds.insert(pose->id(), pose);
+    //! Setup cache of poses that can be retrieved via an image and object model
+    m_posesForImagesAndObjectModels[imageAndObjectModelKey(pose)].append(pose);
+    if (m_posesLoadedLazily) {
+        //! Poses are modified on the GUI thread and saved right afterwards, i.e. the
+        //! image has to be pinned immediately and not through a queued connection
+        const QString imagePath = pose->image()->imagePath();
+        auto pinImage = [this, imagePath]() {
+            QMutexLocker locker(&m_mutex);
+            m_pinnedImagePaths.insert(imagePath);
+        };
+        connect(pose.get(), &Pose::positionChanged, this, pinImage, Qt::DirectConnection);
+        connect(pose.get(), &Pose::rotationChanged, this, pinImage, Qt::DirectConnection);
+    }
+}
+
+void CachingModelManager::removePoseFromConditionalCache(const PosePtr &pose) {
+    const QString imagePath = pose->image()->imagePath();
+    auto itImage = m_posesForImages.find(imagePath);
+    if (itImage != m_posesForImages.end()) {
+        itImage->removeOne(pose);
+        if (itImage->isEmpty()) {
+            m_posesForImages.erase(itImage);
+        }
+    }
+    const QString objectModelPath = pose->objectModel()->path();
+    auto itObjectModel = m_posesForObjectModels.find(objectModelPath);
+    if (itObjectModel != m_posesForObjectModels.end()) {
+        //! There are far more poses per object model than per image
+        removeIndexedPose(*itObjectModel, m_objectModelPoseIndices, pose);
+        if (itObjectModel->isEmpty()) {
+            m_posesForObjectModels.erase(itObjectModel);
+        }
+    }
+    m_posesForIds.remove(pose->id());
+    quint64 key;
+    if (findImageAndObjectModelKey(imagePath, objectModelPath, key)) {
+        auto itImageAndObjectModel = m_posesForImagesAndObjectModels.find(key);
+        if (itImageAndObjectModel != m_posesForImagesAndObjectModels.end()) {
+            itImageAndObjectModel->removeOne(pose);
+            if (itImageAndObjectModel->isEmpty()) {
+                m_posesForImagesAndObjectModels.erase(itImageAndObjectModel);
+            }
+        }
+    }
+}
+
+quint64 CachingModelManager::imageAndObjectModelKey(const PosePtr &pose) {
+    auto itImage = m_imageKeys.find(pose->image()->imagePath());
+    if (itImage == m_imageKeys.end()) {
+        itImage = m_imageKeys.insert(pose->image()->imagePath(), m_imageKeys.size());
+    }
+    auto itObjectModel = m_objectModelKeys.find(pose->objectModel()->path());
+    if (itObjectModel == m_objectModelKeys.end()) {
+        itObjectModel = m_objectModelKeys.insert(pose->objectModel()->path(), m_objectModelKeys.size());
+    }
+    return (quint64(itImage.value()) << 32) | itObjectModel.value();
+}
+
+bool CachingModelManager::findImageAndObjectModelKey(const QString &imagePath,
+                                                     const QString &objectModelPath,
+                                                     quint64 &key) const {
+    auto itImage = m_imageKeys.constFind(imagePath);
+    auto itObjectModel = m_objectModelKeys.constFind(objectModelPath);
+    if (itImage == m_imageKeys.constEnd() || itObjectModel == m_objectModelKeys.constEnd()) {
+        return false;
+    }
+    key = (quint64(itImage.value()) << 32) | itObjectModel.value();
+    return true;
+}
+
+bool CachingModelManager::touchCachedImage(const QString &imagePath) {
+    QMutexLocker locker(&m_mutex);
+    if (!m_posesLoadedLazily || !m_imagesForPaths.contains(imagePath)) {
+        //! Either all poses are loaded or we don't manage the image
+        return true;
+    }
+    int index = m_cachedImagePaths.indexOf(imagePath);
+    if (index < 0) {
+        return false;
+    }
+    m_cachedImagePaths.move(index, 0);
+    return true;
+}
+
+void CachingModelManager::ensurePosesLoaded(const QString &imagePath) {
+    if (touchCachedImage(imagePath)) {
+        return;
+    }
+    //! Only this thread loads poses lazily and changes the images, i.e. the image
+    //! can't get cached or removed while the poses are loaded without the lock
+    ImagePtr image;
+    QList<ObjectModelPtr> objectModels;
+    {
+        QMutexLocker locker(&m_mutex);
+        image = m_imagesForPaths.value(imagePath);
+        objectModels = m_objectModels;
+    }
+    //! Poses might be persisted on the GUI thread meanwhile, the strategy is
+    //! released before taking our lock as persisting takes them the other way round
+    QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
+    const QList<PosePtr> poses = m_loadAndStoreStrategy->loadPosesForImage(image, objectModels);
+    strategyLocker.unlock();
+    QMutexLocker locker(&m_mutex);
+    for (const PosePtr &pose : poses) {
+        appendPose(pose);
+    }
+    m_cachedImagePaths.prepend(imagePath);
+    evictPoses(imagePath);
+}
+
+void CachingModelManager::requestPosesLoaded(const QString &imagePath) const {
+    //! Loading poses lazily only fills the cache, the managed data stays the same
+    CachingModelManager *self = const_cast<CachingModelManager*>(this);
+    if (QThread::currentThread() == thread()) {
+        self->ensurePosesLoaded(imagePath);
+    } else if (!self->touchCachedImage(imagePath)) {
+        //! The strategy is only used to load data on the manager's thread
+        QMetaObject::invokeMethod(self, [self, imagePath]() {
+            self->ensurePosesLoaded(imagePath);
+        }, Qt::BlockingQueuedConnection);
+    }
+}
 
-        //! Setup cache of poses that can be retrieved via an image
-        QList<PosePtr> &posesForImage =
-                m_posesForImages[pose->image()->imagePath()];
-        posesForImage.append(pose);
+void CachingModelManager::evictPoses(const QString &currentImagePath) {
+    for (int i = m_cachedImagePaths.size() - 1;
+         i >= 0 && m_poses.size() * ESTIMATED_POSE_SIZE > m_poseCacheSize;
+         i--) {
+        const QString imagePath = m_cachedImagePaths[i];
+        if (imagePath == currentImagePath || m_pinnedImagePaths.contains(imagePath)) {
+            continue;
+        }
+        const QList<PosePtr> poses = m_posesForImages.value(imagePath);
+        for (const PosePtr &pose : poses) {
+            pose->disconnect(this);
+        }
+        removePosesFromCaches(poses);
+        m_cachedImagePaths.removeAt(i);
+    }
+}
 
-        //! Setup cache of poses that can be retrieved via an object model
-        QList<PosePtr> &posesForObjectModel =
-                m_posesForObjectModels[pose->objectModel()->path()];
-        posesForObjectModel.append(pose);
+void CachingModelManager::resetLazyPoses(bool posesLoadedLazily) {
+    m_posesLoadedLazily = posesLoadedLazily;
+    m_cachedImagePaths.clear();
+    m_pinnedImagePaths.clear();
+    m_imagesForPaths.clear();
+    if (m_posesLoadedLazily) {
+        for (const ImagePtr &image : m_images) {
+            m_imagesForPaths.insert(image->imagePath(), image);
+        }
+    }
+}
+
+void CachingModelManager::onLoadAndStoreStrategyEntitiesChanged(int data,
+                                                                const QStringList &added,
+                                                                const QStringList &removed,
+                                                                const QStringList &modified) {
+    if (data == Data::Images) {
+        applyImageChanges(added, removed, modified);
+    } else if (data == Data::ObjectModels) {
+        applyObjectModelChanges(added, removed, modified);
+    }
+}
+
+void CachingModelManager::applyImageChanges(const QStringList &added,
+                                            const QStringList &removed,
+                                            const QStringList &modified) {
+    const QSet<QString> removedFilePaths = absoluteFilePaths(removed);
+    const QSet<QString> modifiedFilePaths = absoluteFilePaths(modified);
+    QList<ImagePtr> remainingImages;
+    QList<ImagePtr> removedImages;
+    QList<ImagePtr> modifiedImages;
+    QSet<QString> remainingFilePaths;
+    for (const ImagePtr &image : m_images) {
+        QString filePath = QFileInfo(image->absoluteImagePath()).absoluteFilePath();
+        if (removedFilePaths.contains(filePath)) {
+            removedImages.append(image);
+        } else {
+            remainingImages.append(image);
+            remainingFilePaths.insert(filePath);
+            if (modifiedFilePaths.contains(filePath)) {
+                modifiedImages.append(image);
+            }
+        }
+    }
+
+    QStringList filesToAdd;
+    for (const QString &filePath : added) {
+        //! The image might be known already, e.g. if it was loaded by a reload in between
+        if (!remainingFilePaths.contains(QFileInfo(filePath).absoluteFilePath())) {
+            filesToAdd.append(filePath);
+        }
+    }
+    QList<ImagePtr> addedImages;
+    if (!filesToAdd.isEmpty()) {
+        QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
+        addedImages = m_loadAndStoreStrategy->loadImagesForFiles(filesToAdd);
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    //! The poses of removed images stay persisted but are no longer managed, same as when reloading
+    QList<PosePtr> posesToRemove;
+    for (const ImagePtr &image : removedImages) {
+        posesToRemove.append(m_posesForImages.value(image->imagePath()));
+        m_cachedImagePaths.removeOne(image->imagePath());
+        m_pinnedImagePaths.remove(image->imagePath());
+        m_imagesForPaths.remove(image->imagePath());
+    }
+    removePosesFromCaches(posesToRemove);
+
+    //! Insert at the position the image would have been loaded at
+    m_images = remainingImages;
+    QCollator collator;
+    collator.setNumericMode(true);
+    for (const ImagePtr &image : addedImages) {
+        auto position = std::lower_bound(
+            m_images.begin(),
+            m_images.end(),
+            image,
+            [&collator](const ImagePtr &i1, const ImagePtr &i2)
+            {
+                return collator.compare(i1->imagePath(), i2->imagePath()) < 0;
+            });
+        m_images.insert(position, image);
+        if (m_posesLoadedLazily) {
+            m_imagesForPaths.insert(image->imagePath(), image);
+        } else {
+            QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
+            const QList<PosePtr> poses = m_loadAndStoreStrategy->loadPosesForImage(image, m_objectModels);
+            strategyLocker.unlock();
+            for (const PosePtr &pose : poses) {
+                appendPose(pose);
+            }
+        }
+    }
+
+    locker.unlock();
+
+    if (!removedImages.isEmpty()) {
+        Q_EMIT imagesRemoved(removedImages);
+    }
+    if (!addedImages.isEmpty()) {
+        Q_EMIT imagesAdded(addedImages);
+    }
+    if (!modifiedImages.isEmpty()) {
+        Q_EMIT imagesModified(modifiedImages);
+    }
+}
+
+void CachingModelManager::applyObjectModelChanges(const QStringList &added,
+                                                  const QStringList &removed,
+                                                  const QStringList &modified) {
+    const QSet<QString> removedFilePaths = absoluteFilePaths(removed);
+    const QSet<QString> modifiedFilePaths = absoluteFilePaths(modified);
+    QList<ObjectModelPtr> remainingObjectModels;
+    QList<ObjectModelPtr> removedObjectModels;
+    QList<ObjectModelPtr> modifiedObjectModels;
+    QSet<QString> remainingFilePaths;
+    for (const ObjectModelPtr &objectModel : m_objectModels) {
+        QString filePath = QFileInfo(objectModel->absolutePath()).absoluteFilePath();
+        if (removedFilePaths.contains(filePath)) {
+            removedObjectModels.append(objectModel);
+        } else {
+            remainingObjectModels.append(objectModel);
+            remainingFilePaths.insert(filePath);
+            if (modifiedFilePaths.contains(filePath)) {
+                modifiedObjectModels.append(objectModel);
+            }
+        }
+    }
+
+    QStringList filesToAdd;
+    for (const QString &filePath : added) {
+        if (!remainingFilePaths.contains(QFileInfo(filePath).absoluteFilePath())) {
+            filesToAdd.append(filePath);
+        }
+    }
+    QList<ObjectModelPtr> addedObjectModels;
+    if (!filesToAdd.isEmpty()) {
+        QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
+        addedObjectModels = m_loadAndStoreStrategy->loadObjectModelsForFiles(filesToAdd);
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    QList<PosePtr> posesToRemove;
+    for (const ObjectModelPtr &objectModel : removedObjectModels) {
+        posesToRemove.append(m_posesForObjectModels.value(objectModel->path()));
+    }
+    removePosesFromCaches(posesToRemove);
+
+    m_objectModels = remainingObjectModels;
+    QCollator collator;
+    collator.setNumericMode(true);
+    for (const ObjectModelPtr &objectModel : addedObjectModels) {
+        auto position = std::lower_bound(
+            m_objectModels.begin(),
+            m_objectModels.end(),
+            objectModel,
+            [&collator](const ObjectModelPtr &o1, const ObjectModelPtr &o2)
+            {
+                return collator.compare(o1->path(), o2->path()) < 0;
+            });
+        m_objectModels.insert(position, objectModel);
+    }
+
+    if (!addedObjectModels.isEmpty()) {
+        if (m_posesLoadedLazily) {
+            //! The cached poses lack the ones of the new object models, the images
+            //! get loaded again when their poses are requested
+            QList<PosePtr> posesToDrop;
+            const QList<QString> cachedImagePaths = m_cachedImagePaths;
+            for (const QString &imagePath : cachedImagePaths) {
+                if (m_pinnedImagePaths.contains(imagePath)) {
+                    continue;
+                }
+                const QList<PosePtr> poses = m_posesForImages.value(imagePath);
+                for (const PosePtr &pose : poses) {
+                    pose->disconnect(this);
+                }
+                posesToDrop.append(poses);
+                m_cachedImagePaths.removeOne(imagePath);
+            }
+            removePosesFromCaches(posesToDrop);
+        } else {
+            QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
+            const QList<PosePtr> poses = m_loadAndStoreStrategy->loadPoses(m_images, addedObjectModels);
+            strategyLocker.unlock();
+            for (const PosePtr &pose : poses) {
+                appendPose(pose);
+            }
+        }
+    }
+
+    locker.unlock();
+
+    if (!removedObjectModels.isEmpty()) {
+        Q_EMIT objectModelsRemoved(removedObjectModels);
+    }
+    if (!addedObjectModels.isEmpty()) {
+        Q_EMIT objectModelsAdded(addedObjectModels);
+    }
+    if (!modifiedObjectModels.isEmpty()) {
+        Q_EMIT objectModelsModified(modifiedObjectModels);
     }
 }
 
 void CachingModelManager::onDataChanged(int data) {
     Q_EMIT stateChanged(State::Loading, QString());
+    m_progressOffset = 0;
+    m_progressRange = IMAGES_PROGRESS_RANGE;
+    //! Only this thread changes the images and object models, i.e. they can be read without the lock.
+    //! Nothing is loaded with the lock held to not block queries of other threads.
+    QList<ImagePtr> images = m_images;
+    QList<ObjectModelPtr> objectModels = m_objectModels;
+    bool posesLoadedLazily;
+    {
+        QMutexLocker locker(&m_mutex);
+        posesLoadedLazily = m_lazyPoseLoading;
+    }
+    //! Taken after our lock has been released, persisting poses takes them the other way round
+    QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
     if (data == Images) {
-        m_images = m_loadAndStoreStrategy->loadImages();
+        images = m_loadAndStoreStrategy->loadImages();
         // Add to flag that poses have been changed too
         data |= Data::Poses;
     }
     if (data == ObjectModels) {
-        m_objectModels = m_loadAndStoreStrategy->loadObjectModels();
+        objectModels = m_loadAndStoreStrategy->loadObjectModels();
         // Add to flag that poses have been changed too
         data |= Data::Poses;
     }
     // We need to load poses no matter what
-    m_poses = m_loadAndStoreStrategy->loadPoses(m_images, m_objectModels);
-    createConditionalCache();
+    // Poses get loaded again when they are requested if they are loaded lazily
+    QList<PosePtr> poses;
+    if (!posesLoadedLazily) {
+        m_progressOffset = IMAGES_PROGRESS_RANGE;
+        m_progressRange = 100 - IMAGES_PROGRESS_RANGE;
+        poses = m_loadAndStoreStrategy->loadPoses(images, objectModels);
+    }
+    strategyLocker.unlock();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_images = images;
+        m_objectModels = objectModels;
+        resetLazyPoses(posesLoadedLazily);
+        m_poses = poses;
+        createConditionalCache();
+    }
     Q_EMIT stateChanged(ModelManager::State::Ready, QString());
     Q_EMIT dataChanged(data);
 }
 
 QList<ImagePtr> CachingModelManager::images() const {
+    QMutexLocker locker(&m_mutex);
     return m_images;
 }
 
 QList<PosePtr> CachingModelManager::posesForImage(const Image &image) const  {
+    requestPosesLoaded(image.imagePath());
+    QMutexLocker locker(&m_mutex);
     if (m_posesForImages.find(image.imagePath()) != m_posesForImages.end()) {
         return m_posesForImages[image.imagePath()];
     }
@@ -75,10 +523,12 @@ QList<PosePtr> CachingModelManager::posesForImage(const Image &image) const  {
 }
 
 QList<ObjectModelPtr> CachingModelManager::objectModels() const {
+    QMutexLocker locker(&m_mutex);
     return m_objectModels;
 }
 
 QList<PosePtr> CachingModelManager::posesForObjectModel(const ObjectModel &objectModel) const {
+    QMutexLocker locker(&m_mutex);
     if (m_posesForObjectModels.find(objectModel.path()) != m_posesForObjectModels.end()) {
         return m_posesForObjectModels[objectModel.path()];
     }
@@ -87,29 +537,25 @@ QList<PosePtr> CachingModelManager::posesForObjectModel(const ObjectModel &objec
 }
 
 QList<PosePtr> CachingModelManager::poses() const {
+    QMutexLocker locker(&m_mutex);
     return m_poses;
 }
 
 PosePtr CachingModelManager::poseById(const QString &id) const {
-    PosePtr result;
-    auto itObj = std::find_if(
-        m_poses.begin(), m_poses.end(),
-        [id](PosePtr o) { return o->id() == id; }
-    );
-    if (itObj != m_poses.end()) {
-        result = *itObj;
-    }
-    return result;
-}
-
-QList<PosePtr> CachingModelManager::posesForImageAndObjectModel(const Image &image, const ObjectModel &objectModel) {
-    QList<PosePtr> posesForImageAndObjectModel;
-    for (PosePtr &pose : m_posesForImages[image.imagePath()]) {
-        if (pose->objectModel()->path().compare(objectModel.path()) == 0) {
-           posesForImageAndObjectModel.append(pose);
-        }
+    QMutexLocker locker(&m_mutex);
+    return m_posesForIds.value(id);
+}
+
+QList<PosePtr> CachingModelManager::posesForImageAndObjectModel(const Image &image,
+                                                               const ObjectModel &objectModel) const {
+    requestPosesLoaded(image.imagePath());
+    QMutexLocker locker(&m_mutex);
+    quint64 key;
+    if (findImageAndObjectModelKey(image.imagePath(), objectModel.path(), key)) {
+        return m_posesForImagesAndObjectModels.value(key);
     }
-    return posesForImageAndObjectModel;
+
+    return QList<PosePtr>();
 }
 
 PosePtr CachingModelManager::addPose(ImagePtr image,
@@ -126,17 +572,23 @@ PosePtr CachingModelManager::addPose(ImagePtr image,
 }
 
 PosePtr CachingModelManager::addPose(const Pose &pose) {
+    //! Load the existing poses first, the new one would be loaded twice otherwise
+    requestPosesLoaded(pose.image()->imagePath());
+    QMutexLocker locker(&m_mutex);
     // Persist the pose
-    if (!m_loadAndStoreStrategy->persistPose(pose, false)) {
+    QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
+    bool persisted = m_loadAndStoreStrategy->persistPose(pose, false);
+    strategyLocker.unlock();
+    if (!persisted) {
         //! if there is an error persisting the pose for any reason we should not add the pose to this manager
         return PosePtr();
     }
 
     //! pose has not yet been added
     PosePtr newPose(new Pose(pose));
-    m_poses.push_back(newPose);
-
-    createConditionalCache();
+    appendPose(newPose);
+    //! Receivers might query poses of images that have to be loaded first
+    locker.unlock();
 
     Q_EMIT poseAdded(newPose);
 
@@ -146,13 +598,8 @@ PosePtr CachingModelManager::addPose(const Pose &pose) {
 bool CachingModelManager::updatePose(const QString &id,
                                      const QVector3D &position,
                                      const QMatrix3x3 &rotation) {
-    PosePtr pose;
-    for (int i = 0; i < m_poses.size(); i++) {
-        if (m_poses[i]->id() == id) {
-            pose = m_poses[i];
-            break;
-        }
-    }
+    //! Not locked while setting the values, receivers of the pose's signals might query us
+    PosePtr pose = poseById(id);
 
     if (pose.isNull()) {
         //! this manager does not manage the given pose
@@ -165,14 +612,18 @@ bool CachingModelManager::updatePose(const QString &id,
     pose->setPosition(position);
     pose->setRotation(rotation);
 
-    if (!m_loadAndStoreStrategy->persistPose(*pose, false)) {
+    QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
+    bool persisted = m_loadAndStoreStrategy->persistPose(*pose, false);
+    strategyLocker.unlock();
+    if (!persisted) {
         // if there is an error persisting the pose for any reason we should not keep the new values
         pose->setPosition(previousPosition);
         pose->setRotation(previousRotation);
         return false;
     }
 
-    createConditionalCache();
+    // Image and object model of a pose never change, i.e. the conditional
+    // cache still holds the (shared) pose at the right places
 
     Q_EMIT poseUpdated(pose);
 
@@ -180,41 +631,144 @@ bool CachingModelManager::updatePose(const QString &id,
 }
 
 bool CachingModelManager::removePose(const QString &id) {
-    PosePtr pose;
-    for (int i = 0; i < m_poses.size(); i++) {
-        if (m_poses[i]->id() == id)
-            pose = m_poses[i];
-    }
+    QMutexLocker locker(&m_mutex);
+    PosePtr pose = m_posesForIds.value(id);
 
     if (!pose) {
         //! this manager does not manager the given pose
         return false;
     }
 
-    if (!m_loadAndStoreStrategy->persistPose(*pose, true)) {
+    QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
+    bool persisted = m_loadAndStoreStrategy->persistPose(*pose, true);
+    strategyLocker.unlock();
+    if (!persisted) {
         //! there was an error persistently removing the corresopndence, maybe wrong folder, maybe the pose didn't exist
         //! thus it doesn't make sense to remove the pose from this manager
         return false;
     }
 
-    for (int i = 0; i < m_poses.size(); i++) {
-        if (m_poses.at(i)->id() == id)
-            m_poses.removeAt(i);
+    removePosesFromCaches({pose});
+    locker.unlock();
+
+    Q_EMIT poseDeleted(pose);
+
+    return true;
+}
+
+bool CachingModelManager::removePoses(const QList<QString> &ids) {
+    return savePoses({}, {}, ids);
+}
+
+bool CachingModelManager::savePoses(const QList<PosePtr> &posesToAdd,
+                                    const QList<PosePtr> &posesToUpdate,
+                                    const QList<QString> &idsToRemove) {
+    for (const QList<PosePtr> &posesToLoad : {posesToAdd, posesToUpdate}) {
+        for (const PosePtr &pose : posesToLoad) {
+            requestPosesLoaded(pose->image()->imagePath());
+        }
+    }
+    QMutexLocker locker(&m_mutex);
+
+    //! Only persist poses that this manager actually manages
+    QList<PosePtr> posesToPersistUpdated;
+    QList<PosePtr> managedPosesToUpdate;
+    for (const PosePtr &pose : posesToUpdate) {
+        PosePtr managedPose = m_posesForIds.value(pose->id());
+        if (managedPose) {
+            posesToPersistUpdated.append(pose);
+            managedPosesToUpdate.append(managedPose);
+        }
+    }
+    QList<PosePtr> posesToRemove;
+    for (const QString &id : idsToRemove) {
+        PosePtr pose = m_posesForIds.value(id);
+        if (pose) {
+            posesToRemove.append(pose);
+        }
+    }
+
+    QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
+    bool persisted = m_loadAndStoreStrategy->persistPoses(posesToAdd, posesToPersistUpdated, posesToRemove);
+    strategyLocker.unlock();
+    if (!persisted) {
+        //! if there is an error persisting the poses for any reason we should not
+        //! apply any of the changes to this manager
+        return false;
     }
 
-    createConditionalCache();
+    QList<PosePtr> newPoses;
+    for (const PosePtr &pose : posesToAdd) {
+        PosePtr newPose(new Pose(*pose));
+        appendPose(newPose);
+        newPoses.append(newPose);
+    }
+    //! Receivers of the poses' signals and of ours might query poses of images that have
+    //! to be loaded first, the manager's thread needs the lock for that
+    locker.unlock();
+
+    for (int i = 0; i < managedPosesToUpdate.size(); i++) {
+        //! The poses might be the managed ones, setting the values again doesn't hurt
+        managedPosesToUpdate[i]->setPosition(posesToPersistUpdated[i]->position());
+        managedPosesToUpdate[i]->setRotation(posesToPersistUpdated[i]->rotation());
+    }
 
-    Q_EMIT poseDeleted(pose);
+    locker.relock();
+    //! Only after setting the values, which pins the images again
+    for (const PosePtr &pose : managedPosesToUpdate) {
+        m_pinnedImagePaths.remove(pose->image()->imagePath());
+    }
+    removePosesFromCaches(posesToRemove);
+    locker.unlock();
+
+    for (const PosePtr &pose : newPoses) {
+        Q_EMIT poseAdded(pose);
+    }
+    for (const PosePtr &pose : managedPosesToUpdate) {
+        Q_EMIT poseUpdated(pose);
+    }
+    for (const PosePtr &pose : posesToRemove) {
+        Q_EMIT poseDeleted(pose);
+    }
 
     return true;
 }
 
+void CachingModelManager::removePosesFromCaches(const QList<PosePtr> &poses) {
+    for (const PosePtr &pose : poses) {
+        removePoseFromConditionalCache(pose);
+        removeIndexedPose(m_poses, m_poseIndices, pose);
+    }
+}
+
 void CachingModelManager::reload() {
     Q_EMIT stateChanged(CachingModelManager::State::Loading, QString());
-    m_images = m_loadAndStoreStrategy->loadImages();
-    m_objectModels = m_loadAndStoreStrategy->loadObjectModels();
-    m_poses = m_loadAndStoreStrategy->loadPoses(m_images, m_objectModels);
-    createConditionalCache();
+    m_progressOffset = 0;
+    m_progressRange = IMAGES_PROGRESS_RANGE;
+    bool posesLoadedLazily;
+    {
+        QMutexLocker locker(&m_mutex);
+        posesLoadedLazily = m_lazyPoseLoading;
+    }
+    //! Nothing is loaded with the lock held to not block queries of other threads
+    QMutexLocker strategyLocker(m_loadAndStoreStrategy->mutex());
+    QList<ImagePtr> images = m_loadAndStoreStrategy->loadImages();
+    QList<ObjectModelPtr> objectModels = m_loadAndStoreStrategy->loadObjectModels();
+    QList<PosePtr> poses;
+    if (!posesLoadedLazily) {
+        m_progressOffset = IMAGES_PROGRESS_RANGE;
+        m_progressRange = 100 - IMAGES_PROGRESS_RANGE;
+        poses = m_loadAndStoreStrategy->loadPoses(images, objectModels);
+    }
+    strategyLocker.unlock();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_images = images;
+        m_objectModels = objectModels;
+        resetLazyPoses(posesLoadedLazily);
+        m_poses = poses;
+        createConditionalCache();
+    }
     Q_EMIT dataReady();
 }
 
@@ -222,6 +776,11 @@ void CachingModelManager::onLoadAndStoreStrategyError(const QString &error) {
     Q_EMIT stateChanged(CachingModelManager::State::ErrorOccured, error);
 }
 
+void CachingModelManager::onLoadAndStoreStrategyProgressChanged(int progress) {
+    Q_EMIT stateChanged(CachingModelManager::State::Loading, QString(),
+                        m_progressOffset + progress * m_progressRange / 100);
+}
+
 void CachingModelManager::dataReady() {
     Q_EMIT stateChanged(CachingModelManager::State::Ready, QString());
     Q_EMIT dataChanged(Data::Images | Data::ObjectModels | Data::Poses);
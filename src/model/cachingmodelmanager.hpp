@@ -4,14 +4,28 @@
 #include "modelmanager.hpp"
 #include "loadandstorestrategy.hpp"
 #include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
 #include <QString>
 #include <QList>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QMutex>
 
 /*!
  * \brief The CachingModelManager class implements the ModelManager interface. To improve the speed of the application
  * this manager chaches the list of entities and refreshes them when necessary.
+ *
+ * With lazy pose loading enabled only images and object models are loaded on reload. The poses of an image are
+ * loaded when they are requested for the first time and kept in a least recently used cache whose size is limited
+ * by the pose cache size of the settings. Images whose poses have been modified but not saved yet are never
+ * evicted. In this mode poses(), posesForObjectModel() and poseById() only know the poses of the cached images.
+ *
+ * The manager lives on its own thread but is queried and modifies poses on the GUI thread, i.e. all cached
+ * data is guarded by a mutex. Poses that are loaded lazily are always loaded on the manager's thread, a query
+ * on another thread waits for it. All calls of the strategy are serialized by the strategy's mutex, our mutex
+ * is never taken while holding it.
  */
 class CachingModelManager : public ModelManager
 {
@@ -26,6 +40,12 @@ public:
 
     void setLoadAndStoreStrategy(LoadAndStoreStrategyPtr strategy) override;
 
+    /*!
+     * \brief applySettings sets whether poses are loaded lazily and how many of them are kept.
+     * Switching between lazy and eager loading takes effect with the next reload.
+     */
+    void applySettings(SettingsPtr settings) override;
+
     QList<ImagePtr> images() const override;
 
     QList<PosePtr> posesForImage(const Image &image) const override;
@@ -39,7 +59,7 @@ public:
     PosePtr poseById(const QString &id) const override;
 
     QList<PosePtr> posesForImageAndObjectModel(const Image &image,
-                                               const ObjectModel &objectModel) override;
+                                               const ObjectModel &objectModel) const override;
 
     PosePtr addPose(ImagePtr image,
                     ObjectModelPtr objectModel,
@@ -54,6 +74,12 @@ public:
 
     bool removePose(const QString &id) override;
 
+    bool removePoses(const QList<QString> &ids) override;
+
+    bool savePoses(const QList<PosePtr> &posesToAdd,
+                   const QList<PosePtr> &posesToUpdate,
+                   const QList<QString> &idsToRemove) override;
+
 public Q_SLOTS:
     void reload() override;
 
@@ -62,14 +88,96 @@ private Q_SLOTS:
     void dataReady();
     void onDataChanged(int data);
     void onLoadAndStoreStrategyError(const QString &error);
+    void onLoadAndStoreStrategyProgressChanged(int progress);
+    void onLoadAndStoreStrategyEntitiesChanged(int data,
+                                               const QStringList &added,
+                                               const QStringList &removed,
+                                               const QStringList &modified);
 
 private:
     /*!
-     * \brief createConditionalCache sets up the cache of poses that
-     * can be retrieved for an image or for an object model.
+     * \brief createConditionalCache sets up the cache of poses that can be retrieved
+     * for an image, for an object model, for both combined or by their ID.
      */
     void createConditionalCache();
 
+    /*!
+     * \brief addPoseToConditionalCache adds the given pose to the per-image,
+     * per-object-model and ID caches without rebuilding them.
+     */
+    void addPoseToConditionalCache(const PosePtr &pose);
+
+    /*!
+     * \brief removePoseFromConditionalCache removes the given pose from the per-image,
+     * per-object-model and ID caches. Only the lists of the pose's image and object model
+     * are touched.
+     */
+    void removePoseFromConditionalCache(const PosePtr &pose);
+
+    //! Appends the pose to the list of poses and adds it to the conditional cache
+    void appendPose(const PosePtr &pose);
+
+    /*!
+     * \brief removePosesFromCaches removes the given poses from the list of poses and the
+     * conditional cache. Each pose is looked up through its index, i.e. the cost doesn't
+     * depend on the total number of poses.
+     */
+    void removePosesFromCaches(const QList<PosePtr> &poses);
+
+    /*!
+     * \brief imageAndObjectModelKey returns the key of the given pose's image and object model
+     * in the cache of poses for images and object models. The paths are interned, i.e. receive
+     * a number the first time they are encountered, to not have to compare strings on lookup.
+     */
+    quint64 imageAndObjectModelKey(const PosePtr &pose);
+
+    /*!
+     * \brief findImageAndObjectModelKey looks up the key of the given image and object model
+     * without interning the paths.
+     * \return false if no pose for the image and object model has been cached yet
+     */
+    bool findImageAndObjectModelKey(const QString &imagePath,
+                                    const QString &objectModelPath,
+                                    quint64 &key) const;
+
+    /*!
+     * \brief ensurePosesLoaded loads the poses of the image at the given path if poses are
+     * loaded lazily and they are not cached yet, and marks the image as most recently used.
+     * Evicts the least recently used images if the cache exceeds its size afterwards. Must
+     * only be called on the manager's thread, see requestPosesLoaded.
+     */
+    void ensurePosesLoaded(const QString &imagePath);
+
+    /*!
+     * \brief requestPosesLoaded calls ensurePosesLoaded on the manager's thread and waits for it
+     * if the poses of the image are not cached yet. Must not be called with the mutex locked as
+     * the manager's thread needs it to load the poses.
+     */
+    void requestPosesLoaded(const QString &imagePath) const;
+
+    /*!
+     * \brief touchCachedImage marks the image as most recently used.
+     * \return false if the poses of the image still have to be loaded
+     */
+    bool touchCachedImage(const QString &imagePath);
+
+    void evictPoses(const QString &currentImagePath);
+
+    //! Resets the lazily loaded poses after loading the images and object models
+    void resetLazyPoses(bool posesLoadedLazily);
+
+    /*!
+     * \brief applyImageChanges updates the images and their poses according to the changed
+     * image files without reloading the other images.
+     */
+    void applyImageChanges(const QStringList &added,
+                           const QStringList &removed,
+                           const QStringList &modified);
+
+    void applyObjectModelChanges(const QStringList &added,
+                                 const QStringList &removed,
+                                 const QStringList &modified);
+
 private:
     //! The pattern that is used to load maybe existing segmentation images
     QString m_segmentationImagePattern;
@@ -83,6 +191,37 @@ private:
     QMap<QString, QList<PosePtr>> m_posesForObjectModels;
     //! The list of the object image poses
     QList<PosePtr> m_poses;
+    //! Positions of the poses in m_poses and in their list of m_posesForObjectModels by pose ID.
+    //! Removing a pose moves the last pose of the list to its position.
+    QHash<QString, int> m_poseIndices;
+    QHash<QString, int> m_objectModelPoseIndices;
+    //! Index to retrieve poses by their ID without scanning the list of poses
+    QHash<QString, PosePtr> m_posesForIds;
+    //! Convenience map to store poses for a combination of image and object model
+    QHash<quint64, QList<PosePtr>> m_posesForImagesAndObjectModels;
+    //! Interned image and object model paths that make up the keys of the map above
+    QHash<QString, quint32> m_imageKeys;
+    QHash<QString, quint32> m_objectModelKeys;
+    //! The part of the overall loading progress that the strategy's progress maps to, i.e.
+    //! the share of the kind of data that is currently being loaded
+    int m_progressOffset = 0;
+    int m_progressRange = 100;
+
+    //! Rough memory footprint of a pose including the entries in the conditional cache
+    static const qint64 ESTIMATED_POSE_SIZE;
+    bool m_lazyPoseLoading = false;
+    //! In bytes
+    qint64 m_poseCacheSize = 0;
+    //! Whether the current poses have been loaded lazily, i.e. the mode at the last reload
+    bool m_posesLoadedLazily = false;
+    QHash<QString, ImagePtr> m_imagesForPaths;
+    //! The images whose poses are cached, most recently used first
+    QList<QString> m_cachedImagePaths;
+    //! Images with modified poses that have not been saved yet
+    QSet<QString> m_pinnedImagePaths;
+
+    //! Recursive because modifying poses pins their images through direct connections
+    mutable QRecursiveMutex m_mutex;
 
 };
 
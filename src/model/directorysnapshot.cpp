@@ -0,0 +1,57 @@
+#include "directorysnapshot.hpp"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDateTime>
+
+DirectorySnapshot::DirectorySnapshot() {
+}
+
+DirectorySnapshot::DirectorySnapshot(const QString &path, const QStringList &nameFilters, bool recursive)
+    : m_path(path) {
+    if (!QFileInfo(path).isDir()) {
+        return;
+    }
+    m_valid = true;
+
+    QDir directory(path);
+    //! The iterator provides the file infos it read while listing the directory, i.e.
+    //! there is no separate stat per file
+    QDirIterator it(path, nameFilters, QDir::Files,
+                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        it.next();
+        QFileInfo fileInfo = it.fileInfo();
+        m_entries.insert(directory.relativeFilePath(fileInfo.filePath()),
+                         {fileInfo.size(), fileInfo.lastModified().toMSecsSinceEpoch()});
+    }
+}
+
+bool DirectorySnapshot::isValid() const {
+    return m_valid;
+}
+
+QString DirectorySnapshot::path() const {
+    return m_path;
+}
+
+void DirectorySnapshot::diff(const DirectorySnapshot &newer,
+                             QStringList &added,
+                             QStringList &removed,
+                             QStringList &modified) const {
+    QDir directory(m_path);
+    for (auto it = newer.m_entries.constBegin(); it != newer.m_entries.constEnd(); it++) {
+        auto oldEntry = m_entries.constFind(it.key());
+        if (oldEntry == m_entries.constEnd()) {
+            added.append(directory.filePath(it.key()));
+        } else if (oldEntry->size != it->size || oldEntry->lastModified != it->lastModified) {
+            modified.append(directory.filePath(it.key()));
+        }
+    }
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); it++) {
+        if (!newer.m_entries.contains(it.key())) {
+            removed.append(directory.filePath(it.key()));
+        }
+    }
+}
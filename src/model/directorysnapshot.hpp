@@ -0,0 +1,54 @@
+#ifndef DIRECTORYSNAPSHOT_H
+#define DIRECTORYSNAPSHOT_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+/*!
+ * \brief The DirectorySnapshot class records the names, sizes and modification dates of the files
+ * in a directory. Comparing two snapshots of the same directory yields the files that have been added,
+ * removed or modified in between, which allows to react to a change of the directory without reloading
+ * all of its files.
+ */
+class DirectorySnapshot {
+
+public:
+    //! Creates an invalid snapshot, i.e. one that no changes can be computed against
+    DirectorySnapshot();
+
+    /*!
+     * \brief DirectorySnapshot takes a snapshot of the files in the directory at the given path.
+     * \param path the path to the directory
+     * \param nameFilters the wildcards of the files to include, e.g. *.png
+     * \param recursive whether to include the files of subdirectories
+     */
+    DirectorySnapshot(const QString &path, const QStringList &nameFilters, bool recursive);
+
+    //! false if the snapshot is default-constructed or the path was no directory
+    bool isValid() const;
+
+    QString path() const;
+
+    /*!
+     * \brief diff computes the changes from this snapshot to the given newer snapshot of the
+     * same directory. The files are returned as paths that start with the path of the directory.
+     */
+    void diff(const DirectorySnapshot &newer,
+              QStringList &added,
+              QStringList &removed,
+              QStringList &modified) const;
+
+private:
+    struct Entry {
+        qint64 size;
+        qint64 lastModified;
+    };
+
+    QString m_path;
+    bool m_valid = false;
+    //! Keyed by the path relative to the directory
+    QHash<QString, Entry> m_entries;
+};
+
+#endif // DIRECTORYSNAPSHOT_H
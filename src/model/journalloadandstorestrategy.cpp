@@ -0,0 +1,374 @@
+#include "journalloadandstorestrategy.hpp"
+#include "misc/global.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QMap>
+#include <QPair>
+#include <QMutexLocker>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QtConcurrent/QtConcurrent>
+
+const qint64 JournalLoadAndStoreStrategy::COMPACTION_THRESHOLD = 4 * 1024 * 1024;
+
+static const QString JOURNAL_SUFFIX = ".journal";
+static const QString COMPACTING_SUFFIX = ".compacting";
+static const QString KEY_OPERATION = "op";
+static const QString KEY_IMAGE_PATH = "img";
+static const QString KEY_POSE = "pose";
+static const QString KEY_ID = "id";
+static const QString KEY_OBJECT_MODEL_PATH = "obj";
+static const QString OPERATION_PUT = "put";
+static const QString OPERATION_DELETE = "del";
+
+JournalLoadAndStoreStrategy::JournalLoadAndStoreStrategy()
+    : m_compactionWatcher(new QFutureWatcher<CompactionResult>(this)) {
+    connect(m_compactionWatcher, &QFutureWatcher<CompactionResult>::finished,
+            this, &JournalLoadAndStoreStrategy::onCompactionFinished);
+}
+
+JournalLoadAndStoreStrategy::~JournalLoadAndStoreStrategy() {
+    // The snapshot must not be left half-written and the journal must not outlive
+    // the program, another strategy might modify the poses file in between
+    flush();
+}
+
+QString JournalLoadAndStoreStrategy::journalFilePath() const {
+    return m_posesFilePath + JOURNAL_SUFFIX;
+}
+
+QString JournalLoadAndStoreStrategy::compactingJournalFilePath() const {
+    return journalFilePath() + COMPACTING_SUFFIX;
+}
+
+bool JournalLoadAndStoreStrategy::persistPoses(const QList<PosePtr> &posesToAdd,
+                                               const QList<PosePtr> &posesToUpdate,
+                                               const QList<PosePtr> &posesToRemove) {
+    if (posesToAdd.isEmpty() && posesToUpdate.isEmpty() && posesToRemove.isEmpty()) {
+        return true;
+    }
+
+    // The journal lives next to the poses file, i.e. we need a valid poses file
+    if (!QFileInfo(m_posesFilePath).isFile()) {
+        Q_EMIT error(tr("Failed to persist poses. Poses file is not a file."));
+        return false;
+    }
+
+    QByteArray lines;
+    QList<QPair<QString, JournalEntry>> entries;
+    for (const QList<PosePtr> &posesToWrite : {posesToAdd, posesToUpdate}) {
+        for (const PosePtr &pose : posesToWrite) {
+            QJsonObject line;
+            line[KEY_OPERATION] = OPERATION_PUT;
+            line[KEY_IMAGE_PATH] = pose->image()->imagePath();
+            line[KEY_POSE] = jsonEntryFromPose(*pose);
+            lines += QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n';
+            entries.append({pose->id(), {pose->image()->imagePath(), line[KEY_POSE].toObject(), false}});
+        }
+    }
+    for (const PosePtr &pose : posesToRemove) {
+        QJsonObject line;
+        line[KEY_OPERATION] = OPERATION_DELETE;
+        line[KEY_IMAGE_PATH] = pose->image()->imagePath();
+        line[KEY_ID] = pose->id();
+        lines += QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n';
+        entries.append({pose->id(), {pose->image()->imagePath(), QJsonObject(), true}});
+    }
+
+    QFile journalFile(journalFilePath());
+    if (!journalFile.open(QFile::WriteOnly | QFile::Append)) {
+        Q_EMIT error(tr("Failed to persist poses. Poses journal could not be opened."));
+        return false;
+    }
+    if (journalFile.write(lines) != lines.size() || !journalFile.flush()) {
+        Q_EMIT error(tr("Failed to persist poses. Poses journal could not be written."));
+        return false;
+    }
+
+    if (m_journalRead) {
+        // Keep the journal in memory in sync to not have to read it again
+        for (const QPair<QString, JournalEntry> &entry : entries) {
+            if (!m_journalEntries.contains(entry.first)) {
+                m_journalOrder.append(entry.first);
+            }
+            m_journalEntries.insert(entry.first, entry.second);
+        }
+    }
+
+    if (journalFile.size() > COMPACTION_THRESHOLD) {
+        journalFile.close();
+        startCompaction();
+    }
+
+    return true;
+}
+
+QList<PosePtr> JournalLoadAndStoreStrategy::loadPoses(const QList<ImagePtr> &images,
+                                                      const QList<ObjectModelPtr> &objectModels) {
+    // Don't read the snapshot while it is being replaced
+    finishCompaction();
+
+    QList<PosePtr> poses = JsonLoadAndStoreStrategy::loadPoses(images, objectModels);
+    if (m_posesFilePath == Global::NO_PATH) {
+        return poses;
+    }
+
+    readJournals();
+    return replayJournal(poses, images, objectModels);
+}
+
+QList<PosePtr> JournalLoadAndStoreStrategy::loadPosesForImage(const ImagePtr &image,
+                                                              const QList<ObjectModelPtr> &objectModels) {
+    finishCompaction();
+
+    QList<PosePtr> poses = JsonLoadAndStoreStrategy::loadPosesForImage(image, objectModels);
+    if (m_posesFilePath == Global::NO_PATH) {
+        return poses;
+    }
+
+    if (!m_journalRead) {
+        readJournals();
+    }
+    return replayJournal(poses, {image}, objectModels);
+}
+
+void JournalLoadAndStoreStrategy::applySettings(SettingsPtr settings) {
+    if (settings->posesFilePath() != m_posesFilePath) {
+        flush();
+    }
+    JsonLoadAndStoreStrategy::applySettings(settings);
+    m_journalEntries.clear();
+    m_journalOrder.clear();
+    m_journalRead = false;
+}
+
+void JournalLoadAndStoreStrategy::flush() {
+    finishCompaction();
+    if (m_posesFilePath == Global::NO_PATH) {
+        return;
+    }
+    if (QFile::exists(journalFilePath()) || QFile::exists(compactingJournalFilePath())) {
+        startCompaction();
+        finishCompaction();
+    }
+}
+
+void JournalLoadAndStoreStrategy::readJournals() {
+    m_journalEntries.clear();
+    m_journalOrder.clear();
+    // A compacting journal is left over if the program exited during compaction or
+    // compaction failed, it's older than the current journal
+    readJournal(compactingJournalFilePath(), m_journalEntries, m_journalOrder);
+    readJournal(journalFilePath(), m_journalEntries, m_journalOrder);
+    m_journalRead = true;
+}
+
+QList<PosePtr> JournalLoadAndStoreStrategy::replayJournal(const QList<PosePtr> &poses,
+                                                          const QList<ImagePtr> &images,
+                                                          const QList<ObjectModelPtr> &objectModels) const {
+    if (m_journalEntries.isEmpty()) {
+        return poses;
+    }
+
+    QHash<QString, ImagePtr> imagesForPaths;
+    for (const ImagePtr &image : images) {
+        imagesForPaths.insert(image->imagePath(), image);
+    }
+    QHash<QString, ObjectModelPtr> objectModelsForPaths;
+    for (const ObjectModelPtr &objectModel : objectModels) {
+        objectModelsForPaths.insert(objectModel->path(), objectModel);
+    }
+    auto poseFromJournalEntry = [&imagesForPaths, &objectModelsForPaths](const QString &id,
+                                                                          const JournalEntry &entry) {
+        ImagePtr image = imagesForPaths.value(entry.imagePath);
+        ObjectModelPtr objectModel = objectModelsForPaths.value(entry.poseEntry[KEY_OBJECT_MODEL_PATH].toString());
+        if (!image || !objectModel) {
+            // Same as for the poses file, we skip poses of images or object models we don't manage
+            return PosePtr();
+        }
+        return poseFromJsonEntry(entry.poseEntry, id, image, objectModel);
+    };
+
+    QList<PosePtr> replayedPoses;
+    QSet<QString> replayedIds;
+    for (const PosePtr &pose : poses) {
+        auto it = m_journalEntries.constFind(pose->id());
+        if (it == m_journalEntries.constEnd()) {
+            replayedPoses.append(pose);
+            continue;
+        }
+        replayedIds.insert(pose->id());
+        if (!it->removed) {
+            PosePtr replayedPose = poseFromJournalEntry(pose->id(), *it);
+            if (replayedPose) {
+                replayedPoses.append(replayedPose);
+            }
+        }
+    }
+    for (const QString &id : m_journalOrder) {
+        const JournalEntry &entry = m_journalEntries[id];
+        if (replayedIds.contains(id) || entry.removed) {
+            continue;
+        }
+        PosePtr replayedPose = poseFromJournalEntry(id, entry);
+        if (replayedPose) {
+            replayedPoses.append(replayedPose);
+        }
+    }
+
+    return replayedPoses;
+}
+
+void JournalLoadAndStoreStrategy::readJournal(const QString &path,
+                                              QHash<QString, JournalEntry> &entries,
+                                              QList<QString> &order) {
+    QFile journalFile(path);
+    if (!journalFile.open(QFile::ReadOnly)) {
+        // No journal is perfectly fine, e.g. right after compaction
+        return;
+    }
+
+    while (!journalFile.atEnd()) {
+        QByteArray line = journalFile.readLine();
+        if (!line.endsWith('\n')) {
+            // Incomplete last line, i.e. the program crashed while writing
+            break;
+        }
+        QJsonDocument document = QJsonDocument::fromJson(line);
+        if (!document.isObject()) {
+            continue;
+        }
+        QJsonObject lineObject = document.object();
+        QString operation = lineObject[KEY_OPERATION].toString();
+        JournalEntry entry;
+        entry.imagePath = lineObject[KEY_IMAGE_PATH].toString();
+        QString id;
+        if (operation == OPERATION_PUT) {
+            entry.poseEntry = lineObject[KEY_POSE].toObject();
+            entry.removed = false;
+            id = entry.poseEntry[KEY_ID].toString();
+        } else if (operation == OPERATION_DELETE) {
+            entry.removed = true;
+            id = lineObject[KEY_ID].toString();
+        }
+        if (id.isEmpty()) {
+            continue;
+        }
+        if (!entries.contains(id)) {
+            order.append(id);
+        }
+        entries.insert(id, entry);
+    }
+}
+
+void JournalLoadAndStoreStrategy::startCompaction() {
+    if (m_compactionWatcher->isRunning()) {
+        return;
+    }
+
+    QString compactingPath = compactingJournalFilePath();
+    if (QFile::exists(compactingPath)) {
+        // Left over from a previous compaction that did not finish, the current
+        // journal is newer and has to be appended to it
+        QFile journalFile(journalFilePath());
+        if (journalFile.exists()) {
+            QFile compactingFile(compactingPath);
+            if (!journalFile.open(QFile::ReadOnly)
+                    || !compactingFile.open(QFile::WriteOnly | QFile::Append)
+                    || compactingFile.write(journalFile.readAll()) == -1) {
+                return;
+            }
+            journalFile.remove();
+        }
+    } else if (!QFile::rename(journalFilePath(), compactingPath)) {
+        return;
+    }
+
+    // New poses are written to a fresh journal while we compact
+    m_ignorePosesFileChanged = true;
+    m_compactionPending = true;
+    m_compactionWatcher->setFuture(QtConcurrent::run(&JournalLoadAndStoreStrategy::compact,
+                                                     m_posesFilePath, compactingPath));
+}
+
+JournalLoadAndStoreStrategy::CompactionResult JournalLoadAndStoreStrategy::compact(
+        const QString &posesFilePath,
+        const QString &compactingJournalFilePath) {
+    CompactionResult result;
+    QFile posesFile(posesFilePath);
+    if (!posesFile.open(QFile::ReadOnly)) {
+        return result;
+    }
+    QJsonDocument jsonDocument = QJsonDocument::fromJson(posesFile.readAll());
+    posesFile.close();
+    if (jsonDocument.isNull()) {
+        return result;
+    }
+
+    QHash<QString, JournalEntry> entries;
+    QList<QString> order;
+    readJournal(compactingJournalFilePath, entries, order);
+
+    QMap<QString, QList<QJsonObject>> entriesToWriteForImages;
+    QMap<QString, QSet<QString>> idsToRemoveForImages;
+    for (const QString &id : order) {
+        const JournalEntry &entry = entries[id];
+        if (entry.removed) {
+            idsToRemoveForImages[entry.imagePath].insert(id);
+        } else {
+            entriesToWriteForImages[entry.imagePath].append(entry.poseEntry);
+        }
+    }
+
+    QJsonObject jsonObject = jsonDocument.object();
+    applyChangesToJsonObject(jsonObject, entriesToWriteForImages, idsToRemoveForImages);
+
+    // QSaveFile writes to a temporary file and renames it, i.e. the
+    // snapshot is either the old one or the new one but never truncated
+    QSaveFile snapshotFile(posesFilePath);
+    if (!snapshotFile.open(QFile::WriteOnly)) {
+        return result;
+    }
+    snapshotFile.write(QJsonDocument(jsonObject).toJson());
+    if (!snapshotFile.commit()) {
+        return result;
+    }
+    result.posesFileWritten = true;
+    result.posesJson = jsonObject;
+    result.journalRemoved = QFile::remove(compactingJournalFilePath);
+    return result;
+}
+
+void JournalLoadAndStoreStrategy::onCompactionFinished() {
+    //! Persisting poses on the GUI thread might start or finish the compaction meanwhile
+    QMutexLocker locker(&m_mutex);
+    finishCompaction();
+}
+
+void JournalLoadAndStoreStrategy::finishCompaction() {
+    if (!m_compactionPending) {
+        return;
+    }
+    m_compactionWatcher->waitForFinished();
+    m_compactionPending = false;
+
+    CompactionResult result = m_compactionWatcher->result();
+    if (result.posesFileWritten) {
+        //! The poses file has been replaced, i.e. the mapped snapshot is outdated. Failing
+        //! to write the new one only means that the poses file gets parsed on the next load.
+        writePoseSnapshot(result.posesJson);
+    }
+    if (!result.journalRemoved) {
+        m_ignorePosesFileChanged = false;
+        Q_EMIT error(tr("Failed to compact the poses journal. It will be compacted "
+                        "again after the next changes."));
+    }
+    // Replacing the poses file removes it from the file system watcher
+    if (QFileInfo(m_posesFilePath).isFile()
+            && !m_fileSystemWatcher.files().contains(m_posesFilePath)) {
+        m_fileSystemWatcher.addPath(m_posesFilePath);
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef JOURNALLOADANDSTORESTRATEGY_H
+#define JOURNALLOADANDSTORESTRATEGY_H
+
+#include "jsonloadandstorestrategy.hpp"
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QJsonObject>
+#include <QFutureWatcher>
+
+/*!
+ * \brief The JournalLoadAndStoreStrategy class is a JsonLoadAndStoreStrategy that does not rewrite the
+ * poses file on every change. Instead, added, updated and removed poses are appended as single lines to
+ * a journal file next to the poses file (i.e. poses.json.journal), which makes saving independent of the
+ * number of stored poses. The poses file serves as a snapshot that the journal is replayed onto when
+ * loading poses. Once the journal passes COMPACTION_THRESHOLD bytes it is merged into the snapshot in
+ * the background.
+ *
+ * A crash while appending can at most leave an incomplete last line in the journal which is skipped
+ * when replaying it. The snapshot is replaced atomically when compacting.
+ *
+ * No other strategy reads the journal, i.e. it is compacted synchronously when the strategy gets
+ * flushed, destroyed or switched to another poses file.
+ */
+class JournalLoadAndStoreStrategy : public JsonLoadAndStoreStrategy
+{
+
+    Q_OBJECT
+
+public:
+    JournalLoadAndStoreStrategy();
+
+    ~JournalLoadAndStoreStrategy();
+
+    /*!
+     * \brief applySettings additionally drops the journal read into memory as the poses file
+     * might have changed. The journal of the previous poses file is compacted first.
+     */
+    void applySettings(SettingsPtr settings) override;
+
+    //! Merges the journal into the poses file and waits until it has been written
+    void flush() override;
+
+    bool persistPoses(const QList<PosePtr> &posesToAdd,
+                      const QList<PosePtr> &posesToUpdate,
+                      const QList<PosePtr> &posesToRemove) override;
+
+    /*!
+     * \brief loadPoses loads the poses of the snapshot, i.e. the poses file, and replays the
+     * journal onto them.
+     */
+    QList<PosePtr> loadPoses(const QList<ImagePtr> &images,
+                             const QList<ObjectModelPtr> &objectModels) override;
+
+    /*!
+     * \brief loadPosesForImage loads the poses of the image from the snapshot and replays the
+     * journal entries of the image onto them. The journal is only read on the first call, later
+     * changes are folded into it when persisting them.
+     */
+    QList<PosePtr> loadPosesForImage(const ImagePtr &image,
+                                     const QList<ObjectModelPtr> &objectModels) override;
+
+    //! Size of the journal in bytes after which it gets merged into the poses file
+    static const qint64 COMPACTION_THRESHOLD;
+
+private Q_SLOTS:
+    void onCompactionFinished();
+
+private:
+    struct CompactionResult {
+        bool posesFileWritten = false;
+        bool journalRemoved = false;
+        //! The content of the compacted poses file to create the binary snapshot from
+        QJsonObject posesJson;
+    };
+
+    struct JournalEntry {
+        QString imagePath;
+        //! The pose entry as it will be written to the poses file, empty if the pose was removed
+        QJsonObject poseEntry;
+        bool removed;
+    };
+
+    QString journalFilePath() const;
+    QString compactingJournalFilePath() const;
+    void startCompaction();
+    /*!
+     * \brief finishCompaction waits for a running compaction and applies its result on the
+     * calling thread. Does nothing if the result has been applied already.
+     */
+    void finishCompaction();
+    void readJournals();
+
+    /*!
+     * \brief replayJournal applies the journal entries that have been read into memory to the
+     * given poses. Only entries of the given images and object models are replayed.
+     */
+    QList<PosePtr> replayJournal(const QList<PosePtr> &poses,
+                                 const QList<ImagePtr> &images,
+                                 const QList<ObjectModelPtr> &objectModels) const;
+
+    /*!
+     * \brief readJournal reads the given journal file and folds its entries into the final
+     * state of every pose that occurs in the journal, i.e. the last entry for an ID wins.
+     * \param path the path to the journal file
+     * \param entries the map to fold the entries into
+     * \param order the IDs in the order of their first occurence
+     */
+    static void readJournal(const QString &path,
+                            QHash<QString, JournalEntry> &entries,
+                            QList<QString> &order);
+
+    /*!
+     * \brief compact runs on a thread of the global thread pool. It doesn't touch the binary
+     * snapshot as that is mapped by the strategy's thread, see finishCompaction.
+     */
+    static CompactionResult compact(const QString &posesFilePath, const QString &compactingJournalFilePath);
+
+private:
+    QFutureWatcher<CompactionResult> *m_compactionWatcher;
+    bool m_compactionPending = false;
+    //! The folded journal, replaying entries that have been compacted already doesn't change anything
+    QHash<QString, JournalEntry> m_journalEntries;
+    QList<QString> m_journalOrder;
+    bool m_journalRead = false;
+};
+
+typedef QSharedPointer<JournalLoadAndStoreStrategy> JournalLoadAndStoreStrategyPtr;
+
+#endif // JOURNALLOADANDSTORESTRATEGY_H
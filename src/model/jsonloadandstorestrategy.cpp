@@ -1,9 +1,13 @@
 #include "jsonloadandstorestrategy.hpp"
+#include "jsonstreamreader.hpp"
 #include "misc/generalhelper.hpp"
 #include "misc/global.hpp"
 
 #include <opencv2/core/mat.hpp>
 
+#include <algorithm>
+#include <functional>
+
 #include <QSharedPointer>
 #include <QDirIterator>
 #include <QCollator>
@@ -13,8 +17,14 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QMap>
+#include <QHash>
+#include <QSet>
 #include <QDir>
 #include <QThread>
+#include <QBuffer>
+#include <QFuture>
+#include <QQueue>
+#include <QtConcurrent/QtConcurrent>
 
 JsonLoadAndStoreStrategy::JsonLoadAndStoreStrategy()  {
 }
@@ -22,100 +32,154 @@ JsonLoadAndStoreStrategy::JsonLoadAndStoreStrategy()  {
 JsonLoadAndStoreStrategy::~JsonLoadAndStoreStrategy() {
 }
 
+QJsonObject JsonLoadAndStoreStrategy::jsonEntryFromPose(const Pose &pose) {
+    //! Preparation of 3D data for the JSON file
+    QMatrix3x3 rotationMatrix = pose.rotation().toRotationMatrix();
+    QJsonArray rotationMatrixArray;
+    rotationMatrixArray << rotationMatrix(0, 0) << rotationMatrix(0, 1) << rotationMatrix(0, 2)
+                        << rotationMatrix(1, 0) << rotationMatrix(1, 1) << rotationMatrix(1, 2)
+                        << rotationMatrix(2, 0) << rotationMatrix(2, 1) << rotationMatrix(2, 2);
+    QVector3D positionVector = pose.position();
+    QJsonArray positionVectorArray;
+    positionVectorArray << positionVector[0] << positionVector[1] << positionVector[2];
+    QJsonObject entry;
+    entry["id"] = pose.id();
+    entry["obj"] = pose.objectModel()->path();
+    entry["R"] = rotationMatrixArray;
+    entry["t"] = positionVectorArray;
+    return entry;
+}
+
 bool JsonLoadAndStoreStrategy::persistPose(const Pose &objectImagePose, bool deletePose) {
+    PosePtr pose(new Pose(objectImagePose));
+    if (deletePose) {
+        return persistPoses({}, {}, {pose});
+    }
+    return persistPoses({}, {pose}, {});
+}
+
+bool JsonLoadAndStoreStrategy::persistPoses(const QList<PosePtr> &posesToAdd,
+                                            const QList<PosePtr> &posesToUpdate,
+                                            const QList<PosePtr> &posesToRemove) {
+    if (posesToAdd.isEmpty() && posesToUpdate.isEmpty() && posesToRemove.isEmpty()) {
+        return true;
+    }
 
-    // Read in the camera parameters from the JSON file
     QFileInfo info(m_posesFilePath);
     QFile jsonFile(m_posesFilePath);
 
     if (!info.isFile()) {
-        Q_EMIT error(tr("Failed to persist pose. Poses file is not a file."));
+        Q_EMIT error(tr("Failed to persist poses. Poses file is not a file."));
         return false;
     }
 
     if (!jsonFile.open(QFile::ReadWrite)) {
-        Q_EMIT error(tr("Failed to persist pose. Poses file could not be read."));
+        Q_EMIT error(tr("Failed to persist poses. Poses file could not be read."));
         return false;
     }
 
     QByteArray data = jsonFile.readAll();
     QJsonDocument jsonDocument(QJsonDocument::fromJson(data));
     if (jsonDocument.isNull()) {
-        QJsonObject jsonObject = jsonDocument.object();
+        Q_EMIT error(tr("Failed to persist poses. The poses file is not a JSON document."));
+        return false;
+    }
 
-        QString imagePath = objectImagePose.image()->imagePath();
-        QJsonArray entriesForImage;
+    //! Group the changes by image to touch the entries of every image only once.
+    //! Added and updated poses are treated the same, i.e. existing entries are
+    //! replaced and missing ones appended.
+    QMap<QString, QList<QJsonObject>> entriesToWriteForImages;
+    for (const PosePtr &pose : posesToAdd) {
+        entriesToWriteForImages[pose->image()->imagePath()].append(jsonEntryFromPose(*pose));
+    }
+    for (const PosePtr &pose : posesToUpdate) {
+        entriesToWriteForImages[pose->image()->imagePath()].append(jsonEntryFromPose(*pose));
+    }
+    QMap<QString, QSet<QString>> idsToRemoveForImages;
+    for (const PosePtr &pose : posesToRemove) {
+        idsToRemoveForImages[pose->image()->imagePath()].insert(pose->id());
+    }
 
-        if (deletePose) {
-            if (jsonObject.contains(imagePath)) {
-                entriesForImage = jsonObject[imagePath].toArray();
-                int index = 0;
-                for(const QJsonValue &entry : entriesForImage) {
-                    QJsonObject entryObject = entry.toObject();
-                    if (entryObject["id"] == objectImagePose.id()) {
-                        entriesForImage.removeAt(index);
-                    }
-                    index++;
-                }
-                jsonObject[imagePath] = entriesForImage;
-            }
-        } else {
-            //! Preparation of 3D data for the JSON file
-            QMatrix3x3 rotationMatrix = objectImagePose.rotation().toRotationMatrix();
-            QJsonArray rotationMatrixArray;
-            rotationMatrixArray << rotationMatrix(0, 0) << rotationMatrix(0, 1) << rotationMatrix(0, 2)
-                                << rotationMatrix(1, 0) << rotationMatrix(1, 1) << rotationMatrix(1, 2)
-                                << rotationMatrix(2, 0) << rotationMatrix(2, 1) << rotationMatrix(2, 2);
-            QVector3D positionVector = objectImagePose.position();
-            QJsonArray positionVectorArray;
-            positionVectorArray << positionVector[0] << positionVector[1] << positionVector[2];
-            //! Check if any entries for the image exist
-            if (jsonObject.contains(imagePath)) {
-                //! There are some entries already and we check whether the pose
-                //! already exists
-                entriesForImage = jsonObject[imagePath].toArray();
-                //! We have to check whether our pose exists, and if it does, only update it
-                //! If we don't find it we have to create it anew and add it to the list of poses
-                bool entryFound = false;
-                //! Keep track of the index if we find an existing pose
-                int index = 0;
-                //! Create new entry object, as we can't modify the exisiting ones directly somehow
-                QJsonObject entry;
-                entry["id"] = objectImagePose.id();
-                entry["obj"] = objectImagePose.objectModel()->path();
-                entry["R"] = rotationMatrixArray;
-                entry["t"] = positionVectorArray;
-
-                for(const QJsonValue &_entry : entriesForImage) {
-                    QJsonObject entryObject = _entry.toObject();
-                    if (entryObject["id"] == objectImagePose.id()) {
-                        entryFound = true;
-                        entriesForImage[index] = entry;
-                    }
-                    index++;
-                }
+    QJsonObject jsonObject = jsonDocument.object();
+    applyChangesToJsonObject(jsonObject, entriesToWriteForImages, idsToRemoveForImages);
 
-                if (!entryFound) {
-                    entriesForImage << entry;
-                }
+    m_ignorePosesFileChanged = true;
+    jsonFile.resize(0);
+    if (jsonFile.write(QJsonDocument(jsonObject).toJson()) == -1) {
+        m_ignorePosesFileChanged = false;
+        Q_EMIT error(tr("Failed to persist poses. Poses file could not be written."));
+        return false;
+    }
+    jsonFile.close();
+    writePoseSnapshot(jsonObject);
+
+    return true;
+}
+
+QString JsonLoadAndStoreStrategy::poseSnapshotFilePath(const QString &posesFilePath) {
+    return posesFilePath + PoseSnapshot::FILE_SUFFIX;
+}
+
+void JsonLoadAndStoreStrategy::writePoseSnapshot(const QJsonObject &posesJson) {
+    PoseSnapshot::Writer snapshotWriter;
+    snapshotWriter.addJson(posesJson);
+    writePoseSnapshot(snapshotWriter);
+}
+
+void JsonLoadAndStoreStrategy::writePoseSnapshot(const PoseSnapshot::Writer &snapshotWriter) {
+    //! A mapped file can't be replaced on all platforms
+    m_poseSnapshot.close();
+    QString snapshotFilePath = poseSnapshotFilePath(m_posesFilePath);
+    if (snapshotWriter.write(snapshotFilePath, QFileInfo(m_posesFilePath))) {
+        m_poseSnapshot.open(snapshotFilePath);
+    } else {
+        //! Don't leave an outdated snapshot behind, it would only be checked and discarded
+        QFile::remove(snapshotFilePath);
+        qDebug() << "Could not write pose snapshot" << snapshotFilePath;
+    }
+}
+
+void JsonLoadAndStoreStrategy::applyChangesToJsonObject(
+        QJsonObject &jsonObject,
+        const QMap<QString, QList<QJsonObject>> &entriesToWriteForImages,
+        const QMap<QString, QSet<QString>> &idsToRemoveForImages) {
+    QSet<QString> imagePaths;
+    for (const QString &imagePath : entriesToWriteForImages.keys()) {
+        imagePaths.insert(imagePath);
+    }
+    for (const QString &imagePath : idsToRemoveForImages.keys()) {
+        imagePaths.insert(imagePath);
+    }
+
+    for (const QString &imagePath : imagePaths) {
+        const QList<QJsonObject> entriesToWrite = entriesToWriteForImages.value(imagePath);
+        const QSet<QString> idsToRemove = idsToRemoveForImages.value(imagePath);
+        QHash<QString, QJsonObject> entriesToWriteForIds;
+        for (const QJsonObject &entry : entriesToWrite) {
+            entriesToWriteForIds.insert(entry["id"].toString(), entry);
+        }
+
+        QJsonArray entriesForImage;
+        for (const QJsonValue &entry : jsonObject.value(imagePath).toArray()) {
+            QString id = entry.toObject().value("id").toString();
+            if (idsToRemove.contains(id)) {
+                continue;
+            }
+            if (entriesToWriteForIds.contains(id)) {
+                //! Use the new entry object, as we can't modify the exisiting ones directly
+                entriesForImage << entriesToWriteForIds.take(id);
             } else {
-                QJsonObject newEntry;
-                newEntry["id"] = objectImagePose.id();
-                newEntry["obj"] = objectImagePose.objectModel()->path();
-                newEntry["t"] = positionVectorArray;
-                newEntry["R"] = rotationMatrixArray;
-                entriesForImage << newEntry;
+                entriesForImage << entry;
+            }
+        }
+        //! All entries that we haven't found are new ones
+        for (const QJsonObject &entry : entriesToWrite) {
+            if (entriesToWriteForIds.contains(entry["id"].toString())) {
+                entriesForImage << entry;
             }
         }
-        m_ignorePosesFileChanged = true;
         jsonObject[imagePath] = entriesForImage;
-        jsonFile.resize(0);
-        jsonFile.write(QJsonDocument(jsonObject).toJson());
-    } else {
-        // TODO JsonDocument is null, ie an error occured
     }
-
-    return true;
 }
 
 static QMatrix3x3 rotVectorFromJsonRotMatrix(QJsonArray &jsonRotationMatrix) {
@@ -133,35 +197,123 @@ static QMatrix3x3 rotVectorFromJsonRotMatrix(QJsonArray &jsonRotationMatrix) {
     return rotationMatrix;
 }
 
-static ImagePtr createImageWithJsonParams(const QString &id, const QString& filename,
-                                          const QString &segmentationFilename,
-                                          const QString &imagesPath, QJsonObject &json) {
-    QJsonObject parameters = json[filename].toObject();
-    if (!parameters.contains("K")) {
-        return ImagePtr();
-    }
-    QJsonArray cameraMatrix = parameters["K"].toArray();
-    float values[9] = {
-        (float) cameraMatrix[0].toDouble(),
-        (float) cameraMatrix[1].toDouble(),
-        (float) cameraMatrix[2].toDouble(),
-        (float) cameraMatrix[3].toDouble(),
-        (float) cameraMatrix[4].toDouble(),
-        (float) cameraMatrix[5].toDouble(),
-        (float) cameraMatrix[6].toDouble(),
-        (float) cameraMatrix[7].toDouble(),
-        (float) cameraMatrix[8].toDouble()};
-    QMatrix3x3 qtCameraMatrix = QMatrix3x3(values);
+PosePtr JsonLoadAndStoreStrategy::poseFromJsonEntry(const QJsonObject &entry,
+                                                   const QString &id,
+                                                   const ImagePtr &image,
+                                                   const ObjectModelPtr &objectModel) {
+    //! Read rotation vector from json file
+    QJsonArray jsonRotationMatrix = entry["R"].toArray();
+    QMatrix3x3 rotationMatrix = rotVectorFromJsonRotMatrix(jsonRotationMatrix);
+
+    QJsonArray translation = entry["t"].toArray();
+    QVector3D qtTranslationVector = QVector3D((float) translation[0].toDouble(),
+                                              (float) translation[1].toDouble(),
+                                              (float) translation[2].toDouble());
+
+    return PosePtr(new Pose(id,
+                            qtTranslationVector,
+                            rotationMatrix,
+                            image,
+                            objectModel));
+}
+
+//! Camera parameters of an image as stored in info.json
+struct CameraParameters {
+    float cameraMatrix[9] = {};
     float nearPlane = 50;
     float farPlane = 2000;
-    if (parameters.contains("nearPlane")) {
-        nearPlane = (float) parameters["nearPlane"].toDouble();
+};
+
+/*!
+ * \brief readNumberArray reads the array that starts at the current token of the reader. The
+ * values that are missing are left untouched, additional values are ignored.
+ * \return false if the document is invalid
+ */
+static bool readNumberArray(JsonStreamReader &reader, float *values, int count, int &numbersRead) {
+    numbersRead = 0;
+    if (reader.tokenType() != JsonStreamReader::StartArray) {
+        return reader.skipValue();
     }
-    if (parameters.contains("farPlane")) {
-        farPlane = (float) parameters["farPlane"].toDouble();
+    while (reader.readNext() != JsonStreamReader::EndArray) {
+        if (reader.tokenType() == JsonStreamReader::Number) {
+            if (numbersRead < count) {
+                values[numbersRead] = (float) reader.numberValue();
+            }
+            numbersRead++;
+        } else if (!reader.skipValue()) {
+            return false;
+        }
     }
+    return true;
+}
+
+static bool readCameraParameters(JsonStreamReader &reader, CameraParameters &parameters,
+                                 bool &hasCameraMatrix) {
+    hasCameraMatrix = false;
+    while (reader.readNext() == JsonStreamReader::Key) {
+        QString key = reader.stringValue();
+        reader.readNext();
+        bool valid = true;
+        if (key == "K") {
+            int numbersRead;
+            valid = readNumberArray(reader, parameters.cameraMatrix, 9, numbersRead);
+            hasCameraMatrix = true;
+        } else if (key == "nearPlane" && reader.tokenType() == JsonStreamReader::Number) {
+            parameters.nearPlane = (float) reader.numberValue();
+        } else if (key == "farPlane" && reader.tokenType() == JsonStreamReader::Number) {
+            parameters.farPlane = (float) reader.numberValue();
+        } else {
+            valid = reader.skipValue();
+        }
+        if (!valid) {
+            return false;
+        }
+    }
+    return reader.tokenType() == JsonStreamReader::EndObject;
+}
+
+static ImagePtr createImageWithCameraParameters(const QString &id, const QString& filename,
+                                                const QString &segmentationFilename,
+                                                const QString &imagesPath,
+                                                const QHash<QString, CameraParameters> &cameraParameters) {
+    auto it = cameraParameters.constFind(filename);
+    if (it == cameraParameters.constEnd()) {
+        return ImagePtr();
+    }
+    QMatrix3x3 qtCameraMatrix = QMatrix3x3(it->cameraMatrix);
     return ImagePtr(new Image(id, filename, segmentationFilename, imagesPath, qtCameraMatrix,
-                              nearPlane, farPlane));
+                              it->nearPlane, it->farPlane));
+}
+
+/*!
+ * \brief readCameraInfo streams info.json and keeps only the camera parameters of the given
+ * images as info.json can contain lots of images.
+ * \param reportProgress is called with the number of bytes read after every entry
+ * \return false if the file is no valid JSON
+ */
+static bool readCameraInfo(QFile &jsonFile,
+                           const QSet<QString> &imageFilenames,
+                           QHash<QString, CameraParameters> &cameraParameters,
+                           const std::function<void(qint64)> &reportProgress) {
+    JsonStreamReader reader(&jsonFile);
+    bool validJson = reader.readNext() == JsonStreamReader::StartObject;
+    while (validJson && reader.readNext() == JsonStreamReader::Key) {
+        QString filename = reader.stringValue();
+        reader.readNext();
+        if (imageFilenames.contains(filename)
+                && reader.tokenType() == JsonStreamReader::StartObject) {
+            CameraParameters parameters;
+            bool hasCameraMatrix;
+            validJson = readCameraParameters(reader, parameters, hasCameraMatrix);
+            if (hasCameraMatrix) {
+                cameraParameters.insert(filename, parameters);
+            }
+        } else {
+            validJson = reader.skipValue();
+        }
+        reportProgress(reader.bytesRead());
+    }
+    return validJson && reader.tokenType() == JsonStreamReader::EndObject;
 }
 
 QList<ImagePtr> JsonLoadAndStoreStrategy::loadImages() {
@@ -233,14 +385,23 @@ QList<ImagePtr> JsonLoadAndStoreStrategy::loadImages() {
         return images;
     }
 
-    QByteArray data = jsonFile.readAll();
-    QJsonDocument jsonDocument(QJsonDocument::fromJson(data));
-    if (jsonDocument.isNull()) {
+    QSet<QString> imageFilenames;
+    for (const QString &imageFile : imageFiles) {
+        imageFilenames.insert(QFileInfo(imageFile).fileName());
+    }
+
+    QHash<QString, CameraParameters> cameraParameters;
+    qint64 bytesTotal = jsonFile.size();
+    int lastProgress = -1;
+    bool validJson = readCameraInfo(jsonFile, imageFilenames, cameraParameters,
+                                    [this, bytesTotal, &lastProgress](qint64 bytesRead) {
+        reportProgress(bytesRead, bytesTotal, lastProgress);
+    });
+    if (!validJson) {
         Q_EMIT error(tr("Failed to load images. Camera info file info.json is not a JSON file."));
         return images;
     }
 
-    QJsonObject jsonObject = jsonDocument.object();
     for (int i = 0; i < imageFiles.size(); i ++) {
         QString image = imageFiles[i];
         QString imageFilename = QFileInfo(image).fileName();
@@ -254,17 +415,17 @@ QList<ImagePtr> JsonLoadAndStoreStrategy::loadImages() {
             QString segmentationImageFile = segmentationImageFiles[i];
             QString segmentationImageFilePath =
                     QDir(m_segmentationImagesPath).absoluteFilePath(segmentationImageFile);
-            newImage = createImageWithJsonParams(QString::number(i),
-                                                 imageFilename,
-                                                 segmentationImageFilePath,
-                                                 m_imagesPath,
-                                                 jsonObject);
+            newImage = createImageWithCameraParameters(QString::number(i),
+                                                       imageFilename,
+                                                       segmentationImageFilePath,
+                                                       m_imagesPath,
+                                                       cameraParameters);
         } else {
-            newImage = createImageWithJsonParams(QString::number(i),
-                                                 imageFilename,
-                                                 "",
-                                                 m_imagesPath,
-                                                 jsonObject);
+            newImage = createImageWithCameraParameters(QString::number(i),
+                                                       imageFilename,
+                                                       "",
+                                                       m_imagesPath,
+                                                       cameraParameters);
         }
         if (!newImage) {
             // This can only happen when the camera matrix is invalid
@@ -288,6 +449,53 @@ QList<ImagePtr> JsonLoadAndStoreStrategy::loadImages() {
     return images;
 }
 
+QList<ImagePtr> JsonLoadAndStoreStrategy::loadImagesForFiles(const QStringList &imageFilePaths) {
+    if (m_segmentationImagesPath != "") {
+        //! Segmentation images are matched to images by their position, see loadImages
+        return LoadAndStoreStrategy::loadImagesForFiles(imageFilePaths);
+    }
+
+    QList<ImagePtr> images;
+    QFile jsonFile(QDir(m_imagesPath).filePath("info.json"));
+    if (!jsonFile.open(QFile::ReadOnly)) {
+        Q_EMIT error(tr("Failed to load images. Camera info file info.json is not readable."));
+        return images;
+    }
+
+    QSet<QString> imageFilenames;
+    for (const QString &imageFilePath : imageFilePaths) {
+        imageFilenames.insert(QFileInfo(imageFilePath).fileName());
+    }
+    QHash<QString, CameraParameters> cameraParameters;
+    if (!readCameraInfo(jsonFile, imageFilenames, cameraParameters, [](qint64) {})) {
+        Q_EMIT error(tr("Failed to load images. Camera info file info.json is not a JSON file."));
+        return images;
+    }
+
+    bool foundImageWithInvalidCameraMatrix = false;
+    for (const QString &imageFilePath : imageFilePaths) {
+        QString imageFilename = QFileInfo(imageFilePath).fileName();
+        //! The position of the image among all images is not known here, the filename
+        //! identifies it as well
+        ImagePtr newImage = createImageWithCameraParameters(imageFilename,
+                                                            imageFilename,
+                                                            "",
+                                                            m_imagesPath,
+                                                            cameraParameters);
+        if (!newImage) {
+            foundImageWithInvalidCameraMatrix = true;
+            m_imagesWithInvalidData.append(imageFilename);
+        } else {
+            images.append(newImage);
+        }
+    }
+
+    if (foundImageWithInvalidCameraMatrix) {
+        Q_EMIT error(tr("There were images with invalid camera matrices."));
+    }
+    return images;
+}
+
 QList<ObjectModelPtr> JsonLoadAndStoreStrategy::loadObjectModels() {
     QList<ObjectModelPtr> objectModels;
 
@@ -359,6 +567,285 @@ QMap<QString, ObjectModelPtr> createObjectModelMap(const QList<ObjectModelPtr> &
     return objectModelMap;
 }
 
+void JsonLoadAndStoreStrategy::reportProgress(qint64 bytesRead, qint64 bytesTotal, int &lastProgress) {
+    int progress = bytesTotal > 0 ? (int) (bytesRead * 100 / bytesTotal) : 100;
+    //! Don't flood the receivers, there are only 100 different values
+    if (progress != lastProgress) {
+        lastProgress = progress;
+        Q_EMIT progressChanged(progress);
+    }
+}
+
+//! A pose entry of the poses file as it is read by the streaming loader
+struct PoseEntry {
+    QString id;
+    QString objectModelPath;
+    float rotation[9] = {};
+    float translation[3] = {};
+    bool hasId = false;
+    bool hasObjectModelPath = false;
+    bool hasRotation = false;
+    bool hasTranslation = false;
+    //! Only entries with complete rotations and translations are written to the snapshot
+    bool complete = true;
+};
+
+static bool readPoseEntry(JsonStreamReader &reader, PoseEntry &entry) {
+    while (reader.readNext() == JsonStreamReader::Key) {
+        QString key = reader.stringValue();
+        reader.readNext();
+        bool valid = true;
+        if (key == "id") {
+            entry.hasId = true;
+            entry.id = reader.tokenType() == JsonStreamReader::String ? reader.stringValue() : QString();
+            valid = reader.skipValue();
+        } else if (key == "obj") {
+            entry.hasObjectModelPath = true;
+            entry.objectModelPath = reader.tokenType() == JsonStreamReader::String ?
+                        reader.stringValue() : QString();
+            valid = reader.skipValue();
+        } else if (key == "R") {
+            int numbersRead;
+            entry.hasRotation = true;
+            valid = readNumberArray(reader, entry.rotation, 9, numbersRead);
+            entry.complete &= numbersRead == 9;
+        } else if (key == "t") {
+            int numbersRead;
+            entry.hasTranslation = true;
+            valid = readNumberArray(reader, entry.translation, 3, numbersRead);
+            entry.complete &= numbersRead == 3;
+        } else {
+            valid = reader.skipValue();
+        }
+        if (!valid) {
+            return false;
+        }
+    }
+    return reader.tokenType() == JsonStreamReader::EndObject;
+}
+
+//! Upper bound of the size of a batch of images parsed by one task of the streaming loader
+static const qint64 MAX_BYTES_PER_BATCH = 4 * 1024 * 1024;
+//! Number of batches per loading thread that may be parsed but not merged yet
+static const int BATCHES_IN_FLIGHT_PER_THREAD = 2;
+
+//! Byte range of the array of pose entries of an image within the poses file
+struct ImageEntriesRange {
+    QString imagePath;
+    qint64 begin;
+    qint64 end;
+};
+
+//! The parsed pose entries of an image
+struct ImagePoseEntries {
+    QString imagePath;
+    //! Only the entries that contain a rotation, translation and object model
+    QList<PoseEntry> entries;
+    bool foundPosesWithInvalidPosesData = false;
+    bool valid = true;
+};
+
+//! Runs on the loading thread pool, i.e. must not touch anything but its arguments
+static QList<ImagePoseEntries> parsePoseEntries(const uchar *data,
+                                                const QList<ImageEntriesRange> &ranges) {
+    QList<ImagePoseEntries> results;
+    for (const ImageEntriesRange &range : ranges) {
+        ImagePoseEntries result;
+        result.imagePath = range.imagePath;
+        QByteArray entriesData = QByteArray::fromRawData(reinterpret_cast<const char*>(data + range.begin),
+                                                         (int) (range.end - range.begin));
+        QBuffer buffer(&entriesData);
+        buffer.open(QIODevice::ReadOnly);
+        JsonStreamReader reader(&buffer);
+        result.valid = reader.readNext() == JsonStreamReader::StartArray;
+        while (result.valid && reader.readNext() != JsonStreamReader::EndArray) {
+            if (reader.tokenType() != JsonStreamReader::StartObject) {
+                result.valid = reader.skipValue();
+                result.foundPosesWithInvalidPosesData = true;
+                continue;
+            }
+            PoseEntry entry;
+            result.valid = readPoseEntry(reader, entry);
+            if (!entry.hasRotation || !entry.hasTranslation || !entry.hasObjectModelPath) {
+                result.foundPosesWithInvalidPosesData = true;
+            } else {
+                result.entries.append(entry);
+            }
+        }
+        results.append(result);
+    }
+    return results;
+}
+
+bool JsonLoadAndStoreStrategy::loadPosesStreaming(QFile &jsonFile,
+                                                  const QMap<QString, ImagePtr> &imageMap,
+                                                  const QMap<QString, ObjectModelPtr> &objectModelMap,
+                                                  QList<PosePtr> &poses) {
+    JsonStreamReader reader(&jsonFile);
+    qint64 bytesTotal = jsonFile.size();
+    int lastProgress = -1;
+
+    //! The first pass only finds the arrays of the images, skipping them is cheap compared
+    //! to parsing the numbers and strings of the entries. It takes the first quarter of the
+    //! progress, parsing the entries the rest.
+    QList<ImageEntriesRange> ranges;
+    if (reader.readNext() != JsonStreamReader::StartObject) {
+        return false;
+    }
+    while (reader.readNext() == JsonStreamReader::Key) {
+        ImageEntriesRange range;
+        range.imagePath = reader.stringValue();
+        bool isArray = reader.readNext() == JsonStreamReader::StartArray;
+        range.begin = reader.bytesRead() - 1;
+        if (!reader.skipValue()) {
+            return false;
+        }
+        range.end = reader.bytesRead();
+        if (isArray) {
+            ranges.append(range);
+        }
+        reportProgress(reader.bytesRead(), 4 * bytesTotal, lastProgress);
+    }
+    if (reader.tokenType() != JsonStreamReader::EndObject) {
+        return false;
+    }
+
+    //! Merge in the order the images are shown in, no matter how many threads are used
+    QCollator collator;
+    collator.setNumericMode(true);
+    std::stable_sort(
+        ranges.begin(),
+        ranges.end(),
+        [&collator](const ImageEntriesRange &r1, const ImageEntriesRange &r2)
+        {
+            return collator.compare(r1.imagePath, r2.imagePath) < 0;
+        });
+
+    uchar *data = jsonFile.map(0, bytesTotal);
+    if (!data) {
+        return false;
+    }
+
+    //! Batches of roughly the same size, a few per thread to balance out images with
+    //! lots of poses
+    qint64 bytesPerBatch = qBound((qint64) 1,
+                                  bytesTotal / (m_threadPool.maxThreadCount() * 4),
+                                  MAX_BYTES_PER_BATCH);
+    QList<QList<ImageEntriesRange>> batches;
+    QList<qint64> batchSizes;
+    QList<ImageEntriesRange> batch;
+    qint64 batchSize = 0;
+    for (int i = 0; i < ranges.size(); i++) {
+        batch.append(ranges[i]);
+        batchSize += ranges[i].end - ranges[i].begin;
+        if (batchSize >= bytesPerBatch || i == ranges.size() - 1) {
+            batches.append(batch);
+            batchSizes.append(batchSize);
+            batch.clear();
+            batchSize = 0;
+        }
+    }
+
+    //! Batches are only parsed a few ahead of the merge, otherwise the parsed entries of
+    //! the whole file would be held in memory next to the poses created from them
+    const int maxBatchesInFlight = m_threadPool.maxThreadCount() * BATCHES_IN_FLIGHT_PER_THREAD;
+    QQueue<QFuture<QList<ImagePoseEntries>>> futures;
+    int nextBatch = 0;
+    auto startBatches = [&]() {
+        while (nextBatch < batches.size() && futures.size() < maxBatchesInFlight) {
+            futures.enqueue(QtConcurrent::run(&m_threadPool, parsePoseEntries,
+                                              (const uchar*) data, batches[nextBatch]));
+            nextBatch++;
+        }
+    };
+    startBatches();
+
+    PoseSnapshot::Writer snapshotWriter;
+    bool foundPosesWithInvalidPosesData = false;
+    auto mergeImagePoseEntries = [&](const ImagePoseEntries &result) {
+        if (!result.valid) {
+            return false;
+        }
+        foundPosesWithInvalidPosesData |= result.foundPosesWithInvalidPosesData;
+        ImagePtr image = imageMap.value(result.imagePath);
+        snapshotWriter.addImage(result.imagePath);
+        for (const PoseEntry &entry : result.entries) {
+            ObjectModelPtr objectModel = objectModelMap.value(entry.objectModelPath);
+            if (!entry.hasId) {
+                if (image && objectModel) {
+                    //! We have to add an ID to the entry, see loadPoses
+                    return false;
+                }
+                //! We don't manage the pose, i.e. it's fine to have no ID but we can't
+                //! identify it in the snapshot
+                snapshotWriter.markIncomplete();
+                continue;
+            }
+            //! Missing numbers are zero, same as for the pose created below
+            snapshotWriter.addPose(entry.id, entry.objectModelPath,
+                                   entry.rotation, entry.translation);
+            if (!entry.complete) {
+                snapshotWriter.markIncomplete();
+            }
+            if (image && objectModel) {
+                //! If either is NULL, we do not manage the image or object model
+                //! specified in the JSON file, that's why we just skip the entry.
+                //! The poses are created here and not by the workers to make them
+                //! live in the strategy's thread.
+                poses.append(PosePtr(new Pose(entry.id,
+                                              QVector3D(entry.translation[0],
+                                                        entry.translation[1],
+                                                        entry.translation[2]),
+                                              QMatrix3x3(entry.rotation),
+                                              image,
+                                              objectModel)));
+            }
+        }
+        return true;
+    };
+
+    bool merged = true;
+    qint64 mergedBytes = 0;
+    for (int i = 0; i < batches.size() && merged; i++) {
+        const QList<ImagePoseEntries> results = futures.dequeue().result();
+        startBatches();
+        for (const ImagePoseEntries &result : results) {
+            if (!mergeImagePoseEntries(result)) {
+                merged = false;
+                break;
+            }
+        }
+        mergedBytes += batchSizes[i];
+        reportProgress(bytesTotal + 3 * mergedBytes, 4 * bytesTotal, lastProgress);
+    }
+    //! The workers read from the mapped file
+    for (QFuture<QList<ImagePoseEntries>> &future : futures) {
+        future.waitForFinished();
+    }
+    jsonFile.unmap(data);
+    if (!merged) {
+        return false;
+    }
+    jsonFile.close();
+
+    if (foundPosesWithInvalidPosesData) {
+        //! Loading all poses parses the JSON file again to report the invalid entries,
+        //! poses of single images are still read from the snapshot
+        snapshotWriter.markIncomplete();
+    }
+    writePoseSnapshot(snapshotWriter);
+    if (foundPosesWithInvalidPosesData) {
+        Q_EMIT error(tr("There were poses with invalid data."));
+    }
+    return true;
+}
+
+void JsonLoadAndStoreStrategy::applySettings(SettingsPtr settings) {
+    LoadAndStoreStrategy::applySettings(settings);
+    int threadCount = settings->loadingThreadCount();
+    m_threadPool.setMaxThreadCount(threadCount > 0 ? threadCount : QThread::idealThreadCount());
+}
+
 QList<PosePtr> JsonLoadAndStoreStrategy::loadPoses(const QList<ImagePtr> &images,
                                                      const QList<ObjectModelPtr> &objectModels) {
     QList<PosePtr> poses;
@@ -378,6 +865,16 @@ QList<PosePtr> JsonLoadAndStoreStrategy::loadPoses(const QList<ImagePtr> &images
         return poses;
     }
 
+    //! Parsing the JSON file is slow for large files, use the binary snapshot if it
+    //! has been created from the poses file as it is now. An incomplete snapshot lacks
+    //! invalid entries, the JSON file is parsed to report them once per load.
+    if (m_poseSnapshot.open(poseSnapshotFilePath(m_posesFilePath))
+            && m_poseSnapshot.isUpToDateWith(QFileInfo(m_posesFilePath))
+            && m_poseSnapshot.isComplete()) {
+        return m_poseSnapshot.loadPoses(images, objectModels);
+    }
+    m_poseSnapshot.close();
+
     bool foundPosesWithInvalidPosesData = false;
 
     QFile jsonFile(m_posesFilePath);
@@ -388,6 +885,15 @@ QList<PosePtr> JsonLoadAndStoreStrategy::loadPoses(const QList<ImagePtr> &images
 
     QMap<QString, ImagePtr> imageMap = createImageMap(images);
     QMap<QString, ObjectModelPtr> objectModelMap = createObjectModelMap(objectModels);
+
+    //! Only files that lack IDs (e.g. external ground truth files) are read into memory
+    //! as a whole as we have to write the IDs back to them
+    if (loadPosesStreaming(jsonFile, imageMap, objectModelMap, poses)) {
+        return poses;
+    }
+    poses.clear();
+    jsonFile.seek(0);
+
     QByteArray data = jsonFile.readAll();
     QJsonDocument jsonDocument(QJsonDocument::fromJson(data));
 
@@ -414,15 +920,6 @@ QList<PosePtr> JsonLoadAndStoreStrategy::loadPoses(const QList<ImagePtr> &images
                 continue;
             }
 
-            //! Read rotation vector from json file
-            QJsonArray jsonRotationMatrix = poseEntry["R"].toArray();
-            QMatrix3x3 rotationMatrix = rotVectorFromJsonRotMatrix(jsonRotationMatrix);
-
-            QJsonArray translation = poseEntry["t"].toArray();
-            QVector3D qtTranslationVector = QVector3D((float) translation[0].toDouble(),
-                                                      (float) translation[1].toDouble(),
-                                                      (float) translation[2].toDouble());
-
             QString objectModelPath = poseEntry["obj"].toString();
             ImagePtr image = imageMap.value(imagePath);
             ObjectModelPtr objectModel = objectModelMap.value(objectModelPath);
@@ -449,12 +946,7 @@ QList<PosePtr> JsonLoadAndStoreStrategy::loadPoses(const QList<ImagePtr> &images
                     documentDirty = true;
                 }
 
-                PosePtr pose(new Pose(id,
-                                      qtTranslationVector,
-                                      rotationMatrix,
-                                      image,
-                                      objectModel));
-                poses.append(pose);
+                poses.append(poseFromJsonEntry(poseEntry, id, image, objectModel));
             }
             index++;
         }
@@ -464,7 +956,10 @@ QList<PosePtr> JsonLoadAndStoreStrategy::loadPoses(const QList<ImagePtr> &images
             jsonFile.write(QJsonDocument(jsonObject).toJson());
         }
     }
+    jsonFile.close();
 
+    //! Entries with invalid data are left out of the snapshot, see loadPosesStreaming
+    writePoseSnapshot(jsonObject);
     if (foundPosesWithInvalidPosesData) {
         Q_EMIT error(tr("There were poses with invalid data."));
     }
@@ -475,3 +970,17 @@ QList<PosePtr> JsonLoadAndStoreStrategy::loadPoses(const QList<ImagePtr> &images
     }
     return poses;
 }
+
+QList<PosePtr> JsonLoadAndStoreStrategy::loadPosesForImage(const ImagePtr &image,
+                                                           const QList<ObjectModelPtr> &objectModels) {
+    //! An incomplete snapshot is fine here, it only lacks entries that can't be loaded anyway
+    //! and their invalid data has been reported when parsing the poses file
+    if (m_posesFilePath != Global::NO_PATH
+            && m_poseSnapshot.isOpen()
+            && m_poseSnapshot.isUpToDateWith(QFileInfo(m_posesFilePath))) {
+        return m_poseSnapshot.loadPosesForImage(image, objectModels);
+    }
+    //! Loading the poses (re-)creates the snapshot, i.e. the next call only reads the records.
+    //! Not the overwritten version, subclasses process the result of this method.
+    return JsonLoadAndStoreStrategy::loadPoses({image}, objectModels);
+}
@@ -2,9 +2,15 @@
 #define TEXTFILELOADANDSTORESTRATEGY_H
 
 #include "loadandstorestrategy.hpp"
+#include "posesnapshot.hpp"
 #include <QString>
 #include <QStringList>
 #include <QList>
+#include <QMap>
+#include <QSet>
+#include <QJsonObject>
+#include <QFile>
+#include <QThreadPool>
 #include <QFileSystemWatcher>
 
 /*!
@@ -26,10 +32,29 @@ public:
 
     ~JsonLoadAndStoreStrategy();
 
+    /*!
+     * \brief applySettings additionally sets the number of threads used to parse the poses.
+     */
+    void applySettings(SettingsPtr settings) override;
+
     bool persistPose(const Pose &pose, bool deletePose) override;
 
+    /*!
+     * \brief persistPoses Writes all given changes with a single read-modify-write of
+     * the poses file. Either all changes are written or none.
+     */
+    bool persistPoses(const QList<PosePtr> &posesToAdd,
+                      const QList<PosePtr> &posesToUpdate,
+                      const QList<PosePtr> &posesToRemove) override;
+
     QList<ImagePtr> loadImages() override;
 
+    /*!
+     * \brief loadImagesForFiles reads only the camera parameters of the given images from
+     * info.json. Images loaded this way are identified by their filename.
+     */
+    QList<ImagePtr> loadImagesForFiles(const QStringList &imageFilePaths) override;
+
     QList<ObjectModelPtr> loadObjectModels() override;
 
     /*!
@@ -47,6 +72,78 @@ public:
      */
     QList<PosePtr> loadPoses(const QList<ImagePtr> &images,
                                const QList<ObjectModelPtr> &objectModels) override;
+
+    /*!
+     * \brief loadPosesForImage reads only the records of the given image from the snapshot.
+     * If there is no up-to-date snapshot the poses file is loaded once to create it.
+     */
+    QList<PosePtr> loadPosesForImage(const ImagePtr &image,
+                                     const QList<ObjectModelPtr> &objectModels) override;
+
+protected:
+    /*!
+     * \brief jsonEntryFromPose creates the entry that represents the given pose in
+     * the poses JSON file.
+     */
+    static QJsonObject jsonEntryFromPose(const Pose &pose);
+
+    /*!
+     * \brief poseFromJsonEntry creates a pose from an entry of the poses JSON file. The
+     * entry has to contain the rotation matrix "R" and translation vector "t".
+     */
+    static PosePtr poseFromJsonEntry(const QJsonObject &entry,
+                                     const QString &id,
+                                     const ImagePtr &image,
+                                     const ObjectModelPtr &objectModel);
+
+    /*!
+     * \brief applyChangesToJsonObject applies the given changes to the content of a poses
+     * JSON file. Entries whose IDs already exist for an image are replaced, all others are
+     * appended.
+     * \param jsonObject the content of the poses JSON file
+     * \param entriesToWriteForImages the pose entries to write grouped by image path
+     * \param idsToRemoveForImages the IDs of the poses to remove grouped by image path
+     */
+    static void applyChangesToJsonObject(QJsonObject &jsonObject,
+                                         const QMap<QString, QList<QJsonObject>> &entriesToWriteForImages,
+                                         const QMap<QString, QSet<QString>> &idsToRemoveForImages);
+
+    //! The binary snapshot of the poses file is stored next to it, i.e. poses.json.snapshot
+    static QString poseSnapshotFilePath(const QString &posesFilePath);
+
+    /*!
+     * \brief writePoseSnapshot replaces the binary snapshot of the poses file with one of the
+     * given content. The poses file has to be written and closed already because the snapshot
+     * stores its size and modification date. The snapshot is only a cache, i.e. failing to
+     * write it is not an error, the poses file is simply parsed again on the next load.
+     */
+    void writePoseSnapshot(const QJsonObject &posesJson);
+    void writePoseSnapshot(const PoseSnapshot::Writer &snapshotWriter);
+
+protected:
+    //! Kept open after loading the poses to be able to read poses lazily
+    PoseSnapshot m_poseSnapshot;
+
+private:
+    /*!
+     * \brief loadPosesStreaming reads the poses file with a JsonStreamReader, i.e. without
+     * building the whole document in memory, and reports the progress while doing so. The
+     * entries of the images are parsed in parallel on the loading thread pool and merged in
+     * numeric order of the image paths.
+     * \return false if the file can't be handled by streaming it, i.e. if it is no valid JSON
+     * or if IDs have to be added to entries and written back, poses might contain some of the
+     * poses then
+     */
+    bool loadPosesStreaming(QFile &jsonFile,
+                            const QMap<QString, ImagePtr> &imageMap,
+                            const QMap<QString, ObjectModelPtr> &objectModelMap,
+                            QList<PosePtr> &poses);
+
+    void reportProgress(qint64 bytesRead, qint64 bytesTotal, int &lastProgress);
+
+private:
+    //! Parses the poses, the number of threads is configured through the settings
+    QThreadPool m_threadPool;
 };
 
 typedef QSharedPointer<JsonLoadAndStoreStrategy> JsonLoadAndStoreStrategyPtr;
@@ -0,0 +1,310 @@
+#include "jsonstreamreader.hpp"
+
+const qint64 JsonStreamReader::CHUNK_SIZE = 1024 * 1024;
+
+JsonStreamReader::JsonStreamReader(QIODevice *device)
+    : m_device(device) {
+}
+
+JsonStreamReader::TokenType JsonStreamReader::readNext() {
+    if (m_tokenType == Invalid || m_tokenType == EndDocument) {
+        return m_tokenType;
+    }
+
+    char c;
+    if (!skipWhitespaceAndSeparators(c)) {
+        if (m_containers.isEmpty() && m_tokenType != NoToken) {
+            return m_tokenType = EndDocument;
+        }
+        return invalid("Unexpected end of the document.");
+    }
+
+    switch (c) {
+    case '{':
+        m_containers.append(true);
+        m_expectKey = true;
+        return m_tokenType = StartObject;
+    case '}':
+        if (m_containers.isEmpty() || !m_containers.last()) {
+            return invalid("Unexpected '}'.");
+        }
+        m_containers.removeLast();
+        m_expectKey = false;
+        return m_tokenType = EndObject;
+    case '[':
+        m_containers.append(false);
+        m_expectKey = false;
+        return m_tokenType = StartArray;
+    case ']':
+        if (m_containers.isEmpty() || m_containers.last()) {
+            return invalid("Unexpected ']'.");
+        }
+        m_containers.removeLast();
+        return m_tokenType = EndArray;
+    case '"':
+        if (!readString()) {
+            return invalid("Invalid string.");
+        }
+        if (!m_containers.isEmpty() && m_containers.last() && m_expectKey) {
+            m_expectKey = false;
+            return m_tokenType = Key;
+        }
+        return m_tokenType = String;
+    case 't':
+        m_boolValue = true;
+        return readLiteral("rue") ? m_tokenType = Bool : invalid("Invalid literal.");
+    case 'f':
+        m_boolValue = false;
+        return readLiteral("alse") ? m_tokenType = Bool : invalid("Invalid literal.");
+    case 'n':
+        return readLiteral("ull") ? m_tokenType = Null : invalid("Invalid literal.");
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            return readNumber(c) ? m_tokenType = Number : invalid("Invalid number.");
+        }
+        return invalid(QString("Unexpected character '%1'.").arg(c));
+    }
+}
+
+JsonStreamReader::TokenType JsonStreamReader::tokenType() const {
+    return m_tokenType;
+}
+
+QString JsonStreamReader::stringValue() const {
+    return m_stringValue;
+}
+
+double JsonStreamReader::numberValue() const {
+    return m_numberValue;
+}
+
+bool JsonStreamReader::boolValue() const {
+    return m_boolValue;
+}
+
+bool JsonStreamReader::skipValue() {
+    if (m_tokenType == Key) {
+        readNext();
+        return skipValue();
+    }
+    if (m_tokenType == Invalid || m_tokenType == EndDocument) {
+        return false;
+    }
+    if (m_tokenType != StartObject && m_tokenType != StartArray) {
+        return true;
+    }
+
+    //! Skipped strings and numbers are not converted, i.e. skipping is mostly scanning
+    m_skipping = true;
+    int depth = 1;
+    while (depth > 0) {
+        TokenType tokenType = readNext();
+        if (tokenType == StartObject || tokenType == StartArray) {
+            depth++;
+        } else if (tokenType == EndObject || tokenType == EndArray) {
+            depth--;
+        } else if (tokenType == Invalid || tokenType == EndDocument) {
+            break;
+        }
+    }
+    m_skipping = false;
+    return depth == 0;
+}
+
+qint64 JsonStreamReader::bytesRead() const {
+    return m_bufferOffset + m_position;
+}
+
+QString JsonStreamReader::errorString() const {
+    return m_errorString;
+}
+
+bool JsonStreamReader::fillBuffer() {
+    m_bufferOffset += m_buffer.size();
+    m_buffer = m_device->read(CHUNK_SIZE);
+    m_position = 0;
+    return !m_buffer.isEmpty();
+}
+
+bool JsonStreamReader::nextChar(char &c) {
+    if (m_position >= m_buffer.size() && !fillBuffer()) {
+        return false;
+    }
+    c = m_buffer.at(m_position++);
+    return true;
+}
+
+bool JsonStreamReader::peekChar(char &c) {
+    if (m_position >= m_buffer.size() && !fillBuffer()) {
+        return false;
+    }
+    c = m_buffer.at(m_position);
+    return true;
+}
+
+bool JsonStreamReader::skipWhitespaceAndSeparators(char &c) {
+    while (nextChar(c)) {
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == ':') {
+            continue;
+        }
+        if (c == ',') {
+            m_expectKey = !m_containers.isEmpty() && m_containers.last();
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool JsonStreamReader::readHexCode(ushort &code) {
+    code = 0;
+    for (int i = 0; i < 4; i++) {
+        char c;
+        if (!nextChar(c)) {
+            return false;
+        }
+        code <<= 4;
+        if (c >= '0' && c <= '9') {
+            code |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            code |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            code |= c - 'A' + 10;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JsonStreamReader::skipString() {
+    while (true) {
+        while (m_position < m_buffer.size()
+               && m_buffer.at(m_position) != '"'
+               && m_buffer.at(m_position) != '\\') {
+            m_position++;
+        }
+        char c;
+        if (!nextChar(c)) {
+            return false;
+        }
+        if (c == '"') {
+            return true;
+        }
+        //! Skip the escaped character, the digits of \\u escapes are ordinary characters
+        if (c == '\\' && !nextChar(c)) {
+            return false;
+        }
+    }
+}
+
+bool JsonStreamReader::readString() {
+    if (m_skipping) {
+        return skipString();
+    }
+    m_stringBuffer.clear();
+    while (true) {
+        //! Copy runs of ordinary characters at once instead of char by char
+        int start = m_position;
+        while (m_position < m_buffer.size()
+               && m_buffer.at(m_position) != '"'
+               && m_buffer.at(m_position) != '\\') {
+            m_position++;
+        }
+        m_stringBuffer.append(m_buffer.constData() + start, m_position - start);
+
+        char c;
+        if (!nextChar(c)) {
+            return false;
+        }
+        if (c == '"') {
+            break;
+        }
+        if (c != '\\') {
+            //! The buffer has just been refilled
+            m_stringBuffer.append(c);
+            continue;
+        }
+
+        char escaped;
+        if (!nextChar(escaped)) {
+            return false;
+        }
+        switch (escaped) {
+        case '"':
+        case '\\':
+        case '/':
+            m_stringBuffer.append(escaped);
+            break;
+        case 'b':
+            m_stringBuffer.append('\b');
+            break;
+        case 'f':
+            m_stringBuffer.append('\f');
+            break;
+        case 'n':
+            m_stringBuffer.append('\n');
+            break;
+        case 'r':
+            m_stringBuffer.append('\r');
+            break;
+        case 't':
+            m_stringBuffer.append('\t');
+            break;
+        case 'u': {
+            ushort code;
+            if (!readHexCode(code)) {
+                return false;
+            }
+            QString character(QChar(code));
+            if (QChar::isHighSurrogate(code)) {
+                char backslash, u;
+                ushort lowCode;
+                if (!nextChar(backslash) || !nextChar(u)
+                        || backslash != '\\' || u != 'u' || !readHexCode(lowCode)) {
+                    return false;
+                }
+                character.append(QChar(lowCode));
+            }
+            m_stringBuffer.append(character.toUtf8());
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    m_stringValue = QString::fromUtf8(m_stringBuffer);
+    return true;
+}
+
+bool JsonStreamReader::readNumber(char firstChar) {
+    m_stringBuffer.clear();
+    m_stringBuffer.append(firstChar);
+    char c;
+    while (peekChar(c) && ((c >= '0' && c <= '9') || c == '.' || c == 'e'
+                           || c == 'E' || c == '+' || c == '-')) {
+        m_stringBuffer.append(c);
+        m_position++;
+    }
+    if (m_skipping) {
+        return true;
+    }
+    bool ok;
+    m_numberValue = m_stringBuffer.toDouble(&ok);
+    return ok;
+}
+
+bool JsonStreamReader::readLiteral(const char *rest) {
+    for (const char *expected = rest; *expected; expected++) {
+        char c;
+        if (!nextChar(c) || c != *expected) {
+            return false;
+        }
+    }
+    return true;
+}
+
+JsonStreamReader::TokenType JsonStreamReader::invalid(const QString &errorString) {
+    m_errorString = errorString;
+    return m_tokenType = Invalid;
+}
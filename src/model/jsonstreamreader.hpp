@@ -0,0 +1,100 @@
+#ifndef JSONSTREAMREADER_H
+#define JSONSTREAMREADER_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+/*!
+ * \brief The JsonStreamReader class is a pull parser for JSON documents similar to QXmlStreamReader.
+ * In contrast to QJsonDocument it does not build the whole document in memory but reads the device in
+ * chunks and returns one token at a time, i.e. memory usage does not depend on the size of the document.
+ *
+ * The reader is lenient regarding the separators ',' and ':' but reports malformed values as Invalid.
+ */
+class JsonStreamReader {
+
+public:
+    enum TokenType {
+        NoToken,
+        StartObject,
+        EndObject,
+        StartArray,
+        EndArray,
+        //! A string in the key position of an object, i.e. the value follows with the next token
+        Key,
+        String,
+        Number,
+        Bool,
+        Null,
+        EndDocument,
+        Invalid
+    };
+
+    explicit JsonStreamReader(QIODevice *device);
+
+    /*!
+     * \brief readNext reads the next token.
+     * \return the type of the token that has been read
+     */
+    TokenType readNext();
+
+    TokenType tokenType() const;
+
+    //! The value of Key and String tokens
+    QString stringValue() const;
+
+    double numberValue() const;
+
+    bool boolValue() const;
+
+    /*!
+     * \brief skipValue skips the value of the current token, i.e. if the current token is
+     * StartObject or StartArray everything up to the matching end token. Scalar values
+     * have been consumed already. The values of the skipped tokens are not available.
+     * \return false if the document ended or turned out to be invalid
+     */
+    bool skipValue();
+
+    //! The number of bytes that have been consumed from the device, e.g. to report progress
+    qint64 bytesRead() const;
+
+    QString errorString() const;
+
+private:
+    bool nextChar(char &c);
+    bool peekChar(char &c);
+    bool fillBuffer();
+    bool skipWhitespaceAndSeparators(char &c);
+    bool readString();
+    bool skipString();
+    bool readHexCode(ushort &code);
+    bool readNumber(char firstChar);
+    bool readLiteral(const char *rest);
+    TokenType invalid(const QString &errorString);
+
+private:
+    //! Large enough to make the number of reads on the device negligible
+    static const qint64 CHUNK_SIZE;
+
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    int m_position = 0;
+    qint64 m_bufferOffset = 0;
+
+    //! true for objects and false for arrays
+    QVector<bool> m_containers;
+    bool m_expectKey = false;
+    //! Set while skipping values to not convert strings and numbers
+    bool m_skipping = false;
+
+    TokenType m_tokenType = NoToken;
+    QByteArray m_stringBuffer;
+    QString m_stringValue;
+    double m_numberValue = 0;
+    bool m_boolValue = false;
+    QString m_errorString;
+};
+
+#endif // JSONSTREAMREADER_H
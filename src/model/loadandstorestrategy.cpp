@@ -4,6 +4,8 @@
 
 #include <QCollator>
 #include <QDirIterator>
+#include <QFileInfo>
+#include <QMutexLocker>
 
 // Overwriteable by subclasses
 const QStringList LoadAndStoreStrategy::OBJECT_MODEL_FILES_EXTENSIONS =
@@ -11,7 +13,16 @@ const QStringList LoadAndStoreStrategy::OBJECT_MODEL_FILES_EXTENSIONS =
 const QStringList LoadAndStoreStrategy::IMAGE_FILES_EXTENSIONS =
                                             QStringList({"*.jpg", "*.jpeg", "*.png", "*.tiff"});
 
-LoadAndStoreStrategy::LoadAndStoreStrategy() {
+//! Milliseconds without further changes after which the changes of a directory are computed
+static const int DIRECTORY_CHANGES_DELAY = 200;
+static const QString CAMERA_INFO_FILENAME = "info.json";
+
+LoadAndStoreStrategy::LoadAndStoreStrategy()
+    : m_directoryChangesTimer(new QTimer(this)) {
+    m_directoryChangesTimer->setSingleShot(true);
+    m_directoryChangesTimer->setInterval(DIRECTORY_CHANGES_DELAY);
+    connect(m_directoryChangesTimer, &QTimer::timeout,
+            this, &LoadAndStoreStrategy::onDirectoryChangesSettled);
     connectWatcherSignals();
 }
 
@@ -26,8 +37,70 @@ void LoadAndStoreStrategy::applySettings(SettingsPtr settings) {
     setSegmentationImagesPath(settings->segmentationImagesPath());
 }
 
+void LoadAndStoreStrategy::flush() {
+}
+
+QRecursiveMutex *LoadAndStoreStrategy::mutex() const {
+    return &m_mutex;
+}
+
+bool LoadAndStoreStrategy::persistPoses(const QList<PosePtr> &posesToAdd,
+                                        const QList<PosePtr> &posesToUpdate,
+                                        const QList<PosePtr> &posesToRemove) {
+    bool result = true;
+    for (const PosePtr &pose : posesToAdd) {
+        result &= persistPose(*pose, false);
+    }
+    for (const PosePtr &pose : posesToUpdate) {
+        result &= persistPose(*pose, false);
+    }
+    for (const PosePtr &pose : posesToRemove) {
+        result &= persistPose(*pose, true);
+    }
+    return result;
+}
+
+QList<PosePtr> LoadAndStoreStrategy::loadPosesForImage(const ImagePtr &image,
+                                                       const QList<ObjectModelPtr> &objectModels) {
+    return loadPoses({image}, objectModels);
+}
+
+QList<ImagePtr> LoadAndStoreStrategy::loadImagesForFiles(const QStringList &imageFilePaths) {
+    QSet<QString> filePaths;
+    for (const QString &filePath : imageFilePaths) {
+        filePaths.insert(QFileInfo(filePath).absoluteFilePath());
+    }
+    QList<ImagePtr> images;
+    for (const ImagePtr &image : loadImages()) {
+        if (filePaths.contains(QFileInfo(image->absoluteImagePath()).absoluteFilePath())) {
+            images.append(image);
+        }
+    }
+    return images;
+}
+
+QList<ObjectModelPtr> LoadAndStoreStrategy::loadObjectModelsForFiles(const QStringList &objectModelFilePaths) {
+    QSet<QString> filePaths;
+    for (const QString &filePath : objectModelFilePaths) {
+        filePaths.insert(QFileInfo(filePath).absoluteFilePath());
+    }
+    QList<ObjectModelPtr> objectModels;
+    for (const ObjectModelPtr &objectModel : loadObjectModels()) {
+        if (filePaths.contains(QFileInfo(objectModel->absolutePath()).absoluteFilePath())) {
+            objectModels.append(objectModel);
+        }
+    }
+    return objectModels;
+}
+
 void LoadAndStoreStrategy::setImagesPath(const QString &imagesPath) {
+    //! Called on the GUI thread while the snapshot is diffed on ours, see onDirectoryChangesSettled
+    QMutexLocker locker(&m_mutex);
+    QString previousImagesPath = m_imagesPath;
     setPath(imagesPath, this->m_imagesPath);
+    if (m_imagesPath != previousImagesPath) {
+        m_imagesSnapshot = takeImagesSnapshot();
+    }
 }
 
 void LoadAndStoreStrategy::setSegmentationImagesPath(const QString &path) {
@@ -39,7 +112,12 @@ QList<QString> LoadAndStoreStrategy::imagesWithInvalidData() const {
 }
 
 void LoadAndStoreStrategy::setObjectModelsPath(const QString &objectModelsPath) {
+    QMutexLocker locker(&m_mutex);
+    QString previousObjectModelsPath = m_objectModelsPath;
     setPath(objectModelsPath, this->m_objectModelsPath);
+    if (m_objectModelsPath != previousObjectModelsPath) {
+        m_objectModelsSnapshot = takeObjectModelsSnapshot();
+    }
 }
 
 void LoadAndStoreStrategy::setPosesFilePath(const QString &posesFilePath) {
@@ -68,11 +146,20 @@ bool LoadAndStoreStrategy::setPath(const QString &path, QString &oldPath) {
     return true;
 }
 
+DirectorySnapshot LoadAndStoreStrategy::takeImagesSnapshot() const {
+    return DirectorySnapshot(m_imagesPath, IMAGE_FILES_EXTENSIONS + QStringList({CAMERA_INFO_FILENAME}), false);
+}
+
+DirectorySnapshot LoadAndStoreStrategy::takeObjectModelsSnapshot() const {
+    return DirectorySnapshot(m_objectModelsPath, OBJECT_MODEL_FILES_EXTENSIONS, true);
+}
+
 void LoadAndStoreStrategy::onDirectoryChanged(const QString &path) {
-    if (path == m_imagesPath || path == m_segmentationImagesPath) {
+    if (path == m_imagesPath || path == m_objectModelsPath) {
+        m_changedDirectories.insert(path);
+        m_directoryChangesTimer->start();
+    } else if (path == m_segmentationImagesPath) {
         Q_EMIT dataChanged(Data::Images);
-    } else if (path == m_objectModelsPath) {
-        Q_EMIT dataChanged(Data::ObjectModels);
     } else if (path == m_posesFilePath) {
         Q_EMIT dataChanged(Data::Poses);
     }
@@ -96,6 +183,54 @@ void LoadAndStoreStrategy::onFileChanged(const QString &filePath) {
     }
 }
 
+void LoadAndStoreStrategy::onDirectoryChangesSettled() {
+    //! The paths and snapshots are replaced on the GUI thread when applying settings. The
+    //! signals are emitted without the lock as the receivers call the strategy.
+    QMutexLocker locker(&m_mutex);
+    bool reloadImages = false;
+    QStringList addedImages, removedImages, modifiedImages;
+    if (m_changedDirectories.contains(m_imagesPath)) {
+        DirectorySnapshot snapshot = takeImagesSnapshot();
+        if (m_imagesSnapshot.isValid()) {
+            m_imagesSnapshot.diff(snapshot, addedImages, removedImages, modifiedImages);
+        }
+        QString cameraInfoFilePath = QDir(m_imagesPath).filePath(CAMERA_INFO_FILENAME);
+        //! Segmentation images are matched to the images by their position, i.e. adding
+        //! an image changes the segmentation images of the following ones
+        reloadImages = !m_imagesSnapshot.isValid()
+                || m_segmentationImagesPath != ""
+                || addedImages.contains(cameraInfoFilePath)
+                || removedImages.contains(cameraInfoFilePath)
+                || modifiedImages.contains(cameraInfoFilePath);
+        m_imagesSnapshot = snapshot;
+    }
+    bool reloadObjectModels = false;
+    QStringList addedObjectModels, removedObjectModels, modifiedObjectModels;
+    if (m_changedDirectories.contains(m_objectModelsPath)) {
+        DirectorySnapshot snapshot = takeObjectModelsSnapshot();
+        reloadObjectModels = !m_objectModelsSnapshot.isValid();
+        if (!reloadObjectModels) {
+            m_objectModelsSnapshot.diff(snapshot, addedObjectModels, removedObjectModels, modifiedObjectModels);
+        }
+        m_objectModelsSnapshot = snapshot;
+    }
+    m_changedDirectories.clear();
+    locker.unlock();
+
+    if (reloadImages) {
+        Q_EMIT dataChanged(Data::Images);
+    } else if (!addedImages.isEmpty() || !removedImages.isEmpty() || !modifiedImages.isEmpty()) {
+        Q_EMIT entitiesChanged(Data::Images, addedImages, removedImages, modifiedImages);
+    }
+    if (reloadObjectModels) {
+        Q_EMIT dataChanged(Data::ObjectModels);
+    } else if (!addedObjectModels.isEmpty() || !removedObjectModels.isEmpty()
+               || !modifiedObjectModels.isEmpty()) {
+        Q_EMIT entitiesChanged(Data::ObjectModels, addedObjectModels, removedObjectModels,
+                               modifiedObjectModels);
+    }
+}
+
 void LoadAndStoreStrategy::connectWatcherSignals() {
     connect(&m_fileSystemWatcher, &QFileSystemWatcher::directoryChanged,
             this, &LoadAndStoreStrategy::onDirectoryChanged);
@@ -6,12 +6,17 @@
 #include "objectmodel.hpp"
 #include "data.hpp"
 #include "settings/settingsstore.hpp"
+#include "directorysnapshot.hpp"
 
 #include <QObject>
 #include <QString>
 #include <QList>
 #include <QDir>
 #include <QFileSystemWatcher>
+#include <QStringList>
+#include <QSet>
+#include <QTimer>
+#include <QMutex>
 
 using namespace std;
 
@@ -38,6 +43,21 @@ public:
      */
     virtual void applySettings(SettingsPtr settings);
 
+    /*!
+     * \brief flush writes changes that the strategy has held back to the poses file, e.g.
+     * before another strategy takes over the file. The default implementation does nothing
+     * as changes are written to the poses file right away.
+     */
+    virtual void flush();
+
+    /*!
+     * \brief mutex returns the mutex that serializes the calls of the strategy. The strategy
+     * lives on the model manager's thread but poses are persisted and settings are applied on
+     * the GUI thread, i.e. callers have to lock it around every call. Signals that are emitted
+     * while it is locked must not be waited for.
+     */
+    QRecursiveMutex *mutex() const;
+
     /*!
      * \brief persistObjectImagePose Persists the given ObjectImagePose. The details of
      * how the data is persisted depends on the LoadAndStoreStrategy implementation.
@@ -48,6 +68,20 @@ public:
     virtual bool persistPose(const Pose &objectImagePose,
                              bool deletePose) = 0;
 
+    /*!
+     * \brief persistPoses Persists all given changes to poses at once. Strategies that
+     * store all poses in a single file should overwrite this method to write the file only
+     * once. The default implementation calls persistPose for every pose, i.e. if an error
+     * occurs the changes before the failing pose might have been persisted already.
+     * \param posesToAdd the poses that have been newly created
+     * \param posesToUpdate the poses whose values have been modified
+     * \param posesToRemove the poses that are to be persistently deleted
+     * \return true if persisting all changes was successful, false if not
+     */
+    virtual bool persistPoses(const QList<PosePtr> &posesToAdd,
+                              const QList<PosePtr> &posesToUpdate,
+                              const QList<PosePtr> &posesToRemove);
+
     void setImagesPath(const QString &imagesPath);
 
     void setSegmentationImagesPath(const QString &path);
@@ -58,6 +92,15 @@ public:
      */
     virtual QList<ImagePtr> loadImages() = 0;
 
+    /*!
+     * \brief loadImagesForFiles loads only the images of the given files, e.g. after they
+     * have been added to the images folder. The default implementation loads all images and
+     * keeps the requested ones.
+     * \param imageFilePaths the paths of the image files as reported by entitiesChanged
+     * \return the list of images
+     */
+    virtual QList<ImagePtr> loadImagesForFiles(const QStringList &imageFilePaths);
+
     virtual QList<QString> imagesWithInvalidData() const;
 
     void setObjectModelsPath(const QString &objectModelsPath);
@@ -68,6 +111,14 @@ public:
      */
     virtual QList<ObjectModelPtr> loadObjectModels() = 0;
 
+    /*!
+     * \brief loadObjectModelsForFiles loads only the object models of the given files. The
+     * default implementation loads all object models and keeps the requested ones.
+     * \param objectModelFilePaths the paths of the object model files as reported by entitiesChanged
+     * \return the list of object models
+     */
+    virtual QList<ObjectModelPtr> loadObjectModelsForFiles(const QStringList &objectModelFilePaths);
+
     void setPosesFilePath(const QString &posesFilePath);
 
     /*!
@@ -78,16 +129,38 @@ public:
     virtual QList<PosePtr> loadPoses(const QList<ImagePtr> &images,
                                        const QList<ObjectModelPtr> &objectModels) = 0;
 
+    /*!
+     * \brief loadPosesForImage loads only the poses of the given image, e.g. to load poses
+     * lazily. The default implementation calls loadPoses with only the given image, strategies
+     * that can look up the poses of a single image should overwrite it.
+     * \return the list of the stored poses of the image
+     */
+    virtual QList<PosePtr> loadPosesForImage(const ImagePtr &image,
+                                             const QList<ObjectModelPtr> &objectModels);
+
     virtual QList<QString> posesWithInvalidData() const;
 
 
 Q_SIGNALS:
     void error(const QString &error);
     void dataChanged(int data);
+    /*!
+     * \brief entitiesChanged is emitted instead of dataChanged when only single files of the
+     * images or object models folder have been added, removed or modified. Changes that can't
+     * be applied file by file (e.g. to the camera info file) still emit dataChanged.
+     * \param data either Data::Images or Data::ObjectModels
+     */
+    void entitiesChanged(int data,
+                         const QStringList &added,
+                         const QStringList &removed,
+                         const QStringList &modified);
+    //! The progress of loading the current kind of data in percent, if the strategy knows it
+    void progressChanged(int progress);
 
 protected Q_SLOTS:
     void onDirectoryChanged(const QString &path);
     void onFileChanged(const QString &filePath);
+    void onDirectoryChangesSettled();
 
 protected:
     void connectWatcherSignals();
@@ -95,6 +168,9 @@ protected:
     //! Internal methods to react to path changes
     bool setPath(const QString &path, QString &oldPath);
 
+    DirectorySnapshot takeImagesSnapshot() const;
+    DirectorySnapshot takeObjectModelsSnapshot() const;
+
 protected:
     //! Unmodifiable constants (i.e. not changable by the user at runtime)
     static const QStringList IMAGE_FILES_EXTENSIONS;
@@ -113,6 +189,12 @@ protected:
     QString m_segmentationImagesPath;
 
     QFileSystemWatcher m_fileSystemWatcher;
+    //! The state of the folders that the last changes have been computed against
+    DirectorySnapshot m_imagesSnapshot;
+    DirectorySnapshot m_objectModelsSnapshot;
+    //! Copying lots of files emits lots of directory changes, we only diff once they settled
+    QTimer *m_directoryChangesTimer;
+    QSet<QString> m_changedDirectories;
 
     // We need to ignore changes to the file once after we have written
     // a new pose to it because the model manager already emits a signal
@@ -120,6 +202,9 @@ protected:
     // We only want this signal when the poses file has been changed
     // externally
     bool m_ignorePosesFileChanged = false;
+
+    //! Recursive because strategies call their public methods themselves, see mutex()
+    mutable QRecursiveMutex m_mutex;
 };
 
 //Q_DECLARE_METATYPE(LoadAndStoreStrategy::Error)
@@ -4,12 +4,16 @@ HEADERS += \
     $$PWD/pythonloadandstorestrategy.hpp \
     model/cachingmodelmanager.hpp \
     model/data.hpp \
+    model/directorysnapshot.hpp \
     model/image.hpp \
     model/loadandstorestrategy.hpp \
     model/modelmanager.hpp \
     model/objectmodel.hpp \
     model/jsonloadandstorestrategy.hpp \
-    model/pose.hpp
+    model/jsonstreamreader.hpp \
+    model/journalloadandstorestrategy.hpp \
+    model/pose.hpp \
+    model/posesnapshot.hpp
 
 SOURCES += \
     $$PWD/pythonloadandstorestrategy.cpp \
@@ -18,5 +22,9 @@ SOURCES += \
     model/loadandstorestrategy.cpp \
     model/cachingmodelmanager.cpp \
     model/modelmanager.cpp \
+    model/directorysnapshot.cpp \
     model/jsonloadandstorestrategy.cpp \
-    model/pose.cpp
+    model/jsonstreamreader.cpp \
+    model/journalloadandstorestrategy.cpp \
+    model/pose.cpp \
+    model/posesnapshot.cpp
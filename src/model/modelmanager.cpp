@@ -2,7 +2,13 @@
 
 ModelManager::ModelManager(LoadAndStoreStrategyPtr loadAndStoreStrategy) : m_loadAndStoreStrategy(loadAndStoreStrategy) {
     qRegisterMetaType<ModelManager::State>("ModelManager::State");
+    // The managers live on a different thread than the views
+    qRegisterMetaType<QList<ImagePtr>>("QList<ImagePtr>");
+    qRegisterMetaType<QList<ObjectModelPtr>>("QList<ObjectModelPtr>");
 }
 
 ModelManager::~ModelManager() {
 }
+
+void ModelManager::applySettings(SettingsPtr /*settings*/) {
+}
@@ -61,6 +61,13 @@ public:
      */
     virtual void setLoadAndStoreStrategy(LoadAndStoreStrategyPtr strategy) = 0;
 
+    /*!
+     * \brief applySettings uses the given settings to adjust how this manager keeps the
+     * entities. Does nothing by default.
+     * \param settings the settings to use
+     */
+    virtual void applySettings(SettingsPtr settings);
+
     /*!
      * \brief getImages Returns the list of all images loaded by this manager.
      * \return the list of all images loaded by this manager
@@ -106,7 +113,7 @@ public:
      * \return all poses of the given image and given object model
      */
     virtual QList<PosePtr> posesForImageAndObjectModel(const Image& image,
-                                                          const ObjectModel& objectModel) = 0;
+                                                          const ObjectModel& objectModel) const = 0;
 
     /*!
      * \brief addObjectImagePose Adds a new ObjectImagePose to the poses managed by this manager.
@@ -150,6 +157,28 @@ public:
      */
     virtual bool removePose(const QString &id) = 0;
 
+    /*!
+     * \brief removePoses Removes all poses with the given IDs that are managed by this manager.
+     * IDs of poses that this manager does not manage are ignored.
+     * \param ids the IDs of the poses to remove
+     * \return true if all poses managed by this manager could be removed, also from
+     * the filesystem
+     */
+    virtual bool removePoses(const QList<QString> &ids) = 0;
+
+    /*!
+     * \brief savePoses Adds, updates and removes the given poses and persists all changes
+     * at once using the LoadAndStoreStrategy. The changes are only applied to the poses
+     * managed by this manager if persisting them was successful.
+     * \param posesToAdd the poses to add to the poses managed by this manager
+     * \param posesToUpdate the poses that hold the new values for the managed poses with the same IDs
+     * \param idsToRemove the IDs of the poses to remove
+     * \return true if persisting all changes was successful
+     */
+    virtual bool savePoses(const QList<PosePtr> &posesToAdd,
+                           const QList<PosePtr> &posesToUpdate,
+                           const QList<QString> &idsToRemove) = 0;
+
 public Q_SLOTS:
     /*!
      * \brief reload reads all data from the persitence storage again and
@@ -162,7 +191,24 @@ Q_SIGNALS:
     void poseAdded(PosePtr pose);
     void poseUpdated(PosePtr pose);
     void poseDeleted(PosePtr pose);
-    void stateChanged(ModelManager::State state, const QString &error);
+    /*!
+     * The following signals are emitted instead of dataChanged when only single files of the images
+     * or object models folder changed. The lists of the manager are already updated when they are
+     * emitted, the poses of removed images or object models are no longer managed.
+     */
+    void imagesAdded(const QList<ImagePtr> &images);
+    void imagesRemoved(const QList<ImagePtr> &images);
+    //! The files of the images changed but the images themselves are still the same
+    void imagesModified(const QList<ImagePtr> &images);
+    void objectModelsAdded(const QList<ObjectModelPtr> &objectModels);
+    void objectModelsRemoved(const QList<ObjectModelPtr> &objectModels);
+    void objectModelsModified(const QList<ObjectModelPtr> &objectModels);
+    /*!
+     * \brief stateChanged is emitted when the manager starts or finishes loading data or an
+     * error occured. While loading, it is emitted repeatedly with the loading progress.
+     * \param progress the loading progress in percent, -1 if it is not known
+     */
+    void stateChanged(ModelManager::State state, const QString &error, int progress = -1);
 };
 
 #endif // MODELMANAGER_H
@@ -0,0 +1,365 @@
+#include "posesnapshot.hpp"
+
+#include <cstring>
+
+#include <QSaveFile>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QVector3D>
+#include <QMatrix3x3>
+
+const QString PoseSnapshot::FILE_SUFFIX = ".snapshot";
+
+//! "6DPS" in host byte order, i.e. a snapshot of a different byte order doesn't match
+static const quint32 SNAPSHOT_MAGIC = 0x53504436;
+static const quint32 SNAPSHOT_VERSION = 2;
+//! Set if entries of the poses file have been left out
+static const quint32 SNAPSHOT_FLAG_INCOMPLETE = 0x1;
+
+namespace {
+
+struct StringRef {
+    quint64 offset;
+    quint32 length;
+    quint32 padding;
+};
+
+struct Header {
+    quint32 magic;
+    quint32 version;
+    quint32 flags;
+    quint32 padding;
+    qint64 posesFileSize;
+    qint64 posesFileLastModified;
+    quint32 imageCount;
+    quint32 objectModelCount;
+    quint64 poseCount;
+    quint64 imagesOffset;
+    quint64 objectModelsOffset;
+    quint64 posesOffset;
+    quint64 stringsOffset;
+    quint64 stringsSize;
+};
+
+struct ImageRecord {
+    StringRef path;
+    //! Index of the first pose record of the image, the poses of an image are stored consecutively
+    quint64 firstPose;
+    quint64 poseCount;
+};
+
+struct ObjectModelRecord {
+    StringRef path;
+};
+
+struct PoseRecord {
+    //! Row-major like in the poses JSON file
+    float rotation[9];
+    float translation[3];
+    quint32 objectModelIndex;
+    quint32 padding;
+    StringRef id;
+};
+
+}
+
+Q_STATIC_ASSERT(sizeof(Header) == 88);
+Q_STATIC_ASSERT(sizeof(ImageRecord) == 32);
+Q_STATIC_ASSERT(sizeof(ObjectModelRecord) == 16);
+Q_STATIC_ASSERT(sizeof(PoseRecord) == 72);
+
+PoseSnapshot::PoseSnapshot() {
+}
+
+PoseSnapshot::~PoseSnapshot() {
+    close();
+}
+
+static bool sectionFits(quint64 offset, quint64 count, quint64 recordSize, qint64 size) {
+    return offset <= (quint64) size && count <= ((quint64) size - offset) / recordSize;
+}
+
+bool PoseSnapshot::open(const QString &path) {
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QFile::ReadOnly)) {
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size < (qint64) sizeof(Header)) {
+        close();
+        return false;
+    }
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        close();
+        return false;
+    }
+
+    const Header *header = reinterpret_cast<const Header*>(m_data);
+    if (header->magic != SNAPSHOT_MAGIC
+            || header->version != SNAPSHOT_VERSION
+            || !sectionFits(header->imagesOffset, header->imageCount, sizeof(ImageRecord), m_size)
+            || !sectionFits(header->objectModelsOffset, header->objectModelCount,
+                            sizeof(ObjectModelRecord), m_size)
+            || !sectionFits(header->posesOffset, header->poseCount, sizeof(PoseRecord), m_size)
+            || !sectionFits(header->stringsOffset, header->stringsSize, 1, m_size)) {
+        close();
+        return false;
+    }
+
+    const ImageRecord *images = reinterpret_cast<const ImageRecord*>(m_data + header->imagesOffset);
+    for (quint32 i = 0; i < header->imageCount; i++) {
+        const ImageRecord &record = images[i];
+        if (record.firstPose > header->poseCount
+                || record.poseCount > header->poseCount - record.firstPose) {
+            close();
+            return false;
+        }
+        m_imageIndicesForPaths.insert(stringAt(record.path.offset, record.path.length), i);
+    }
+
+    return true;
+}
+
+void PoseSnapshot::close() {
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+    }
+    m_file.close();
+    m_data = Q_NULLPTR;
+    m_size = 0;
+    m_imageIndicesForPaths.clear();
+}
+
+bool PoseSnapshot::isOpen() const {
+    return m_data != Q_NULLPTR;
+}
+
+bool PoseSnapshot::isUpToDateWith(const QFileInfo &posesFile) const {
+    if (!isOpen()) {
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header*>(m_data);
+    return header->posesFileSize == posesFile.size()
+            && header->posesFileLastModified == posesFile.lastModified().toMSecsSinceEpoch();
+}
+
+bool PoseSnapshot::isComplete() const {
+    if (!isOpen()) {
+        return false;
+    }
+    return !(reinterpret_cast<const Header*>(m_data)->flags & SNAPSHOT_FLAG_INCOMPLETE);
+}
+
+int PoseSnapshot::poseCount() const {
+    if (!isOpen()) {
+        return 0;
+    }
+    return (int) reinterpret_cast<const Header*>(m_data)->poseCount;
+}
+
+QString PoseSnapshot::stringAt(quint64 offset, quint32 length) const {
+    const Header *header = reinterpret_cast<const Header*>(m_data);
+    if (offset > header->stringsSize || length > header->stringsSize - offset) {
+        return QString();
+    }
+    return QString::fromUtf8(reinterpret_cast<const char*>(m_data + header->stringsOffset + offset),
+                             (int) length);
+}
+
+QList<ObjectModelPtr> PoseSnapshot::objectModelsForIndices(const QList<ObjectModelPtr> &objectModels) const {
+    const Header *header = reinterpret_cast<const Header*>(m_data);
+    QHash<QString, ObjectModelPtr> objectModelsForPaths;
+    for (const ObjectModelPtr &objectModel : objectModels) {
+        objectModelsForPaths.insert(objectModel->path(), objectModel);
+    }
+    //! Resolve every object model once instead of once per pose
+    const ObjectModelRecord *records =
+            reinterpret_cast<const ObjectModelRecord*>(m_data + header->objectModelsOffset);
+    QList<ObjectModelPtr> objectModelsForIndices;
+    for (quint32 i = 0; i < header->objectModelCount; i++) {
+        objectModelsForIndices.append(
+                    objectModelsForPaths.value(stringAt(records[i].path.offset, records[i].path.length)));
+    }
+    return objectModelsForIndices;
+}
+
+QList<PosePtr> PoseSnapshot::loadPosesForImageIndex(int imageIndex,
+                                                    const ImagePtr &image,
+                                                    const QList<ObjectModelPtr> &objectModelsForIndices) const {
+    const Header *header = reinterpret_cast<const Header*>(m_data);
+    const ImageRecord &imageRecord =
+            reinterpret_cast<const ImageRecord*>(m_data + header->imagesOffset)[imageIndex];
+    const PoseRecord *records = reinterpret_cast<const PoseRecord*>(m_data + header->posesOffset);
+
+    QList<PosePtr> poses;
+    for (quint64 i = imageRecord.firstPose; i < imageRecord.firstPose + imageRecord.poseCount; i++) {
+        const PoseRecord &record = records[i];
+        ObjectModelPtr objectModel = objectModelsForIndices.value((int) record.objectModelIndex);
+        if (!objectModel) {
+            //! Same as for the JSON file, we skip poses of object models we don't manage
+            continue;
+        }
+        poses.append(PosePtr(new Pose(stringAt(record.id.offset, record.id.length),
+                                      QVector3D(record.translation[0],
+                                                record.translation[1],
+                                                record.translation[2]),
+                                      QMatrix3x3(record.rotation),
+                                      image,
+                                      objectModel)));
+    }
+    return poses;
+}
+
+QList<PosePtr> PoseSnapshot::loadPoses(const QList<ImagePtr> &images,
+                                       const QList<ObjectModelPtr> &objectModels) const {
+    QList<PosePtr> poses;
+    if (!isOpen()) {
+        return poses;
+    }
+
+    QHash<QString, ImagePtr> imagesForPaths;
+    for (const ImagePtr &image : images) {
+        imagesForPaths.insert(image->imagePath(), image);
+    }
+    QList<ObjectModelPtr> objectModelsForIndices = this->objectModelsForIndices(objectModels);
+
+    //! Iterate the image table instead of the given images to keep the order of the JSON file
+    const Header *header = reinterpret_cast<const Header*>(m_data);
+    const ImageRecord *records = reinterpret_cast<const ImageRecord*>(m_data + header->imagesOffset);
+    for (quint32 i = 0; i < header->imageCount; i++) {
+        ImagePtr image = imagesForPaths.value(stringAt(records[i].path.offset, records[i].path.length));
+        if (image) {
+            poses.append(loadPosesForImageIndex(i, image, objectModelsForIndices));
+        }
+    }
+    return poses;
+}
+
+QList<PosePtr> PoseSnapshot::loadPosesForImage(const ImagePtr &image,
+                                               const QList<ObjectModelPtr> &objectModels) const {
+    if (!isOpen() || !m_imageIndicesForPaths.contains(image->imagePath())) {
+        return QList<PosePtr>();
+    }
+    return loadPosesForImageIndex(m_imageIndicesForPaths.value(image->imagePath()),
+                                  image,
+                                  objectModelsForIndices(objectModels));
+}
+
+static StringRef appendString(QByteArray &strings, const QString &string) {
+    QByteArray utf8 = string.toUtf8();
+    StringRef stringRef;
+    stringRef.offset = (quint64) strings.size();
+    stringRef.length = (quint32) utf8.size();
+    stringRef.padding = 0;
+    strings.append(utf8);
+    return stringRef;
+}
+
+void PoseSnapshot::Writer::addImage(const QString &imagePath) {
+    ImageRecord record;
+    record.path = appendString(m_strings, imagePath);
+    record.firstPose = m_poseCount;
+    record.poseCount = 0;
+    m_imageRecords.append(reinterpret_cast<const char*>(&record), sizeof(ImageRecord));
+}
+
+void PoseSnapshot::Writer::addPose(const QString &id,
+                                   const QString &objectModelPath,
+                                   const float rotation[9],
+                                   const float translation[3]) {
+    Q_ASSERT(!m_imageRecords.isEmpty());
+
+    auto it = m_objectModelIndicesForPaths.constFind(objectModelPath);
+    if (it == m_objectModelIndicesForPaths.constEnd()) {
+        ObjectModelRecord objectModelRecord;
+        objectModelRecord.path = appendString(m_strings, objectModelPath);
+        it = m_objectModelIndicesForPaths.insert(
+                    objectModelPath, (quint32) (m_objectModelRecords.size() / sizeof(ObjectModelRecord)));
+        m_objectModelRecords.append(reinterpret_cast<const char*>(&objectModelRecord),
+                                    sizeof(ObjectModelRecord));
+    }
+
+    PoseRecord record;
+    memcpy(record.rotation, rotation, sizeof(record.rotation));
+    memcpy(record.translation, translation, sizeof(record.translation));
+    record.objectModelIndex = it.value();
+    record.padding = 0;
+    record.id = appendString(m_strings, id);
+    m_poseRecords.append(reinterpret_cast<const char*>(&record), sizeof(PoseRecord));
+    m_poseCount++;
+
+    ImageRecord *imageRecord = reinterpret_cast<ImageRecord*>(
+                m_imageRecords.data() + m_imageRecords.size() - sizeof(ImageRecord));
+    imageRecord->poseCount++;
+}
+
+void PoseSnapshot::Writer::markIncomplete() {
+    m_complete = false;
+}
+
+bool PoseSnapshot::Writer::write(const QString &path, const QFileInfo &posesFile) const {
+    Header header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.flags = m_complete ? 0 : SNAPSHOT_FLAG_INCOMPLETE;
+    header.padding = 0;
+    header.posesFileSize = posesFile.size();
+    header.posesFileLastModified = posesFile.lastModified().toMSecsSinceEpoch();
+    header.imageCount = (quint32) (m_imageRecords.size() / sizeof(ImageRecord));
+    header.objectModelCount = (quint32) (m_objectModelRecords.size() / sizeof(ObjectModelRecord));
+    header.poseCount = m_poseCount;
+    header.imagesOffset = sizeof(Header);
+    header.objectModelsOffset = header.imagesOffset + m_imageRecords.size();
+    header.posesOffset = header.objectModelsOffset + m_objectModelRecords.size();
+    header.stringsOffset = header.posesOffset + m_poseRecords.size();
+    header.stringsSize = (quint64) m_strings.size();
+
+    //! Never leave a truncated snapshot behind
+    QSaveFile snapshotFile(path);
+    if (!snapshotFile.open(QFile::WriteOnly)) {
+        return false;
+    }
+    snapshotFile.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    snapshotFile.write(m_imageRecords);
+    snapshotFile.write(m_objectModelRecords);
+    snapshotFile.write(m_poseRecords);
+    snapshotFile.write(m_strings);
+    return snapshotFile.commit();
+}
+
+void PoseSnapshot::Writer::addJson(const QJsonObject &posesJson) {
+    for (auto it = posesJson.constBegin(); it != posesJson.constEnd(); it++) {
+        addImage(it.key());
+        const QJsonArray entriesForImage = it.value().toArray();
+        for (const QJsonValue &entryRaw : entriesForImage) {
+            QJsonObject entry = entryRaw.toObject();
+            QJsonArray rotationArray = entry["R"].toArray();
+            QJsonArray translationArray = entry["t"].toArray();
+            if (!entry.contains("id") || !entry.contains("obj")
+                    || rotationArray.size() != 9 || translationArray.size() != 3) {
+                markIncomplete();
+                continue;
+            }
+            float rotation[9];
+            for (int i = 0; i < 9; i++) {
+                rotation[i] = (float) rotationArray[i].toDouble();
+            }
+            float translation[3];
+            for (int i = 0; i < 3; i++) {
+                translation[i] = (float) translationArray[i].toDouble();
+            }
+            addPose(entry["id"].toString(), entry["obj"].toString(), rotation, translation);
+        }
+    }
+}
+
+bool PoseSnapshot::write(const QString &path,
+                         const QJsonObject &posesJson,
+                         const QFileInfo &posesFile) {
+    Writer writer;
+    writer.addJson(posesJson);
+    return writer.write(path, posesFile);
+}
@@ -0,0 +1,140 @@
+#ifndef POSESNAPSHOT_H
+#define POSESNAPSHOT_H
+
+#include "pose.hpp"
+#include "image.hpp"
+#include "objectmodel.hpp"
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QByteArray>
+
+/*!
+ * \brief The PoseSnapshot class provides a binary representation of the poses JSON file which can be
+ * loaded without parsing. The file consists of a header, a table of the image paths that stores the
+ * range of poses of each image (i.e. the offset index), a table of the object model paths, fixed-size
+ * pose records of the rotation matrix, translation vector and object model index and finally a blob
+ * of all UTF-8 encoded strings.
+ *
+ * The file is memory-mapped and pose records are only read when poses are actually created from them.
+ * The snapshot stores the size and modification date of the JSON file it has been created from to be
+ * able to detect whether it is outdated. The values are written in host byte order, a snapshot of a
+ * machine with a different byte order is rejected as invalid.
+ *
+ * Entries that lack data are left out of the snapshot and the snapshot is marked as incomplete. It can
+ * still serve the poses of single images but loading all poses should parse the JSON file to report them.
+ */
+class PoseSnapshot {
+
+public:
+    //! The suffix that is appended to the path of the poses JSON file to get the path of the snapshot
+    static const QString FILE_SUFFIX;
+
+    PoseSnapshot();
+
+    ~PoseSnapshot();
+
+    /*!
+     * \brief open maps the snapshot at the given path into memory. Any previously opened
+     * snapshot is closed.
+     * \param path the path to the snapshot file
+     * \return true if the file exists and is a valid snapshot, false otherwise
+     */
+    bool open(const QString &path);
+
+    void close();
+
+    bool isOpen() const;
+
+    /*!
+     * \brief isUpToDateWith returns whether the snapshot has been created from the given
+     * poses JSON file in its current state.
+     */
+    bool isUpToDateWith(const QFileInfo &posesFile) const;
+
+    //! Returns false if entries of the poses JSON file have been left out, see Writer::markIncomplete
+    bool isComplete() const;
+
+    int poseCount() const;
+
+    /*!
+     * \brief loadPoses creates the poses of all images and object models contained in the
+     * given lists. Records of other images are not read at all.
+     */
+    QList<PosePtr> loadPoses(const QList<ImagePtr> &images,
+                             const QList<ObjectModelPtr> &objectModels) const;
+
+    /*!
+     * \brief loadPosesForImage creates only the poses of the given image.
+     */
+    QList<PosePtr> loadPosesForImage(const ImagePtr &image,
+                                     const QList<ObjectModelPtr> &objectModels) const;
+
+    /*!
+     * \brief write creates a snapshot from the content of a poses JSON file, i.e. imports
+     * it. Entries that lack an ID, the object model, rotation or translation are left out.
+     * \param path the path to write the snapshot to
+     * \param posesJson the content of the poses JSON file
+     * \param posesFile the poses JSON file whose current state the content represents
+     * \return true if the snapshot has been written, false otherwise
+     */
+    static bool write(const QString &path,
+                      const QJsonObject &posesJson,
+                      const QFileInfo &posesFile);
+
+    /*!
+     * \brief The Writer class assembles a snapshot entry by entry, e.g. while streaming the
+     * poses JSON file. The records are kept in their binary form until written.
+     */
+    class Writer {
+
+    public:
+        //! Starts the poses of the given image, i.e. all following poses belong to it
+        void addImage(const QString &imagePath);
+
+        /*!
+         * \brief addJson adds all images and poses of the content of a poses JSON file.
+         * Incomplete entries are left out and mark the snapshot as incomplete.
+         */
+        void addJson(const QJsonObject &posesJson);
+
+        void addPose(const QString &id,
+                     const QString &objectModelPath,
+                     const float rotation[9],
+                     const float translation[3]);
+
+        //! Records that the snapshot doesn't hold all entries of the poses JSON file as they are
+        void markIncomplete();
+
+        bool write(const QString &path, const QFileInfo &posesFile) const;
+
+    private:
+        QByteArray m_imageRecords;
+        QByteArray m_objectModelRecords;
+        QByteArray m_poseRecords;
+        QByteArray m_strings;
+        quint64 m_poseCount = 0;
+        bool m_complete = true;
+        QHash<QString, quint32> m_objectModelIndicesForPaths;
+    };
+
+private:
+    QString stringAt(quint64 offset, quint32 length) const;
+    QList<PosePtr> loadPosesForImageIndex(int imageIndex,
+                                          const ImagePtr &image,
+                                          const QList<ObjectModelPtr> &objectModelsForIndices) const;
+    QList<ObjectModelPtr> objectModelsForIndices(const QList<ObjectModelPtr> &objectModels) const;
+
+private:
+    QFile m_file;
+    const uchar *m_data = Q_NULLPTR;
+    qint64 m_size = 0;
+    //! Built when opening the snapshot, the image table is small compared to the poses
+    QHash<QString, int> m_imageIndicesForPaths;
+};
+
+#endif // POSESNAPSHOT_H
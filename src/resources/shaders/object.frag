@@ -75,8 +75,8 @@ uniform vec3 colors[10];
 uniform int clickCount;
 uniform bool useDiffuseTexture;
 uniform float circumfence;
-uniform vec4 selected;
-uniform float opacity;
+in vec4 highlightColor;
+in float fragmentOpacity;
 
 #line 18
 out vec4 fragColor;
@@ -91,8 +91,8 @@ void main()
     }
     vec4 currentColor = phongFunction(ka, finalDiffuse, ks, shininess, worldPosition, normalize(((eyePosition - worldPosition))), normalize(worldNormal));
 
-    currentColor += selected;
-    currentColor = vec4(vec3(currentColor), opacity);
+    currentColor += highlightColor;
+    currentColor = vec4(vec3(currentColor), fragmentOpacity);
 
     bool isClicked = false;
     bool isAroundClick = false;
@@ -114,7 +114,7 @@ void main()
        }
        if (isClicked)
        {
-          currentColor = vec4(colors[i], opacity);
+          currentColor = vec4(colors[i], fragmentOpacity);
           break;
        }
     }
@@ -10,6 +10,8 @@ out vec3 worldNormal;
 out vec4 worldTangent;
 out vec2 texCoord;
 out vec3 interpolatedVertex;
+out vec4 highlightColor;
+out float fragmentOpacity;
 
 uniform mat4 modelMatrix;
 uniform mat3 modelNormalMatrix;
@@ -18,6 +20,8 @@ uniform mat4 projectionMatrix;
 uniform mat4 viewMatrix;
 
 uniform float texCoordScale;
+uniform vec4 selected;
+uniform float opacity;
 
 void main()
 {
@@ -33,6 +37,10 @@ void main()
     worldTangent.xyz = normalize(vec3(modelMatrix * vec4(vertexTangent.xyz, 0.0)));
     worldTangent.w = vertexTangent.w;
 
+    // Passed on to be able to provide them per instance in the instanced shader
+    highlightColor = selected;
+    fragmentOpacity = opacity;
+
     // Calculate vertex position in clip coordinates
     gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(vertexPosition, 1.0);
 }
@@ -0,0 +1,52 @@
+#version 140
+
+in vec3 vertexPosition;
+in vec3 vertexNormal;
+in vec4 vertexTangent;
+in vec2 vertexTexCoord;
+
+// One per pose, see PoseInstancesRenderable
+in mat4 instanceModelMatrix;
+in vec4 instanceHighlightColor;
+in float instanceOpacity;
+
+out vec3 worldPosition;
+out vec3 worldNormal;
+out vec4 worldTangent;
+out vec2 texCoord;
+out vec3 interpolatedVertex;
+out vec4 highlightColor;
+out float fragmentOpacity;
+
+uniform mat4 modelMatrix;
+uniform mat4 projectionMatrix;
+uniform mat4 viewMatrix;
+
+uniform float texCoordScale;
+// Masks the highlight color of the instances, set to zero when taking a snapshot
+uniform vec4 selected;
+
+void main()
+{
+    // Pass through interpolated vertex position
+    interpolatedVertex = vertexPosition;
+
+    // Pass through scaled texture coordinates
+    texCoord = vertexTexCoord * texCoordScale;
+
+    // The model matrix is the one of the part of the object model, the pose is applied afterwards
+    mat4 instanceMatrix = instanceModelMatrix * modelMatrix;
+    mat3 instanceNormalMatrix = transpose(inverse(mat3(instanceMatrix)));
+
+    // Transform position, normal, and tangent to world space
+    worldPosition = vec3(instanceMatrix * vec4(vertexPosition, 1.0));
+    worldNormal = normalize(instanceNormalMatrix * vertexNormal);
+    worldTangent.xyz = normalize(vec3(instanceMatrix * vec4(vertexTangent.xyz, 0.0)));
+    worldTangent.w = vertexTangent.w;
+
+    highlightColor = instanceHighlightColor * selected;
+    fragmentOpacity = instanceOpacity;
+
+    // Calculate vertex position in clip coordinates
+    gl_Position = projectionMatrix * viewMatrix * vec4(worldPosition, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 140
+
+// Identifies the pose renderable, 0 is the cleared buffer
+uniform float pickId;
+
+out vec4 fragColor;
+
+void main(void)
+{
+    // The window depth is needed to translate the picked pose in the plane of the cursor
+    fragColor = vec4(pickId, gl_FragCoord.z, 0.0, 1.0);
+}
@@ -24,6 +24,14 @@ Settings::Settings(const Settings &settings) {
     this->m_selectPoseRenderableMouseButton = settings.m_selectPoseRenderableMouseButton;
     this->m_translatePoseRenderableMouseButton = settings.m_translatePoseRenderableMouseButton;
     this->m_rotatePoseRenderableMouseButton = settings.m_rotatePoseRenderableMouseButton;
+    this->m_loadingThreadCount = settings.m_loadingThreadCount;
+    this->m_lazyPoseLoading = settings.m_lazyPoseLoading;
+    this->m_poseCacheSize = settings.m_poseCacheSize;
+    this->m_thumbnailCacheSize = settings.m_thumbnailCacheSize;
+    this->m_instancedRendering = settings.m_instancedRendering;
+    this->m_continuousRendering = settings.m_continuousRendering;
+    this->m_adaptiveResolution = settings.m_adaptiveResolution;
+    this->m_prefetchWindow = settings.m_prefetchWindow;
 }
 
 Settings::~Settings() {
@@ -188,3 +196,67 @@ bool Settings::showFPSLabel() const {
 void Settings::setShowFPSLabel(bool newShowFPSLabel) {
     m_showFPSLabel = newShowFPSLabel;
 }
+
+int Settings::loadingThreadCount() const {
+    return m_loadingThreadCount;
+}
+
+void Settings::setLoadingThreadCount(int loadingThreadCount) {
+    m_loadingThreadCount = loadingThreadCount;
+}
+
+bool Settings::lazyPoseLoading() const {
+    return m_lazyPoseLoading;
+}
+
+void Settings::setLazyPoseLoading(bool lazyPoseLoading) {
+    m_lazyPoseLoading = lazyPoseLoading;
+}
+
+int Settings::poseCacheSize() const {
+    return m_poseCacheSize;
+}
+
+void Settings::setPoseCacheSize(int poseCacheSize) {
+    m_poseCacheSize = poseCacheSize;
+}
+
+int Settings::thumbnailCacheSize() const {
+    return m_thumbnailCacheSize;
+}
+
+void Settings::setThumbnailCacheSize(int thumbnailCacheSize) {
+    m_thumbnailCacheSize = thumbnailCacheSize;
+}
+
+bool Settings::instancedRendering() const {
+    return m_instancedRendering;
+}
+
+void Settings::setInstancedRendering(bool instancedRendering) {
+    m_instancedRendering = instancedRendering;
+}
+
+bool Settings::continuousRendering() const {
+    return m_continuousRendering;
+}
+
+void Settings::setContinuousRendering(bool continuousRendering) {
+    m_continuousRendering = continuousRendering;
+}
+
+bool Settings::adaptiveResolution() const {
+    return m_adaptiveResolution;
+}
+
+void Settings::setAdaptiveResolution(bool adaptiveResolution) {
+    m_adaptiveResolution = adaptiveResolution;
+}
+
+int Settings::prefetchWindow() const {
+    return m_prefetchWindow;
+}
+
+void Settings::setPrefetchWindow(int prefetchWindow) {
+    m_prefetchWindow = prefetchWindow;
+}
@@ -18,7 +18,8 @@ public:
 
     enum UsedLoadAndStoreStrategy {
         Default,
-        Python
+        Python,
+        Journal
     };
 
     Settings(const QString &identifier);
@@ -88,6 +89,38 @@ public:
     bool showFPSLabel() const;
     void setShowFPSLabel(bool newShowFPSLabel);
 
+    //! The number of threads used to load data, 0 means one thread per core
+    int loadingThreadCount() const;
+    void setLoadingThreadCount(int loadingThreadCount);
+
+    //! Whether poses are only loaded when the poses of an image are requested
+    bool lazyPoseLoading() const;
+    void setLazyPoseLoading(bool lazyPoseLoading);
+
+    //! The memory in MiB that lazily loaded poses may take up
+    int poseCacheSize() const;
+    void setPoseCacheSize(int poseCacheSize);
+
+    //! The memory in MiB that the thumbnails displayed in the galleries may take up
+    int thumbnailCacheSize() const;
+    void setThumbnailCacheSize(int thumbnailCacheSize);
+
+    //! Whether the pose viewer draws all poses of an object model with a single instanced draw call
+    bool instancedRendering() const;
+    void setInstancedRendering(bool instancedRendering);
+
+    //! Whether the pose viewer renders every frame instead of only after changes, e.g. to profile it
+    bool continuousRendering() const;
+    void setContinuousRendering(bool continuousRendering);
+
+    //! Whether the pose viewer renders at a lower resolution while the user drags the image or a pose
+    bool adaptiveResolution() const;
+    void setAdaptiveResolution(bool adaptiveResolution);
+
+    //! The number of images before and after the selected one that are loaded in the background
+    int prefetchWindow() const;
+    void setPrefetchWindow(int prefetchWindow);
+
 private:
     QString m_identifier;
 
@@ -108,6 +141,14 @@ private:
     Theme m_theme;
     int m_multisampleSamples = 2;
     bool m_showFPSLabel = true;
+    int m_loadingThreadCount = 0;
+    bool m_lazyPoseLoading = false;
+    int m_poseCacheSize = 256;
+    int m_thumbnailCacheSize = 256;
+    bool m_instancedRendering = false;
+    bool m_continuousRendering = false;
+    bool m_adaptiveResolution = false;
+    int m_prefetchWindow = 2;
 };
 
 typedef QSharedPointer<Settings> SettingsPtr;
@@ -37,6 +37,14 @@ void SettingsStore::saveCurrentSettings() {
     settings.setValue(CLICK_3D_SIZE, m_currentSettings->click3DSize());
     settings.setValue(MULTISAMPLING_SAMLPES, m_currentSettings->multisampleSamples());
     settings.setValue(SHOW_FPS_LABEL, m_currentSettings->showFPSLabel());
+    settings.setValue(LOADING_THREAD_COUNT, m_currentSettings->loadingThreadCount());
+    settings.setValue(LAZY_POSE_LOADING, m_currentSettings->lazyPoseLoading());
+    settings.setValue(POSE_CACHE_SIZE, m_currentSettings->poseCacheSize());
+    settings.setValue(THUMBNAIL_CACHE_SIZE, m_currentSettings->thumbnailCacheSize());
+    settings.setValue(INSTANCED_RENDERING, m_currentSettings->instancedRendering());
+    settings.setValue(CONTINUOUS_RENDERING, m_currentSettings->continuousRendering());
+    settings.setValue(ADAPTIVE_RESOLUTION, m_currentSettings->adaptiveResolution());
+    settings.setValue(PREFETCH_WINDOW, m_currentSettings->prefetchWindow());
     settings.endGroup();
 
     //! Persist the object color codes so that the user does not have to enter them at each program start
@@ -100,6 +108,14 @@ void SettingsStore::setCurrentSettings(const QString &identifier) {
     settingsPointer->setClick3DSize(settings.value(CLICK_3D_SIZE, 0.5).toFloat());
     settingsPointer->setMultisampleSamples(settings.value(MULTISAMPLING_SAMLPES, 2).toInt());
     settingsPointer->setShowFPSLabel(settings.value(SHOW_FPS_LABEL, true).toBool());
+    settingsPointer->setLoadingThreadCount(settings.value(LOADING_THREAD_COUNT, 0).toInt());
+    settingsPointer->setLazyPoseLoading(settings.value(LAZY_POSE_LOADING, false).toBool());
+    settingsPointer->setPoseCacheSize(settings.value(POSE_CACHE_SIZE, 256).toInt());
+    settingsPointer->setThumbnailCacheSize(settings.value(THUMBNAIL_CACHE_SIZE, 256).toInt());
+    settingsPointer->setInstancedRendering(settings.value(INSTANCED_RENDERING, false).toBool());
+    settingsPointer->setContinuousRendering(settings.value(CONTINUOUS_RENDERING, false).toBool());
+    settingsPointer->setAdaptiveResolution(settings.value(ADAPTIVE_RESOLUTION, false).toBool());
+    settingsPointer->setPrefetchWindow(settings.value(PREFETCH_WINDOW, 2).toInt());
     // TODO read mouse buttons
     settings.endGroup();
 
@@ -142,3 +158,11 @@ const QString SettingsStore::TRANSLATE_POSE_RENDERABLE_MOUSE_BUTTON =
 const QString SettingsStore::CLICK_3D_SIZE = "click3dsize";
 const QString SettingsStore::MULTISAMPLING_SAMLPES = "multisampleSamples";
 const QString SettingsStore::SHOW_FPS_LABEL = "showFPSLabel";
+const QString SettingsStore::LOADING_THREAD_COUNT = "loadingThreadCount";
+const QString SettingsStore::LAZY_POSE_LOADING = "lazyPoseLoading";
+const QString SettingsStore::POSE_CACHE_SIZE = "poseCacheSize";
+const QString SettingsStore::THUMBNAIL_CACHE_SIZE = "thumbnailCacheSize";
+const QString SettingsStore::INSTANCED_RENDERING = "instancedRendering";
+const QString SettingsStore::CONTINUOUS_RENDERING = "continuousRendering";
+const QString SettingsStore::ADAPTIVE_RESOLUTION = "adaptiveResolution";
+const QString SettingsStore::PREFETCH_WINDOW = "prefetchWindow";
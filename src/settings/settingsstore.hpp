@@ -81,6 +81,14 @@ private:
     static const QString CLICK_3D_SIZE;
     static const QString MULTISAMPLING_SAMLPES;
     static const QString SHOW_FPS_LABEL;
+    static const QString LOADING_THREAD_COUNT;
+    static const QString LAZY_POSE_LOADING;
+    static const QString POSE_CACHE_SIZE;
+    static const QString THUMBNAIL_CACHE_SIZE;
+    static const QString INSTANCED_RENDERING;
+    static const QString CONTINUOUS_RENDERING;
+    static const QString ADAPTIVE_RESOLUTION;
+    static const QString PREFETCH_WINDOW;
 };
 
 typedef QSharedPointer<SettingsStore> SettingsStorePtr;
@@ -19,6 +19,8 @@ Gallery::Gallery(QWidget *parent) :
     DisplayHelper::setIcon(ui->buttonNavigateRight, fa::chevronright, 20);
     ui->frame->layout()->setAlignment(Qt::AlignVCenter);
     ui->listView->horizontalScrollBar()->setSingleStep(10);
+    connect(ui->listView, &IconExpandingListView::visibleRowsChanged,
+            this, &Gallery::visibleItemsChanged);
 }
 
 Gallery::~Gallery() {
@@ -37,6 +37,8 @@ public Q_SLOTS:
 
 Q_SIGNALS:
     void selectedItemChanged(int index);
+    //! Emitted when the range of visible items changes, e.g. when scrolling
+    void visibleItemsChanged(int first, int last);
 
 protected:
     // protected to grant access to subclasses
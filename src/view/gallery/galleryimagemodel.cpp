@@ -2,21 +2,38 @@
 #include <QDebug>
 #include <QIcon>
 #include <QPainter>
+#include <QSet>
 
-GalleryImageModel::GalleryImageModel(ModelManager* modelManager) {
+//! Enough for a few hundred thumbnails of 300 px height
+static const qint64 DEFAULT_THUMBNAIL_CACHE_SIZE = 256 * 1024 * 1024;
+//! Rows before and after the visible ones whose thumbnails are kept in memory right away
+static const int PREFETCHED_ROWS = 20;
+
+GalleryImageModel::GalleryImageModel(ModelManager* modelManager)
+    : thumbnailPixmaps(DEFAULT_THUMBNAIL_CACHE_SIZE) {
     Q_ASSERT(modelManager != Q_NULLPTR);
     this->modelManager = modelManager;
     imagesCache = modelManager->images();
+    if (!thumbnailCache.open(ThumbnailCache::defaultPath())) {
+        qWarning() << "Could not open the thumbnail cache, thumbnails are not persisted.";
+    }
+    resizeImagesThreadpool.setMaxThreadCount(QThread::idealThreadCount());
     resizeImages();
     connect(modelManager, &ModelManager::dataChanged,
             this, &GalleryImageModel::onDataChanged);
+    connect(modelManager, &ModelManager::imagesAdded,
+            this, &GalleryImageModel::onImagesAddedOrRemoved);
+    connect(modelManager, &ModelManager::imagesRemoved,
+            this, &GalleryImageModel::onImagesAddedOrRemoved);
+    connect(modelManager, &ModelManager::imagesModified,
+            this, &GalleryImageModel::onImagesModified);
 }
 
 GalleryImageModel::~GalleryImageModel() {
     resizeImagesThreadpool.killTimer(0);
-    resizeImagesRunnable->stop();
+    // The workers stop after their current image
+    resizeImagesQueue.invalidate();
     resizeImagesThreadpool.waitForDone();
-    delete resizeImagesRunnable;
 }
 
 QVariant GalleryImageModel::data(const QModelIndex &index, int role) const {
@@ -27,11 +44,15 @@ QVariant GalleryImageModel::data(const QModelIndex &index, int role) const {
 
     QString imagePath = imagesCache[index.row()]->imagePath();
     if (role == Qt::DecorationRole) {
-        if (resizedImagesCache.contains(imagePath)) {
-            return QIcon(QPixmap::fromImage(resizedImagesCache[imagePath]));
-        } else {
-            return QIcon(currentLoadingAnimationFrame);
+        QPixmap thumbnail;
+        if (thumbnailPixmaps.find(imagePath, thumbnail)) {
+            return QIcon(thumbnail);
+        }
+        if (resizedImagePaths.contains(imagePath) && !requestedImagePaths.contains(imagePath)) {
+            // Evicted, recreating it is cheap thanks to the thumbnail cache
+            const_cast<GalleryImageModel*>(this)->requestThumbnail(index.row());
         }
+        return QIcon(currentLoadingAnimationFrame);
     } else if (role == Qt::ToolTipRole) {
         return imagePath;
     }
@@ -42,23 +63,78 @@ int GalleryImageModel::rowCount(const QModelIndex &/* parent */) const {
     return imagesCache.size();
 }
 
+void GalleryImageModel::setThumbnailCacheSize(qint64 bytes) {
+    thumbnailPixmaps.setMaxBytes(bytes);
+}
+
 void GalleryImageModel::resizeImages() {
-    if (!resizeImagesRunnable.isNull()) {
-        resizeImagesRunnable->stop();
-        resizeImagesThreadpool.clear();
-        resizeImagesThreadpool.waitForDone();
+    // No need to wait for the workers, the thumbnails they are creating are discarded
+    resizeImagesQueue.invalidate();
+    thumbnailPixmaps.clear();
+    resizedImagePaths.clear();
+    requestedImagePaths.clear();
+    enqueueImagesWithoutThumbnail();
+}
+
+void GalleryImageModel::enqueueImagesWithoutThumbnail() {
+    resizeImagesQueue.clear();
+    QVector<QPair<int, Image>> imagesForRows;
+    for (int row = 0; row < imagesCache.size(); row++) {
+        const ImagePtr &image = imagesCache[row];
+        if (!resizedImagePaths.contains(image->imagePath())
+                || requestedImagePaths.contains(image->imagePath())) {
+            imagesForRows.append(qMakePair(row, *image));
+        }
+    }
+    startResizeImagesRunnables(resizeImagesQueue.enqueue(imagesForRows));
+}
+
+void GalleryImageModel::requestThumbnail(int row) {
+    const ImagePtr &image = imagesCache[row];
+    requestedImagePaths.insert(image->imagePath());
+    QVector<QPair<int, Image>> imagesForRows;
+    imagesForRows.append(qMakePair(row, *image));
+    startResizeImagesRunnables(resizeImagesQueue.enqueue(imagesForRows));
+    m_updateTimer.start();
+}
+
+void GalleryImageModel::startResizeImagesRunnables(int count) {
+    for (int i = 0; i < count; i++) {
+        ResizeImagesRunnable *runnable = new ResizeImagesRunnable(&resizeImagesQueue, &thumbnailCache);
+        connect(runnable, &ResizeImagesRunnable::imageResized,
+                this, &GalleryImageModel::onImageResized);
+        resizeImagesThreadpool.start(runnable);
     }
-    resizedImagesCache.clear();
-    resizeImagesRunnable = new ResizeImagesRunnable(imagesCache);
-    connect(resizeImagesRunnable, &ResizeImagesRunnable::imageResized,
-            this, &GalleryImageModel::onImageResized);
-    resizeImagesThreadpool.start(resizeImagesRunnable);
 }
 
-void GalleryImageModel::onImageResized(int imageIndex, const QString &imagePath, const QImage &resizedImage) {
-    resizedImagesCache[imagePath] = resizedImage;
-    if (imageIndex == imagesCache.size()) {
+void GalleryImageModel::setVisibleRows(int firstRow, int lastRow) {
+    firstVisibleRow = firstRow;
+    lastVisibleRow = lastRow;
+    resizeImagesQueue.setVisibleRows(firstRow, lastRow);
+}
+
+bool GalleryImageModel::isNearVisibleRows(int row) const {
+    return firstVisibleRow >= 0
+            && row >= firstVisibleRow - PREFETCHED_ROWS
+            && row <= lastVisibleRow + PREFETCHED_ROWS;
+}
+
+void GalleryImageModel::onImageResized(int generation, int row, const QString &imagePath, const QImage &resizedImage) {
+    if (generation != resizeImagesQueue.generation()) {
+        // The images have been reloaded in the meantime
+        return;
+    }
+    resizedImagePaths.insert(imagePath);
+    requestedImagePaths.remove(imagePath);
+    // Converting to a pixmap takes time on the GUI thread, i.e. only do it for thumbnails that
+    // are about to be displayed. The others are read from the thumbnail cache when needed.
+    if (isNearVisibleRows(row) || thumbnailPixmaps.bytes() < thumbnailPixmaps.maxBytes()) {
+        thumbnailPixmaps.insert(imagePath, QPixmap::fromImage(resizedImage));
+    }
+    if (resizedImagePaths.size() >= imagesCache.size() && requestedImagePaths.isEmpty()) {
         m_updateTimer.stop();
+        // The timer doesn't trigger an update for the last thumbnails anymore
+        Q_EMIT dataChanged(index(0, 0), index(imagesCache.size() - 1, 0));
     }
 }
 
@@ -73,3 +149,53 @@ void GalleryImageModel::onDataChanged(int data) {
         Q_EMIT dataChanged(top, bottom);
     }
 }
+
+void GalleryImageModel::onImagesAddedOrRemoved() {
+    const QList<ImagePtr> images = modelManager->images();
+    QSet<ImagePtr> currentImages;
+    for (const ImagePtr &image : images) {
+        currentImages.insert(image);
+    }
+
+    for (int row = imagesCache.size() - 1; row >= 0; row--) {
+        if (!currentImages.contains(imagesCache[row])) {
+            beginRemoveRows(QModelIndex(), row, row);
+            thumbnailPixmaps.remove(imagesCache[row]->imagePath());
+            resizedImagePaths.remove(imagesCache[row]->imagePath());
+            requestedImagePaths.remove(imagesCache[row]->imagePath());
+            imagesCache.removeAt(row);
+            endRemoveRows();
+        }
+    }
+
+    // The manager keeps the order of the images, i.e. the remaining images are
+    // in the same order and we only have to fill in the new ones
+    QList<ImagePtr> addedImages;
+    for (int row = 0; row < images.size(); row++) {
+        if (row >= imagesCache.size() || imagesCache[row] != images[row]) {
+            beginInsertRows(QModelIndex(), row, row);
+            imagesCache.insert(row, images[row]);
+            endInsertRows();
+            addedImages.append(images[row]);
+        }
+    }
+
+    if (!addedImages.isEmpty()) {
+        m_updateTimer.start();
+    }
+    // The rows of the queued images have changed
+    enqueueImagesWithoutThumbnail();
+}
+
+void GalleryImageModel::onImagesModified(const QList<ImagePtr> &images) {
+    for (const ImagePtr &image : images) {
+        thumbnailPixmaps.remove(image->imagePath());
+        resizedImagePaths.remove(image->imagePath());
+        int row = imagesCache.indexOf(image);
+        if (row >= 0) {
+            Q_EMIT dataChanged(index(row, 0), index(row, 0));
+        }
+    }
+    m_updateTimer.start();
+    enqueueImagesWithoutThumbnail();
+}
@@ -4,13 +4,17 @@
 #include "model/modelmanager.hpp"
 #include "loadingiconmodel.hpp"
 #include "resizeimagesrunnable.hpp"
+#include "resizeimagesqueue.hpp"
+#include "thumbnailcache.hpp"
+#include "pixmapcache.hpp"
 
 #include <QAbstractListModel>
 #include <QImage>
+#include <QThread>
 #include <QThreadPool>
-#include <QPointer>
 #include <QMovie>
 #include <QIcon>
+#include <QSet>
 
 /*!
  * \brief The GalleryImageModel class provides the image data for a listview that is supposed to
@@ -31,20 +35,49 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
     int rowCount(const QModelIndex &) const;
 
+    //! The memory in bytes the displayed thumbnails may take up
+    void setThumbnailCacheSize(qint64 bytes);
+
+public Q_SLOTS:
+    /*!
+     * \brief setVisibleRows sets the rows that are currently visible in the gallery, the
+     * thumbnails of them and the rows around them are created first.
+     */
+    void setVisibleRows(int firstRow, int lastRow);
+
 private Q_SLOTS:
-    void onImageResized(int imageIndex, const QString &imagePath, const QImage &resizedImage);
+    void onImageResized(int generation, int row, const QString &imagePath, const QImage &resizedImage);
     void onDataChanged(int data);
+    //! Inserts and removes only the rows of the changed images, the other thumbnails are kept
+    void onImagesAddedOrRemoved();
+    void onImagesModified(const QList<ImagePtr> &images);
 
 private:
     void threadedResizeImages();
     void resizeImages();
+    //! Queues all images without thumbnail, needed whenever the rows of the images change
+    void enqueueImagesWithoutThumbnail();
+    //! Creates the thumbnail of the row again after it has been evicted
+    void requestThumbnail(int row);
+    void startResizeImagesRunnables(int count);
+    bool isNearVisibleRows(int row) const;
 
 private:
     ModelManager *modelManager;
     QList<ImagePtr> imagesCache;
-    QPointer<ResizeImagesRunnable> resizeImagesRunnable;
     QThreadPool resizeImagesThreadpool;
-    QMap<QString, QImage> resizedImagesCache;
+    //! One worker per hardware thread
+    ResizeImagesQueue resizeImagesQueue{QThread::idealThreadCount()};
+    //! Bounded, i.e. only the thumbnails that have been displayed recently are kept in memory
+    mutable PixmapCache thumbnailPixmaps;
+    //! The images whose thumbnails have been created, they might have been evicted since
+    QSet<QString> resizedImagePaths;
+    //! Evicted thumbnails that are being created again
+    QSet<QString> requestedImagePaths;
+    int firstVisibleRow = -1;
+    int lastVisibleRow = -1;
+    //! Persists the thumbnails across sessions, shared by the runnables
+    ThumbnailCache thumbnailCache;
     bool abortResize = false;
 };
 
@@ -1,53 +1,193 @@
 #include "galleryobjectmodelmodel.hpp"
 #include "misc/generalhelper.hpp"
+#include "view/rendering/meshloader.hpp"
 #include <QIcon>
 #include <QPainter>
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QMessageBox>
 #include <QCheckBox>
 #include <QSharedPointer>
 #include <QList>
 #include <QThread>
 #include <QApplication>
+#include <QtConcurrent/QtConcurrent>
+
+//! Object models are far fewer than images, i.e. usually all renderings fit
+static const qint64 DEFAULT_RENDERINGS_CACHE_SIZE = 128 * 1024 * 1024;
+//! Every engine has its own render thread and GL context, more don't pay off
+static const int MAX_OFFSCREEN_ENGINES = 4;
+//! Stored next to the pack file of the image thumbnails
+static const QString RENDERINGS_FILE_NAME = "renderings.pack";
 
 GalleryObjectModelModel::GalleryObjectModelModel(ModelManager* modelManager)
-    : modelManager(modelManager) {
+    : modelManager(modelManager)
+    , m_renderedObjectsModels(DEFAULT_RENDERINGS_CACHE_SIZE) {
     Q_ASSERT(modelManager != Q_NULLPTR);
+    // Appending locks the pack file anyway
+    m_renderingsCacheThreadPool.setMaxThreadCount(1);
+    int numberOfOffscreenEngines = qBound(1, QThread::idealThreadCount() / 2, MAX_OFFSCREEN_ENGINES);
+    for (int i = 0; i < numberOfOffscreenEngines; i++) {
+        OffscreenEngine *offscreenEngine = new OffscreenEngine(QSize(300, 300));
+        connect(offscreenEngine, &OffscreenEngine::imageReady,
+                this, [this, offscreenEngine](const QImage &image) {
+            onObjectModelRendered(offscreenEngine, image);
+        });
+        m_offscreenEngines.append(offscreenEngine);
+    }
+    if (!m_renderingsCache.open(ThumbnailCache::defaultPath(RENDERINGS_FILE_NAME))) {
+        qWarning() << "Could not open the object model renderings cache, object models will be "
+                      "rendered again on every start.";
+    }
     m_objectModels = modelManager->objectModels();
-    renderObjectModels();
     m_images = modelManager->images();
     // Create default index mapping
     createIndexMapping();
+    renderObjectModels();
     connect(modelManager, &ModelManager::dataChanged,
             this, &GalleryObjectModelModel::onDataChanged);
-    connect(&m_offscreenEngine, &OffscreenEngine::imageReady, this, &GalleryObjectModelModel::onObjectModelRendered);
+    connect(modelManager, &ModelManager::objectModelsAdded,
+            this, &GalleryObjectModelModel::onObjectModelsAdded);
+    connect(modelManager, &ModelManager::objectModelsRemoved,
+            this, &GalleryObjectModelModel::onObjectModelsRemoved);
+    connect(modelManager, &ModelManager::objectModelsModified,
+            this, &GalleryObjectModelModel::onObjectModelsModified);
+    connect(modelManager, &ModelManager::imagesAdded,
+            this, &GalleryObjectModelModel::onImagesAddedOrRemoved);
+    connect(modelManager, &ModelManager::imagesRemoved,
+            this, &GalleryObjectModelModel::onImagesAddedOrRemoved);
 }
 
 GalleryObjectModelModel::~GalleryObjectModelModel() {
+    m_renderingsCacheThreadPool.waitForDone();
+    qDeleteAll(m_offscreenEngines);
 }
 
 QVariant GalleryObjectModelModel::dataForObjectModel(const ObjectModel& objectModel, int role) const {
     if (role == Qt::ToolTipRole) {
         return objectModel.path();
     } else if (role == Qt::DecorationRole) {
-        if (m_renderedObjectsModels.contains(objectModel.path())) {
-            return QIcon(QPixmap::fromImage(m_renderedObjectsModels.value(objectModel.path())));
-        } else {
-            return currentLoadingAnimationFrame;
+        QPixmap rendering;
+        if (m_renderedObjectsModels.find(objectModel.path(), rendering)) {
+            return QIcon(rendering);
         }
+        if (m_renderedObjectModelPaths.contains(objectModel.path())) {
+            const_cast<GalleryObjectModelModel*>(this)->requestRendering(objectModel.path());
+        }
+        return currentLoadingAnimationFrame;
     }
 
     return QVariant();
 }
 
 void GalleryObjectModelModel::renderObjectModels() {
-    if (m_objectModels.count() > 0) {
-        m_renderedObjectsModels.clear();
-        m_currentlyRenderedImageIndex = 0;
-        m_renderingObjectModels = true;
-        m_offscreenEngine.setObjectModel(*m_objectModels[0]);
-        m_offscreenEngine.requestImage();
+    m_renderedObjectsModels.clear();
+    m_renderedObjectModelPaths.clear();
+    m_objectModelsToRender.clear();
+    m_requestedObjectModels.clear();
+    queueObjectModelsForRendering(m_objectModels);
+}
+
+void GalleryObjectModelModel::queueObjectModelsForRendering(const QList<ObjectModelPtr> &objectModels) {
+    QByteArray variant = renderingVariant();
+    bool anyInRenderingsCache = false;
+    for (const ObjectModelPtr &objectModel : objectModels) {
+        // Only object models that changed since they have been rendered the last time miss, the
+        // renderings are decoded once their rows are displayed
+        if (m_renderingsCache.contains(QFileInfo(objectModel->absolutePath()), variant)) {
+            m_renderedObjectModelPaths.insert(objectModel->path());
+            m_objectModelsToRender.removeAll(objectModel);
+            anyInRenderingsCache = true;
+        } else if (!m_objectModelsToRender.contains(objectModel)) {
+            m_objectModelsToRender.append(objectModel);
+        }
     }
+    int rows = rowCount(QModelIndex());
+    if (anyInRenderingsCache && rows > 0) {
+        Q_EMIT dataChanged(index(0, 0), index(rows - 1, 0));
+    }
+    // Busy engines take the queued object models when they are done
+    renderNextObjectModels();
+}
+
+void GalleryObjectModelModel::requestRendering(const QString &objectModelPath) {
+    // Only once, the rendering is pending until it is back in the cache
+    m_renderedObjectModelPaths.remove(objectModelPath);
+    for (const ObjectModelPtr &objectModel : m_objectModels) {
+        if (objectModel->path() == objectModelPath) {
+            if (m_requestedObjectModels.isEmpty()) {
+                // Restoring decodes the rendering and emits dataChanged, neither belongs into data()
+                QMetaObject::invokeMethod(this, [this]() {
+                    restoreRequestedRenderings();
+                }, Qt::QueuedConnection);
+            }
+            m_requestedObjectModels.append(objectModel);
+            return;
+        }
+    }
+}
+
+void GalleryObjectModelModel::restoreRequestedRenderings() {
+    QByteArray variant = renderingVariant();
+    bool anyToRender = false;
+    for (const ObjectModelPtr &objectModel : m_requestedObjectModels) {
+        // Might have been removed in the meantime
+        if (!m_objectModels.contains(objectModel)) {
+            continue;
+        }
+        QImage rendering;
+        if (m_renderingsCache.lookup(QFileInfo(objectModel->absolutePath()), variant, rendering)) {
+            m_renderedObjectsModels.insert(objectModel->path(), QPixmap::fromImage(rendering));
+            m_renderedObjectModelPaths.insert(objectModel->path());
+            QModelIndex objectModelIndex = indexOfObjectModel(*objectModel);
+            if (objectModelIndex.isValid()) {
+                Q_EMIT dataChanged(objectModelIndex, objectModelIndex);
+            }
+        } else if (!m_objectModelsToRender.contains(objectModel)) {
+            // Evicted from the pack file or changed since it has been checked
+            m_objectModelsToRender.append(objectModel);
+            anyToRender = true;
+        }
+    }
+    m_requestedObjectModels.clear();
+    if (anyToRender) {
+        m_updateTimer.start();
+        renderNextObjectModels();
+    }
+}
+
+QByteArray GalleryObjectModelModel::renderingVariant() const {
+    QSize size = m_offscreenEngines.first()->size();
+    QColor backgroundColor = m_offscreenEngines.first()->backgroundColor();
+    return QString("%1x%2 %3").arg(size.width()).arg(size.height())
+            .arg(backgroundColor.name(QColor::HexArgb)).toUtf8();
+}
+
+void GalleryObjectModelModel::setRenderingsCacheSize(qint64 bytes) {
+    m_renderedObjectsModels.setMaxBytes(bytes);
+}
+
+void GalleryObjectModelModel::renderNextObjectModels() {
+    for (OffscreenEngine *offscreenEngine : m_offscreenEngines) {
+        if (!m_currentlyRenderedObjectModels.contains(offscreenEngine)) {
+            renderNextObjectModel(offscreenEngine);
+        }
+    }
+}
+
+void GalleryObjectModelModel::renderNextObjectModel(OffscreenEngine *offscreenEngine) {
+    if (m_objectModelsToRender.isEmpty()) {
+        m_currentlyRenderedObjectModels.remove(offscreenEngine);
+        if (m_currentlyRenderedObjectModels.isEmpty()) {
+            m_updateTimer.stop();
+        }
+        return;
+    }
+    ObjectModelPtr objectModel = m_objectModelsToRender.takeFirst();
+    m_currentlyRenderedObjectModels[offscreenEngine] = objectModel;
+    offscreenEngine->setObjectModel(*objectModel);
+    offscreenEngine->requestImage();
 }
 
 //! Implementations of QAbstractListModel
@@ -118,12 +258,14 @@ void GalleryObjectModelModel::setSegmentationCodesForObjectModels(QMap<QString,
 }
 
 void GalleryObjectModelModel::setPreviewRenderingSize(QSize size) {
-    m_offscreenEngine.setSize(size);
+    for (OffscreenEngine *offscreenEngine : m_offscreenEngines) {
+        offscreenEngine->setSize(size);
+    }
     renderObjectModels();
 }
 
 QSize GalleryObjectModelModel::previewRenderingSize() {
-    return m_offscreenEngine.size();
+    return m_offscreenEngines.first()->size();
 }
 
 QModelIndex GalleryObjectModelModel::indexOfObjectModel(const ObjectModel &objectModel) {
@@ -172,13 +314,60 @@ void GalleryObjectModelModel::onDataChanged(int data) {
         if (modelManager) {
             // When the object models change we need to re-render them
             m_objectModels = modelManager->objectModels();
+            // Rendering emits dataChanged for the rows, which need to map to the new object models
+            createIndexMapping();
             renderObjectModels();
             m_updateTimer.start();
         } else {
             m_objectModels.clear();
-            m_indexMapping.clear();
+            createIndexMapping();
         }
+    }
+}
+
+void GalleryObjectModelModel::onObjectModelsAdded(const QList<ObjectModelPtr> &objectModels) {
+    beginResetModel();
+    m_objectModels = modelManager->objectModels();
+    createIndexMapping();
+    endResetModel();
+    m_updateTimer.start();
+    queueObjectModelsForRendering(objectModels);
+}
+
+void GalleryObjectModelModel::onObjectModelsRemoved(const QList<ObjectModelPtr> &objectModels) {
+    beginResetModel();
+    m_objectModels = modelManager->objectModels();
+    for (const ObjectModelPtr &objectModel : objectModels) {
+        m_renderedObjectsModels.remove(objectModel->path());
+        m_renderedObjectModelPaths.remove(objectModel->path());
+        m_objectModelsToRender.removeAll(objectModel);
+    }
+    createIndexMapping();
+    endResetModel();
+}
+
+void GalleryObjectModelModel::onObjectModelsModified(const QList<ObjectModelPtr> &objectModels) {
+    for (const ObjectModelPtr &objectModel : objectModels) {
+        m_renderedObjectsModels.remove(objectModel->path());
+        m_renderedObjectModelPaths.remove(objectModel->path());
+    }
+    m_updateTimer.start();
+    queueObjectModelsForRendering(objectModels);
+}
+
+void GalleryObjectModelModel::onImagesAddedOrRemoved() {
+    // Keep the selected image instead of deselecting it like on a full reload
+    ImagePtr selectedImage;
+    if (m_currentSelectedImageIndex != -1) {
+        selectedImage = m_images.at(m_currentSelectedImageIndex);
+    }
+    m_images = modelManager->images();
+    m_currentSelectedImageIndex = selectedImage.isNull() ? -1 : m_images.indexOf(selectedImage);
+    if (m_currentSelectedImageIndex == -1) {
+        beginResetModel();
+        m_colorsOfCurrentImage.clear();
         createIndexMapping();
+        endResetModel();
     }
 }
 
@@ -234,17 +423,25 @@ void GalleryObjectModelModel::createIndexMapping() {
     }
 }
 
-void GalleryObjectModelModel::onObjectModelRendered(QImage image) {
-    QString objectModel = m_objectModels[m_currentlyRenderedImageIndex]->path();
+void GalleryObjectModelModel::onObjectModelRendered(OffscreenEngine *offscreenEngine, const QImage &image) {
+    ObjectModelPtr renderedObjectModel = m_currentlyRenderedObjectModels.value(offscreenEngine);
+    if (renderedObjectModel.isNull()) {
+        return;
+    }
+    QString objectModel = renderedObjectModel->path();
     qDebug() << "Preview rendering finished for " + objectModel;
-    m_renderedObjectsModels.insert(objectModel, image);
-    m_currentlyRenderedImageIndex++;
-    if (m_currentlyRenderedImageIndex < m_objectModels.size()) {
-        m_offscreenEngine.setObjectModel(*m_objectModels[m_currentlyRenderedImageIndex]);
-        m_offscreenEngine.requestImage();
-    } else {
-        m_currentlyRenderedImageIndex = 0;
-        m_renderingObjectModels = false;
-        m_updateTimer.stop();
+    // The object model might have been removed in the meantime, a null image means that the
+    // object model could not be loaded
+    if (m_objectModels.contains(renderedObjectModel) && !image.isNull()) {
+        m_renderedObjectsModels.insert(objectModel, QPixmap::fromImage(image));
+        m_renderedObjectModelPaths.insert(objectModel);
+        // Parsing the material libraries and encoding the rendering don't belong on the GUI thread
+        QString absolutePath = renderedObjectModel->absolutePath();
+        QByteArray variant = renderingVariant();
+        QtConcurrent::run(&m_renderingsCacheThreadPool, [this, absolutePath, variant, image]() {
+            m_renderingsCache.insert(QFileInfo(absolutePath), variant, image,
+                                     MeshLoader::referencedFiles(absolutePath));
+        });
     }
+    renderNextObjectModel(offscreenEngine);
 }
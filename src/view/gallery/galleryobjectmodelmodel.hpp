@@ -4,12 +4,17 @@
 #include "loadingiconmodel.hpp"
 #include "model/modelmanager.hpp"
 #include "view/gallery/rendering/offscreenengine.hpp"
+#include "view/gallery/pixmapcache.hpp"
+#include "view/gallery/thumbnailcache.hpp"
 
 #include <QAbstractListModel>
 #include <QColor>
+#include <QHash>
 #include <QMap>
 #include <QList>
 #include <QSize>
+#include <QSet>
+#include <QThreadPool>
 
 /*!
  * \brief The GalleryObjectModelModel class provides object model images to the Gallery.
@@ -31,6 +36,8 @@ public:
     void setPreviewRenderingSize(QSize size);
     QSize previewRenderingSize();
     QModelIndex indexOfObjectModel(const ObjectModel &objectModel);
+    //! The memory in bytes the displayed renderings may take up
+    void setRenderingsCacheSize(qint64 bytes);
 
 public Q_SLOTS:
     /*!
@@ -51,18 +58,50 @@ Q_SIGNALS:
 private Q_SLOTS:
     bool isNumberOfToolsCorrect() const;
     void onDataChanged(int data);
-    void onObjectModelRendered(QImage image);
+    //! The following slots only re-render the object models that actually changed
+    void onObjectModelsAdded(const QList<ObjectModelPtr> &objectModels);
+    void onObjectModelsRemoved(const QList<ObjectModelPtr> &objectModels);
+    void onObjectModelsModified(const QList<ObjectModelPtr> &objectModels);
+    void onImagesAddedOrRemoved();
+    void onObjectModelRendered(OffscreenEngine *offscreenEngine, const QImage &image);
 
 private:
     QVariant dataForObjectModel(const ObjectModel& objectModel, int role) const;
     void renderObjectModels();
+    //! Starts rendering the next queued object model on every idle offscreen engine
+    void renderNextObjectModels();
+    void renderNextObjectModel(OffscreenEngine *offscreenEngine);
+    void queueObjectModelsForRendering(const QList<ObjectModelPtr> &objectModels);
+    /*!
+     * \brief requestRendering restores the rendering of the object model from the pack file or
+     * renders it again after it has been evicted. Called from data(), which is why the rendering is
+     * only queued and restored once control returns to the event loop.
+     */
+    void requestRendering(const QString &objectModelPath);
+    //! Decodes the renderings of the requested, i.e. displayed, object models only
+    void restoreRequestedRenderings();
+    /*!
+     * \brief renderingVariant identifies the rendering in the renderings pack file by the
+     * parameters it is rendered with. The material libraries and textures the object model
+     * references are stored with the rendering instead, which keeps this cheap.
+     */
+    QByteArray renderingVariant() const;
     void createIndexMapping();
 
 private:
     ModelManager* modelManager;
     QList<ObjectModelPtr> m_objectModels;
-    QMap<QString,QImage> m_renderedObjectsModels;
-    OffscreenEngine m_offscreenEngine{QSize(300, 300)};
+    //! Bounded, evicted renderings are rendered again when they are displayed
+    mutable PixmapCache m_renderedObjectsModels;
+    //! The object models that have an up-to-date rendering, either in m_renderedObjectsModels or
+    //! only in the pack file, i.e. it has not been decoded yet or has been evicted since
+    QSet<QString> m_renderedObjectModelPaths;
+    //! Persists the renderings across sessions, i.e. only changed object models are rendered again
+    ThumbnailCache m_renderingsCache;
+    //! Collects the referenced files and appends the renderings to the pack file
+    QThreadPool m_renderingsCacheThreadPool;
+    //! Object models load independently of each other, i.e. several engines render concurrently
+    QList<OffscreenEngine*> m_offscreenEngines;
     QList<ImagePtr> m_images;
     // Color codes
     QMap<QString, QString> m_codes;
@@ -71,10 +110,12 @@ private:
     QMap<int, int> m_indexMapping;
     QList<QColor> m_colorsOfCurrentImage;
     int m_currentSelectedImageIndex = -1;
-    //! Store the index of the currently rendered image to be able to set the correct image
-    //! when the renderer returns
-    int m_currentlyRenderedImageIndex = 0;
-    bool m_renderingObjectModels = false;
+    //! Store the object model each engine currently renders to be able to set the correct image
+    //! when the engine returns, idle engines are not contained
+    QHash<OffscreenEngine*, ObjectModelPtr> m_currentlyRenderedObjectModels;
+    QList<ObjectModelPtr> m_objectModelsToRender;
+    //! Requested from data(), restored or rendered once control returns to the event loop
+    QList<ObjectModelPtr> m_requestedObjectModels;
 };
 
 #endif // GALLERYOBJECTMODELMODEL_H
@@ -8,6 +8,34 @@ void IconExpandingListView::paintEvent(QPaintEvent * event) {
     QRect rect = event->rect();
     this->setIconSize(QSize(rect.height(), rect.height()));
     QListView::paintEvent(event);
+    // Every scroll step and resize results in a paint event
+    updateVisibleRows();
+}
+
+void IconExpandingListView::updateVisibleRows() {
+    int firstRow = -1;
+    int lastRow = -1;
+    if (model() && model()->rowCount() > 0) {
+        QRect rect = viewport()->rect();
+        // The point might lie in the spacing between two items
+        QModelIndex first;
+        for (int x = rect.left(); x < rect.right() && !first.isValid(); x += spacing() + 1) {
+            first = indexAt(QPoint(x, rect.center().y()));
+        }
+        if (first.isValid()) {
+            firstRow = first.row();
+            lastRow = firstRow;
+            while (lastRow + 1 < model()->rowCount()
+                   && visualRect(model()->index(lastRow + 1, 0)).left() <= rect.right()) {
+                lastRow++;
+            }
+        }
+    }
+    if (firstRow != m_firstVisibleRow || lastRow != m_lastVisibleRow) {
+        m_firstVisibleRow = firstRow;
+        m_lastVisibleRow = lastRow;
+        Q_EMIT visibleRowsChanged(firstRow, lastRow);
+    }
 }
 
 void IconExpandingListView::selectNext() {
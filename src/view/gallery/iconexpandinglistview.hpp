@@ -10,6 +10,7 @@
  */
 class IconExpandingListView : public QListView
 {
+    Q_OBJECT
 
 public:
     explicit IconExpandingListView(QWidget *parent = Q_NULLPTR);
@@ -17,8 +18,17 @@ public:
     void selectNext();
     void selectPrevious();
 
+Q_SIGNALS:
+    //! Emitted when the range of rows whose items are (partially) visible changes, e.g. when scrolling
+    void visibleRowsChanged(int firstRow, int lastRow);
+
 private:
     void select(int offset);
+    void updateVisibleRows();
+
+private:
+    int m_firstVisibleRow = -1;
+    int m_lastVisibleRow = -1;
 };
 
 #endif // ICONEXPANDINGLISTVIEW_H
@@ -0,0 +1,62 @@
+#include "pixmapcache.hpp"
+
+#include <limits>
+
+static int kibibytes(qint64 bytes) {
+    return (int) qMin<qint64>((bytes + 1023) / 1024, std::numeric_limits<int>::max());
+}
+
+PixmapCache::PixmapCache(qint64 maxBytes) {
+    setMaxBytes(maxBytes);
+}
+
+bool PixmapCache::find(const QString &key, QPixmap &pixmap) {
+    QPixmap *cachedPixmap = m_cache.object(key);
+    if (!cachedPixmap) {
+        m_misses++;
+        return false;
+    }
+    m_hits++;
+    pixmap = *cachedPixmap;
+    return true;
+}
+
+bool PixmapCache::contains(const QString &key) const {
+    return m_cache.contains(key);
+}
+
+void PixmapCache::insert(const QString &key, const QPixmap &pixmap) {
+    m_cache.insert(key, new QPixmap(pixmap), costOf(pixmap));
+}
+
+void PixmapCache::remove(const QString &key) {
+    m_cache.remove(key);
+}
+
+void PixmapCache::clear() {
+    m_cache.clear();
+}
+
+qint64 PixmapCache::bytes() const {
+    return qint64(m_cache.totalCost()) * 1024;
+}
+
+qint64 PixmapCache::maxBytes() const {
+    return qint64(m_cache.maxCost()) * 1024;
+}
+
+void PixmapCache::setMaxBytes(qint64 maxBytes) {
+    m_cache.setMaxCost(kibibytes(maxBytes));
+}
+
+quint64 PixmapCache::hits() const {
+    return m_hits;
+}
+
+quint64 PixmapCache::misses() const {
+    return m_misses;
+}
+
+int PixmapCache::costOf(const QPixmap &pixmap) {
+    return qMax(1, kibibytes(qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8));
+}
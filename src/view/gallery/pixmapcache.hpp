@@ -0,0 +1,57 @@
+#ifndef PIXMAPCACHE_H
+#define PIXMAPCACHE_H
+
+#include <QCache>
+#include <QPixmap>
+#include <QString>
+
+/*!
+ * \brief The PixmapCache class holds the pixmaps that the galleries display, i.e. the conversion of
+ * the images to pixmaps happens only once and not on every repaint. The cache is limited to a
+ * number of bytes and evicts the least recently used pixmaps when exceeding it. It counts hits and
+ * misses to be able to judge whether the limit fits the dataset.
+ */
+class PixmapCache {
+
+public:
+    explicit PixmapCache(qint64 maxBytes);
+
+    /*!
+     * \brief find looks up the pixmap for the given key and marks it as most recently used.
+     * \return true if the pixmap is cached, counted as hit or miss
+     */
+    bool find(const QString &key, QPixmap &pixmap);
+
+    //! Doesn't count as hit or miss and doesn't change the order of eviction
+    bool contains(const QString &key) const;
+
+    /*!
+     * \brief insert stores the pixmap and evicts the least recently used pixmaps if
+     * the cache exceeds its limit afterwards.
+     */
+    void insert(const QString &key, const QPixmap &pixmap);
+
+    void remove(const QString &key);
+
+    void clear();
+
+    //! The bytes the cached pixmaps take up
+    qint64 bytes() const;
+
+    qint64 maxBytes() const;
+    void setMaxBytes(qint64 maxBytes);
+
+    quint64 hits() const;
+    quint64 misses() const;
+
+private:
+    static int costOf(const QPixmap &pixmap);
+
+private:
+    //! The costs are in KiB because QCache counts them in int
+    QCache<QString, QPixmap> m_cache;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+};
+
+#endif // PIXMAPCACHE_H
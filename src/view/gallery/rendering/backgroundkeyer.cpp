@@ -0,0 +1,13 @@
+#include "backgroundkeyer.hpp"
+
+void BackgroundKeyer::keyBackground(QImage &image, QRgb background) {
+    Q_ASSERT(image.format() == QImage::Format_ARGB32);
+    const int width = image.width();
+    for (int y = 0; y < image.height(); y++) {
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        // Branchless on purpose, this way the compiler vectorizes the loop
+        for (int x = 0; x < width; x++) {
+            line[x] = line[x] == background ? 0 : line[x];
+        }
+    }
+}
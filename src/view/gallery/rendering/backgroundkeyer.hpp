@@ -0,0 +1,21 @@
+#ifndef BACKGROUNDKEYER_H
+#define BACKGROUNDKEYER_H
+
+#include <QImage>
+#include <QRgb>
+
+/*!
+ * \brief The BackgroundKeyer class makes the background of the captures of the OffscreenEngine
+ * transparent, i.e. the object model previews blend with the gallery.
+ */
+class BackgroundKeyer {
+
+public:
+    /*!
+     * \brief keyBackground makes all pixels of the given color transparent.
+     * \param image has to be of format ARGB32
+     */
+    static void keyBackground(QImage &image, QRgb background);
+};
+
+#endif // BACKGROUNDKEYER_H
@@ -1,4 +1,5 @@
 #include "offscreenengine.hpp"
+#include "view/gallery/rendering/backgroundkeyer.hpp"
 #include <Qt3DExtras/QPhongMaterial>
 #include <Qt3DCore/QTransform>
 
@@ -85,34 +86,46 @@ OffscreenEngine::~OffscreenEngine() {
 }
 
 void OffscreenEngine::setObjectModel(const ObjectModel &objectModel) {
+    // The status of the mesh cache is only Loaded as long as the file hasn't changed since the
+    // mesh has been loaded, a modified file is loaded again
+    if (objectModel.absolutePath() == objectModelPath
+            && objectModelRenderable->status() == Qt3DRender::QSceneLoader::Ready
+            && MeshCache::instance()->status(objectModelPath) == MeshCache::Loaded) {
+        return;
+    }
+    objectModelPath = objectModel.absolutePath();
+    loadingObjectModel = true;
+    objectModelFailed = false;
     objectModelRenderable->setObjectModel(objectModel);
 }
 
-void OffscreenEngine::onSceneLoaderStatusChanged(Qt3DRender::QSceneLoader::Status) {
-    camera->viewAll();
+void OffscreenEngine::onSceneLoaderStatusChanged(Qt3DRender::QSceneLoader::Status status) {
+    if (status == Qt3DRender::QSceneLoader::Ready) {
+        camera->viewAll();
+        loadingObjectModel = false;
+        // Capturing before the object model is loaded results in an image without the object,
+        // which is why the image used to be captured twice
+        if (imageRequested) {
+            capture();
+        }
+    } else if (status == Qt3DRender::QSceneLoader::Error) {
+        loadingObjectModel = false;
+        objectModelFailed = true;
+        if (imageRequested) {
+            // Nothing to capture, but the requester still waits for an image
+            imageRequested = false;
+            Q_EMIT imageReady(QImage());
+        }
+    }
 }
 
 void OffscreenEngine::onRenderCaptureReady() {
-    if (!initialized) {
-        // First image captured is always without the object somehow, i.e. we need to render again
-        initialized = true;
-        delete reply;
-        requestImage();
-    } else {
-        initialized = false;
-        QImage image = reply->image();
-        delete reply;
-        image.convertTo(QImage::Format_ARGB32);
-        // Not very performant
-        for(int x = 0; x < image.width(); x++) {
-            for(int y = 0; y < image.height(); y++) {
-                if (image.pixel(x, y) == qRgba(255, 255, 255, 255)) {
-                    image.setPixel(x,y,qRgba(0, 0, 0, 0));
-                }
-            }
-        }
-        Q_EMIT imageReady(image);
-    }
+    imageRequested = false;
+    QImage image = reply->image();
+    delete reply;
+    image.convertTo(QImage::Format_ARGB32);
+    BackgroundKeyer::keyBackground(image, backgroundColor().rgba());
+    Q_EMIT imageReady(image);
 }
 
 void OffscreenEngine::shutdown() {
@@ -140,7 +153,26 @@ void OffscreenEngine::setBackgroundColor(QColor color) {
     clearBuffers->setClearColor(color);
 }
 
+QColor OffscreenEngine::backgroundColor() const {
+    return clearBuffers->clearColor();
+}
+
 void OffscreenEngine::requestImage() {
+    if (objectModelFailed) {
+        // Capturing would result in an image of the empty scene, queued to not render the next
+        // object model from within the request
+        QMetaObject::invokeMethod(this, [this]() {
+            Q_EMIT imageReady(QImage());
+        }, Qt::QueuedConnection);
+        return;
+    }
+    imageRequested = true;
+    if (!loadingObjectModel) {
+        capture();
+    }
+}
+
+void OffscreenEngine::capture() {
     reply = renderCapture->requestCapture();
     connect(reply, &Qt3DRender::QRenderCaptureReply::completed, this, &OffscreenEngine::onRenderCaptureReady);
 }
@@ -4,6 +4,7 @@
 #include "view/gallery/rendering/texturerendertarget.hpp"
 #include "model/objectmodel.hpp"
 #include "view/rendering/objectmodelrenderable.hpp"
+#include "view/rendering/meshcache.hpp"
 
 #include <QObject>
 
@@ -43,8 +44,10 @@ public:
     OffscreenEngine(const QSize &size);
     ~OffscreenEngine();
 
+    //! The object model is loaded asynchronously, a requested image is captured once it is loaded
     void setObjectModel(const ObjectModel &objectModel);
     void setBackgroundColor(QColor color);
+    QColor backgroundColor() const;
     void setSize(const QSize &size);
     QSize size();
 
@@ -60,6 +63,9 @@ private Q_SLOTS:
     void onRenderCaptureReady();
     void shutdown();
 
+private:
+    void capture();
+
 private:
     // We need all of the following in order to render a scene:
     Qt3DCore::QAspectEngine *aspectEngine;              // The aspect engine, which holds the scene and related aspects.
@@ -86,7 +92,12 @@ private:
     ObjectModelRenderable *objectModelRenderable;
     Qt3DRender::QPointLight *light;
 
-    bool initialized = false;
+    QString objectModelPath;
+    //! Set from setting an object model until it has been loaded
+    bool loadingObjectModel = false;
+    //! Set if the object model couldn't be loaded, no image is captured then
+    bool objectModelFailed = false;
+    bool imageRequested = false;
 };
 
 #endif // OFFSCREENENGINE_H
@@ -0,0 +1,91 @@
+#include "resizeimagesqueue.hpp"
+
+#include <QMutexLocker>
+
+#include <algorithm>
+
+namespace {
+
+// The entry with the lowest priority value has to be at the top of the heap
+template<typename Entry>
+bool hasLowerPriority(const Entry &e1, const Entry &e2) {
+    return e1.priority > e2.priority;
+}
+
+}
+
+ResizeImagesQueue::ResizeImagesQueue(int maxWorkers)
+    : m_maxWorkers(qMax(1, maxWorkers)) {
+}
+
+int ResizeImagesQueue::enqueue(const QVector<QPair<int, Image>> &imagesForRows) {
+    QMutexLocker locker(&m_mutex);
+    for (const QPair<int, Image> &imageForRow : imagesForRows) {
+        m_entries.append({imageForRow.first, priorityForRow(imageForRow.first),
+                          m_generation, imageForRow.second});
+        std::push_heap(m_entries.begin(), m_entries.end(), hasLowerPriority<Entry>);
+    }
+    int workersToStart = qMin(m_maxWorkers - m_activeWorkers, m_entries.size());
+    m_activeWorkers += workersToStart;
+    return workersToStart;
+}
+
+bool ResizeImagesQueue::take(Image &image, int &row, int &generation) {
+    QMutexLocker locker(&m_mutex);
+    if (m_entries.isEmpty()) {
+        // Decremented while locked, i.e. images enqueued from now on start a new worker
+        m_activeWorkers--;
+        return false;
+    }
+    std::pop_heap(m_entries.begin(), m_entries.end(), hasLowerPriority<Entry>);
+    image = m_entries.last().image;
+    row = m_entries.last().row;
+    generation = m_entries.last().generation;
+    m_entries.removeLast();
+    return true;
+}
+
+void ResizeImagesQueue::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+}
+
+void ResizeImagesQueue::invalidate() {
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_generation++;
+}
+
+int ResizeImagesQueue::generation() {
+    QMutexLocker locker(&m_mutex);
+    return m_generation;
+}
+
+void ResizeImagesQueue::setVisibleRows(int firstRow, int lastRow) {
+    QMutexLocker locker(&m_mutex);
+    if (firstRow == m_firstVisibleRow && lastRow == m_lastVisibleRow) {
+        return;
+    }
+    m_firstVisibleRow = firstRow;
+    m_lastVisibleRow = lastRow;
+    // Rebuilding the heap is linear, i.e. cheap enough to be done on every scroll step
+    for (Entry &entry : m_entries) {
+        entry.priority = priorityForRow(entry.row);
+    }
+    std::make_heap(m_entries.begin(), m_entries.end(), hasLowerPriority<Entry>);
+}
+
+int ResizeImagesQueue::priorityForRow(int row) const {
+    if (m_firstVisibleRow < 0 || m_lastVisibleRow < m_firstVisibleRow) {
+        // Nothing visible yet, process the images in the order of the gallery
+        return row;
+    }
+    int visibleRows = m_lastVisibleRow - m_firstVisibleRow + 1;
+    if (row < m_firstVisibleRow) {
+        return visibleRows + 2 * (m_firstVisibleRow - row);
+    } else if (row > m_lastVisibleRow) {
+        // Slightly prefer the rows the user is scrolling towards usually
+        return visibleRows + 2 * (row - m_lastVisibleRow) - 1;
+    }
+    return row - m_firstVisibleRow;
+}
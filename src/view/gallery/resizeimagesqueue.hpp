@@ -0,0 +1,74 @@
+#ifndef RESIZEIMAGESQUEUE_H
+#define RESIZEIMAGESQUEUE_H
+
+#include "model/image.hpp"
+
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QVector>
+
+/*!
+ * \brief The ResizeImagesQueue class is the thread-safe priority queue of the images whose
+ * thumbnails still have to be created. The ResizeImagesRunnables take the images from it.
+ *
+ * The priority of an image depends on the distance of its row to the rows that are currently
+ * visible in the gallery, i.e. visible images come first, followed by the ones the user is about
+ * to scroll to. Changing the visible rows reorders the images that are still queued.
+ */
+class ResizeImagesQueue {
+
+public:
+    explicit ResizeImagesQueue(int maxWorkers);
+
+    /*!
+     * \brief enqueue adds the given images at the given rows of the gallery.
+     * \return the number of workers that have to be started additionally to process the images,
+     * they are counted as active from now on
+     */
+    int enqueue(const QVector<QPair<int, Image>> &imagesForRows);
+
+    /*!
+     * \brief take is called by the workers to get the next image to process.
+     * \param image is set to the image with the highest priority
+     * \param row is set to the row of the image in the gallery when it was enqueued
+     * \param generation is set to the generation of the queue when the image was enqueued
+     * \return false if the queue is empty, the calling worker is not counted as active anymore then
+     */
+    bool take(Image &image, int &row, int &generation);
+
+    //! Removes all queued images, images that are being processed are not affected
+    void clear();
+
+    /*!
+     * \brief invalidate removes all queued images and marks the images that are being processed
+     * as outdated, i.e. their generation differs from the current one.
+     */
+    void invalidate();
+
+    int generation();
+
+    void setVisibleRows(int firstRow, int lastRow);
+
+private:
+    struct Entry {
+        int row;
+        int priority;
+        int generation;
+        Image image;
+    };
+
+    int priorityForRow(int row) const;
+
+private:
+    QMutex m_mutex;
+    //! A min-heap regarding the priority
+    QVector<Entry> m_entries;
+    int m_maxWorkers;
+    int m_activeWorkers = 0;
+    int m_generation = 0;
+    int m_firstVisibleRow = -1;
+    int m_lastVisibleRow = -1;
+};
+
+#endif // RESIZEIMAGESQUEUE_H
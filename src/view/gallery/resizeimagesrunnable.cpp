@@ -1,32 +1,31 @@
 #include "resizeimagesrunnable.hpp"
+#include "thumbnaildecoder.hpp"
 
 #include <QUrl>
-#include <QImageReader>
-#include <QElapsedTimer>
+#include <QFileInfo>
 
-ResizeImagesRunnable::ResizeImagesRunnable(const QList<ImagePtr> &images) {
-    for (ImagePtr image: images) {
-        m_images.append(*image.get());
-    }
+//! No one is going to view images larger than 300 px height
+static const int THUMBNAIL_HEIGHT = 300;
+
+ResizeImagesRunnable::ResizeImagesRunnable(ResizeImagesQueue *queue, ThumbnailCache *thumbnailCache)
+    : m_queue(queue)
+    , m_thumbnailCache(thumbnailCache) {
 }
 
 void ResizeImagesRunnable::run() {
-    int i = 0;
-    for (Image &image : m_images) {
-        if (m_stopProcess) {
-            break;
+    Image image;
+    int row;
+    int generation;
+    while (m_queue->take(image, row, generation)) {
+        QString imagePath = QUrl::fromLocalFile(image.absoluteImagePath()).path();
+        QFileInfo imageFile(imagePath);
+        QImage thumbnail;
+        if (!m_thumbnailCache || !m_thumbnailCache->lookup(imageFile, THUMBNAIL_HEIGHT, thumbnail)) {
+            thumbnail = ThumbnailDecoder::decode(imagePath, THUMBNAIL_HEIGHT);
+            if (m_thumbnailCache) {
+                m_thumbnailCache->insert(imageFile, THUMBNAIL_HEIGHT, thumbnail);
+            }
         }
-        QElapsedTimer timer;
-        timer.start();
-        QImageReader imageReader(QUrl::fromLocalFile(image.absoluteImagePath()).path());
-        float aspectRatio = imageReader.size().width() / (float) imageReader.size().height();
-        // No one is going to view images larger than 300 px height
-        imageReader.setScaledSize(QSize(300 * aspectRatio, 300));
-        Q_EMIT imageResized(i, image.imagePath(), imageReader.read());
-        i++;
+        Q_EMIT imageResized(generation, row, image.imagePath(), thumbnail);
     }
 }
-
-void ResizeImagesRunnable::stop() {
-    m_stopProcess = true;
-}
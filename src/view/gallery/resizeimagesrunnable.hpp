@@ -2,29 +2,39 @@
 #define RESIZEIMAGESRUNNABLE_H
 
 #include "model/image.hpp"
+#include "resizeimagesqueue.hpp"
+#include "thumbnailcache.hpp"
 
 #include <QList>
 #include <QRunnable>
 #include <QObject>
 #include <QImage>
 
+/*!
+ * \brief The ResizeImagesRunnable class creates thumbnails of the images it takes from the
+ * queue until the queue is empty. Multiple runnables work on the same queue in parallel.
+ */
 class ResizeImagesRunnable : public QObject, public QRunnable {
 
     Q_OBJECT
 
 public:
-    ResizeImagesRunnable(const QList<ImagePtr> &images);
+    /*!
+     * \brief ResizeImagesRunnable constructor.
+     * \param queue the queue to take the images to create the thumbnails of from, the images
+     * are copies to not crash when the rest of the app shuts down
+     * \param thumbnailCache the cache to look up thumbnails in and to store created ones, can be null
+     */
+    ResizeImagesRunnable(ResizeImagesQueue *queue, ThumbnailCache *thumbnailCache = Q_NULLPTR);
     void run() override;
-    void stop();
 
 Q_SIGNALS:
-    void imageResized(int imageIndex, const QString &imagePath, const QImage &resizedImage);
+    //! The generation and row are the ones at the time the image was enqueued
+    void imageResized(int generation, int row, const QString &imagePath, const QImage &resizedImage);
 
 private:
-    // Not ImagePtr since the runnable runs asynchronously and should
-    // retrain its own list to not crash when the rest of the app shuts down
-    QList<Image> m_images;
-    bool m_stopProcess = false;
+    ResizeImagesQueue *m_queue;
+    ThumbnailCache *m_thumbnailCache;
 };
 
 #endif // RESIZEIMAGESRUNNABLE_H
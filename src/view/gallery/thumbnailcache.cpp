@@ -0,0 +1,400 @@
+#include "thumbnailcache.hpp"
+
+#include <cstring>
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+const QString ThumbnailCache::FILE_NAME = "thumbnails.pack";
+const int ThumbnailCache::COMPACTION_INTERVAL_DAYS = 7;
+
+//! "6DPT" in host byte order, i.e. a pack file of a different byte order doesn't match
+static const quint32 PACK_MAGIC = 0x54504436;
+static const quint32 PACK_VERSION = 3;
+//! The pack file is only compacted if it would shrink considerably
+static const qint64 MIN_OUTDATED_BYTES_TO_COMPACT = 64 * 1024 * 1024;
+static const QString LOCK_FILE_SUFFIX = ".lock";
+
+namespace {
+
+struct Header {
+    quint32 magic;
+    quint32 version;
+    //! Milliseconds since epoch
+    qint64 lastCompacted;
+};
+
+struct RecordHeader {
+    //! SHA-1 of the absolute image path and the variant, e.g. the thumbnail height
+    char key[20];
+    quint32 size;
+    //! The UTF-8 encoded absolute image path follows the header, then the referenced files
+    //! and finally the thumbnail
+    quint32 pathSize;
+    quint32 referencedFilesSize;
+    qint64 imageFileSize;
+    qint64 imageLastModified;
+};
+
+//! The UTF-8 encoded absolute path of the referenced file follows the header
+struct ReferencedFileHeader {
+    qint64 fileSize;
+    //! -1 if the file didn't exist
+    qint64 lastModified;
+    quint32 pathSize;
+    quint32 padding;
+};
+
+}
+
+Q_STATIC_ASSERT(sizeof(Header) == 16);
+Q_STATIC_ASSERT(sizeof(RecordHeader) == 48);
+Q_STATIC_ASSERT(sizeof(ReferencedFileHeader) == 24);
+
+//! Missing files are recorded as well, the thumbnail changes once they exist
+static qint64 lastModifiedOf(const QFileInfo &file) {
+    return file.exists() ? file.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+static QByteArray encodeReferencedFiles(const QStringList &referencedFiles) {
+    QByteArray encodedFiles;
+    for (const QString &referencedFile : referencedFiles) {
+        QFileInfo fileInfo(referencedFile);
+        QByteArray path = referencedFile.toUtf8();
+        ReferencedFileHeader header;
+        header.fileSize = fileInfo.size();
+        header.lastModified = lastModifiedOf(fileInfo);
+        header.pathSize = path.size();
+        header.padding = 0;
+        encodedFiles.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        encodedFiles.append(path);
+    }
+    return encodedFiles;
+}
+
+//! Stats the referenced files, i.e. must not be called with the mutex locked
+static bool referencedFilesUpToDate(const QByteArray &encodedFiles) {
+    int offset = 0;
+    while (offset + (int) sizeof(ReferencedFileHeader) <= encodedFiles.size()) {
+        ReferencedFileHeader header;
+        std::memcpy(&header, encodedFiles.constData() + offset, sizeof(header));
+        offset += sizeof(header);
+        if (header.pathSize > (quint32) (encodedFiles.size() - offset)) {
+            return false;
+        }
+        QFileInfo fileInfo(QString::fromUtf8(encodedFiles.constData() + offset, (int) header.pathSize));
+        offset += header.pathSize;
+        if (fileInfo.size() != header.fileSize || lastModifiedOf(fileInfo) != header.lastModified) {
+            return false;
+        }
+    }
+    return offset == encodedFiles.size();
+}
+
+ThumbnailCache::ThumbnailCache() {
+}
+
+ThumbnailCache::~ThumbnailCache() {
+    close();
+}
+
+QString ThumbnailCache::defaultPath(const QString &fileName) {
+    QString cacheLocation = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    QDir().mkpath(cacheLocation);
+    return QDir(cacheLocation).filePath(fileName);
+}
+
+bool ThumbnailCache::open(const QString &path) {
+    QMutexLocker locker(&m_mutex);
+    close();
+
+    m_lockFile.reset(new QLockFile(path + LOCK_FILE_SUFFIX));
+    //! The lock is held for the whole session, i.e. it must only be stale if its process is gone
+    m_lockFile->setStaleLockTime(0);
+    m_readOnly = !m_lockFile->tryLock(0);
+    if (m_readOnly) {
+        m_lockFile.reset();
+    }
+
+    m_file.setFileName(path);
+    if (!m_file.open(m_readOnly ? QFile::ReadOnly : QFile::ReadWrite)) {
+        close();
+        return false;
+    }
+    if (!readEntries()) {
+        if (m_readOnly) {
+            // The other process starts over, nothing to read for us
+            close();
+            return false;
+        }
+        // Not a pack file or of a different version, start over
+        unmap();
+        Header header = {PACK_MAGIC, PACK_VERSION, QDateTime::currentMSecsSinceEpoch()};
+        m_entries.clear();
+        m_outdatedBytes = 0;
+        if (!m_file.resize(0)
+                || m_file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header)) {
+            close();
+            return false;
+        }
+        m_file.flush();
+        m_size = sizeof(Header);
+        m_lastCompacted = header.lastCompacted;
+    }
+
+    QDateTime lastCompacted = QDateTime::fromMSecsSinceEpoch(m_lastCompacted);
+    if (!m_readOnly
+            && ((m_outdatedBytes > MIN_OUTDATED_BYTES_TO_COMPACT && m_outdatedBytes > m_size / 2)
+                || lastCompacted.daysTo(QDateTime::currentDateTime()) >= COMPACTION_INTERVAL_DAYS)) {
+        compact();
+    }
+    return m_file.isOpen();
+}
+
+bool ThumbnailCache::readEntries() {
+    m_size = m_file.size();
+    if (m_size < (qint64) sizeof(Header) || !remap()) {
+        return false;
+    }
+    const Header *header = reinterpret_cast<const Header*>(m_data);
+    if (header->magic != PACK_MAGIC || header->version != PACK_VERSION) {
+        return false;
+    }
+    m_lastCompacted = header->lastCompacted;
+
+    qint64 offset = sizeof(Header);
+    while (offset + (qint64) sizeof(RecordHeader) <= m_size) {
+        RecordHeader record;
+        std::memcpy(&record, m_data + offset, sizeof(RecordHeader));
+        qint64 dataOffset = offset + sizeof(RecordHeader) + record.pathSize + record.referencedFilesSize;
+        if (dataOffset > m_size || record.size > m_size - dataOffset) {
+            break;
+        }
+        QByteArray key(record.key, sizeof(record.key));
+        auto previous = m_entries.constFind(key);
+        if (previous != m_entries.constEnd()) {
+            m_outdatedBytes += sizeof(RecordHeader) + previous->pathSize
+                    + previous->referencedFilesSize + previous->size;
+        }
+        m_entries.insert(key, {dataOffset, record.size, record.pathSize, record.referencedFilesSize,
+                               record.imageFileSize, record.imageLastModified});
+        offset = dataOffset + record.size;
+    }
+
+    if (offset != m_size) {
+        if (m_readOnly) {
+            // The other process is appending a record, we don't know it anyway
+            m_size = offset;
+            return true;
+        }
+        // The application has been terminated while appending a record
+        unmap();
+        if (!m_file.resize(offset)) {
+            return false;
+        }
+        m_size = offset;
+        if (!remap()) {
+            return false;
+        }
+    }
+    m_file.seek(m_size);
+    return true;
+}
+
+bool ThumbnailCache::remap() {
+    unmap();
+    m_data = m_file.map(0, m_size);
+    m_mappedSize = m_data ? m_size : 0;
+    return m_data != Q_NULLPTR;
+}
+
+void ThumbnailCache::unmap() {
+    if (m_data) {
+        m_file.unmap(m_data);
+    }
+    m_data = Q_NULLPTR;
+    m_mappedSize = 0;
+}
+
+void ThumbnailCache::compact() {
+    QSaveFile compactedFile(m_file.fileName());
+    if (!compactedFile.open(QFile::WriteOnly)) {
+        return;
+    }
+    Header header = {PACK_MAGIC, PACK_VERSION, QDateTime::currentMSecsSinceEpoch()};
+    compactedFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); it++) {
+        const char *path = reinterpret_cast<const char*>(m_data + it->offset - it->referencedFilesSize
+                                                         - it->pathSize);
+        //! The thumbnails of changed, moved or deleted images would never be looked up again
+        QFileInfo imageFile(QString::fromUtf8(path, (int) it->pathSize));
+        if (!imageFile.exists()
+                || imageFile.size() != it->imageFileSize
+                || imageFile.lastModified().toMSecsSinceEpoch() != it->imageLastModified
+                || !referencedFilesUpToDate(QByteArray::fromRawData(path + it->pathSize,
+                                                                    (int) it->referencedFilesSize))) {
+            continue;
+        }
+        RecordHeader record;
+        std::memcpy(record.key, it.key().constData(), sizeof(record.key));
+        record.size = it->size;
+        record.pathSize = it->pathSize;
+        record.referencedFilesSize = it->referencedFilesSize;
+        record.imageFileSize = it->imageFileSize;
+        record.imageLastModified = it->imageLastModified;
+        compactedFile.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        compactedFile.write(path, it->pathSize + it->referencedFilesSize + it->size);
+    }
+
+    //! Keep the lock, the file is only replaced
+    QString path = m_file.fileName();
+    unmap();
+    m_file.close();
+    m_entries.clear();
+    m_outdatedBytes = 0;
+    if (!compactedFile.commit()) {
+        qWarning() << "Could not compact the thumbnail cache" << path;
+    }
+    m_file.setFileName(path);
+    if (!m_file.open(QFile::ReadWrite) || !readEntries()) {
+        close();
+    }
+}
+
+void ThumbnailCache::close() {
+    unmap();
+    m_file.close();
+    m_size = 0;
+    m_entries.clear();
+    m_outdatedBytes = 0;
+    m_lastCompacted = 0;
+    m_lockFile.reset();
+    m_readOnly = false;
+}
+
+bool ThumbnailCache::isOpen() const {
+    return m_file.isOpen();
+}
+
+bool ThumbnailCache::isReadOnly() const {
+    return m_readOnly;
+}
+
+QByteArray ThumbnailCache::keyFor(const QFileInfo &imageFile, const QByteArray &variant) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(imageFile.absoluteFilePath().toUtf8());
+    hash.addData(variant);
+    return hash.result();
+}
+
+bool ThumbnailCache::lookup(const QFileInfo &imageFile, int height, QImage &thumbnail) {
+    return lookup(imageFile, QByteArray::number(height), thumbnail);
+}
+
+bool ThumbnailCache::findEntry(const QFileInfo &imageFile, const QByteArray &variant,
+                               Entry &entry, QByteArray &referencedFiles) {
+    if (!m_file.isOpen()) {
+        return false;
+    }
+    auto it = m_entries.constFind(keyFor(imageFile, variant));
+    if (it == m_entries.constEnd()
+            || it->imageFileSize != imageFile.size()
+            || it->imageLastModified != imageFile.lastModified().toMSecsSinceEpoch()) {
+        return false;
+    }
+    // Records appended since the file has been mapped are not visible in the mapping yet
+    if (it->offset + it->size > m_mappedSize && !remap()) {
+        return false;
+    }
+    entry = it.value();
+    // Copied because appending might remap the file, the files are compared without the lock
+    referencedFiles = QByteArray(reinterpret_cast<const char*>(m_data + entry.offset - entry.referencedFilesSize),
+                                 entry.referencedFilesSize);
+    return true;
+}
+
+bool ThumbnailCache::lookup(const QFileInfo &imageFile, const QByteArray &variant, QImage &thumbnail) {
+    QByteArray referencedFiles;
+    QByteArray encodedThumbnail;
+    {
+        QMutexLocker locker(&m_mutex);
+        Entry entry;
+        if (!findEntry(imageFile, variant, entry, referencedFiles)) {
+            return false;
+        }
+        // Copy while locked, decoding is done without the lock
+        encodedThumbnail = QByteArray(reinterpret_cast<const char*>(m_data + entry.offset), entry.size);
+    }
+    return referencedFilesUpToDate(referencedFiles) && thumbnail.loadFromData(encodedThumbnail);
+}
+
+bool ThumbnailCache::contains(const QFileInfo &imageFile, const QByteArray &variant) {
+    QByteArray referencedFiles;
+    {
+        QMutexLocker locker(&m_mutex);
+        Entry entry;
+        if (!findEntry(imageFile, variant, entry, referencedFiles)) {
+            return false;
+        }
+    }
+    return referencedFilesUpToDate(referencedFiles);
+}
+
+void ThumbnailCache::insert(const QFileInfo &imageFile, int height, const QImage &thumbnail) {
+    insert(imageFile, QByteArray::number(height), thumbnail);
+}
+
+void ThumbnailCache::insert(const QFileInfo &imageFile, const QByteArray &variant, const QImage &thumbnail,
+                            const QStringList &referencedFiles) {
+    if (thumbnail.isNull()) {
+        return;
+    }
+    QByteArray encodedThumbnail;
+    QBuffer buffer(&encodedThumbnail);
+    buffer.open(QIODevice::WriteOnly);
+    // JPEG is a lot smaller and faster to decode but drops the alpha channel
+    if (!thumbnail.save(&buffer, thumbnail.hasAlphaChannel() ? "PNG" : "JPG", 90)) {
+        return;
+    }
+
+    RecordHeader record;
+    QByteArray key = keyFor(imageFile, variant);
+    QByteArray path = imageFile.absoluteFilePath().toUtf8();
+    QByteArray encodedReferencedFiles = encodeReferencedFiles(referencedFiles);
+    std::memcpy(record.key, key.constData(), sizeof(record.key));
+    record.size = encodedThumbnail.size();
+    record.pathSize = path.size();
+    record.referencedFilesSize = encodedReferencedFiles.size();
+    record.imageFileSize = imageFile.size();
+    record.imageLastModified = imageFile.lastModified().toMSecsSinceEpoch();
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_file.isOpen() || m_readOnly) {
+        return;
+    }
+    m_file.seek(m_size);
+    if (m_file.write(reinterpret_cast<const char*>(&record), sizeof(record)) != sizeof(record)
+            || m_file.write(path) != path.size()
+            || m_file.write(encodedReferencedFiles) != encodedReferencedFiles.size()
+            || m_file.write(encodedThumbnail) != encodedThumbnail.size()
+            || !m_file.flush()) {
+        // Cut off the partial record to keep the file consistent
+        m_file.resize(m_size);
+        return;
+    }
+    qint64 dataOffset = m_size + sizeof(RecordHeader) + record.pathSize + record.referencedFilesSize;
+    auto previous = m_entries.constFind(key);
+    if (previous != m_entries.constEnd()) {
+        m_outdatedBytes += sizeof(RecordHeader) + previous->pathSize
+                + previous->referencedFilesSize + previous->size;
+    }
+    m_entries.insert(key, {dataOffset, record.size, record.pathSize, record.referencedFilesSize,
+                           record.imageFileSize, record.imageLastModified});
+    m_size = dataOffset + record.size;
+}
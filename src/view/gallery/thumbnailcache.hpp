@@ -0,0 +1,123 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QMutex>
+#include <QLockFile>
+#include <QScopedPointer>
+
+/*!
+ * \brief The ThumbnailCache class persists the thumbnails of the gallery across sessions in a
+ * single pack file. The file consists of a header followed by records that are only ever appended,
+ * each holding the key, the size and modification date of the image the thumbnail has been created
+ * from, the absolute image path, the files the thumbnail depends on besides the image and the
+ * encoded thumbnail.
+ *
+ * Records are addressed by the hash of the absolute image path and a variant, e.g. the thumbnail
+ * height or the parameters the image has been rendered with. A record is only used if the size
+ * and modification date still match the image and the referenced files, e.g. the textures of a
+ * rendered object model, i.e. changed files are invalidated individually. Outdated records are
+ * dropped by compacting the file when opening it, either if they make up a large part of it or if
+ * it hasn't been compacted for COMPACTION_INTERVAL_DAYS. Compacting also drops the records of
+ * images that have been changed, moved or deleted and of those whose referenced files changed.
+ *
+ * The file is memory-mapped. All methods are thread-safe, i.e. the cache can be shared by the
+ * runnables that create the thumbnails. Only one process writes to the file at a time, the file is
+ * opened read-only if another process holds its lock file.
+ */
+class ThumbnailCache {
+
+public:
+    //! The name of the pack file in the cache directory of the user
+    static const QString FILE_NAME;
+    //! The pack file is compacted on opening if it hasn't been compacted for this many days
+    static const int COMPACTION_INTERVAL_DAYS;
+
+    ThumbnailCache();
+
+    ~ThumbnailCache();
+
+    /*!
+     * \brief open opens the pack file at the given path and creates it if it doesn't exist.
+     * A file that is not a valid pack file is overwritten.
+     * \return true if the file could be opened
+     */
+    bool open(const QString &path);
+
+    void close();
+
+    bool isOpen() const;
+
+    //! Whether another process writes to the pack file, no thumbnails are inserted then
+    bool isReadOnly() const;
+
+    /*!
+     * \brief lookup reads the thumbnail of the given image file.
+     * \return true if there is a thumbnail that is up to date with the file
+     */
+    bool lookup(const QFileInfo &imageFile, int height, QImage &thumbnail);
+    bool lookup(const QFileInfo &imageFile, const QByteArray &variant, QImage &thumbnail);
+
+    /*!
+     * \brief contains returns whether lookup would find a thumbnail without decoding it, i.e.
+     * it only compares the image file and the referenced files with the record.
+     */
+    bool contains(const QFileInfo &imageFile, const QByteArray &variant);
+
+    /*!
+     * \brief insert stores the thumbnail of the given image file and replaces any older one.
+     * \param referencedFiles the absolute paths of the files the thumbnail depends on besides
+     * the image file, their current size and modification date are stored with the thumbnail
+     */
+    void insert(const QFileInfo &imageFile, int height, const QImage &thumbnail);
+    void insert(const QFileInfo &imageFile, const QByteArray &variant, const QImage &thumbnail,
+                const QStringList &referencedFiles = QStringList());
+
+    //! The path of the pack file with the given name in the cache directory of the user
+    static QString defaultPath(const QString &fileName = FILE_NAME);
+
+private:
+    struct Entry {
+        //! The offset of the encoded thumbnail, the image path and the referenced files are stored right before it
+        qint64 offset;
+        quint32 size;
+        quint32 pathSize;
+        quint32 referencedFilesSize;
+        qint64 imageFileSize;
+        qint64 imageLastModified;
+    };
+
+    static QByteArray keyFor(const QFileInfo &imageFile, const QByteArray &variant);
+    /*!
+     * \brief findEntry looks up the entry of the image file and copies the referenced files of
+     * its record. Must be called with the mutex locked.
+     */
+    bool findEntry(const QFileInfo &imageFile, const QByteArray &variant,
+                   Entry &entry, QByteArray &referencedFiles);
+    bool readEntries();
+    bool remap();
+    void unmap();
+    void compact();
+
+private:
+    QMutex m_mutex;
+    QFile m_file;
+    //! Held as long as the file is open for writing
+    QScopedPointer<QLockFile> m_lockFile;
+    bool m_readOnly = false;
+    qint64 m_lastCompacted = 0;
+    uchar *m_data = Q_NULLPTR;
+    qint64 m_mappedSize = 0;
+    qint64 m_size = 0;
+    QHash<QByteArray, Entry> m_entries;
+    //! The bytes of records that have been replaced by newer ones
+    qint64 m_outdatedBytes = 0;
+};
+
+#endif // THUMBNAILCACHE_H
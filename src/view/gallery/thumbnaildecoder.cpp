@@ -0,0 +1,63 @@
+#include "thumbnaildecoder.hpp"
+
+#include <QFile>
+#include <QImageReader>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgcodecs/imgcodecs.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+QImage ThumbnailDecoder::decode(const QString &imagePath, int height, Method method) {
+    if (method == ReducedDecode) {
+        QImage image = decodeReduced(imagePath, height);
+        if (!image.isNull()) {
+            return image;
+        }
+    }
+    return decodeScaled(imagePath, height);
+}
+
+QImage ThumbnailDecoder::decodeScaled(const QString &imagePath, int height) {
+    QImageReader imageReader(imagePath);
+    float aspectRatio = imageReader.size().width() / (float) imageReader.size().height();
+    imageReader.setScaledSize(QSize(height * aspectRatio, height));
+    return imageReader.read();
+}
+
+QImage ThumbnailDecoder::decodeReduced(const QString &imagePath, int height) {
+    // Only reads the header
+    QImageReader imageReader(imagePath);
+    QSize size = imageReader.size();
+    if (!size.isValid() || size.height() <= height) {
+        return QImage();
+    }
+    QImage::Format format = imageReader.imageFormat();
+    if (format == QImage::Format_Invalid
+            || QImage::toPixelFormat(format).alphaUsage() == QPixelFormat::UsesAlpha) {
+        // The reduced modes of OpenCV drop the alpha channel
+        return QImage();
+    }
+
+    // The largest reduction that still yields at least the requested height
+    int mode = cv::IMREAD_COLOR;
+    if (size.height() / 8 >= height) {
+        mode = cv::IMREAD_REDUCED_COLOR_8;
+    } else if (size.height() / 4 >= height) {
+        mode = cv::IMREAD_REDUCED_COLOR_4;
+    } else if (size.height() / 2 >= height) {
+        mode = cv::IMREAD_REDUCED_COLOR_2;
+    }
+    // QImageReader doesn't apply the EXIF orientation either, i.e. both ways yield the same thumbnail
+    cv::Mat decoded = cv::imread(QFile::encodeName(imagePath).toStdString(),
+                                 mode | cv::IMREAD_IGNORE_ORIENTATION);
+    if (decoded.empty()) {
+        return QImage();
+    }
+
+    int width = qRound(height * decoded.cols / (double) decoded.rows);
+    cv::Mat resized;
+    cv::resize(decoded, resized, cv::Size(qMax(1, width), height), 0, 0, cv::INTER_AREA);
+    // rgbSwapped() copies, i.e. the image doesn't refer to the data of the matrix anymore
+    return QImage(resized.data, resized.cols, resized.rows, (int) resized.step,
+                  QImage::Format_RGB888).rgbSwapped();
+}
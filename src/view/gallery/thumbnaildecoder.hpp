@@ -0,0 +1,38 @@
+#ifndef THUMBNAILDECODER_H
+#define THUMBNAILDECODER_H
+
+#include <QImage>
+#include <QString>
+
+/*!
+ * \brief The ThumbnailDecoder class decodes images directly at a reduced size for the gallery.
+ *
+ * JPEGs are decoded with the DCT scaling of libjpeg (1/2, 1/4 or 1/8 of the size) through the
+ * reduced modes of OpenCV, i.e. most of the full-size decoding work is skipped. Other formats
+ * are decoded by OpenCV as well which downscales them considerably faster than the smooth
+ * scaling of QImageReader. The remainder of the reduction to the requested height is done by
+ * area interpolation. Images with an alpha channel and images OpenCV fails to read are decoded
+ * by QImageReader with a scaled size like before.
+ */
+class ThumbnailDecoder {
+
+public:
+    enum Method {
+        //! QImageReader::setScaledSize, the previous way of creating thumbnails
+        ScaledRead,
+        //! Reduced decoding through OpenCV, falls back to ScaledRead where not applicable
+        ReducedDecode
+    };
+
+    /*!
+     * \brief decode reads the image at the given path with the given height, keeping the aspect ratio.
+     * \return the decoded image or a null image if reading fails
+     */
+    static QImage decode(const QString &imagePath, int height, Method method = ReducedDecode);
+
+private:
+    static QImage decodeScaled(const QString &imagePath, int height);
+    static QImage decodeReduced(const QString &imagePath, int height);
+};
+
+#endif // THUMBNAILDECODER_H
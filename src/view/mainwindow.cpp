@@ -46,6 +46,7 @@ MainWindow::MainWindow(QWidget *parent,
     setGalleryImageModel(galleryImageModel);
     galleryObjectModelModel = new GalleryObjectModelModel(modelManager);
     setGalleryObjectModelModel(galleryObjectModelModel);
+    setThumbnailCacheSizes(settingsStore->currentSettings());
 
     setPathsOnGalleriesAndBreadcrumbs();
 
@@ -131,6 +132,8 @@ void MainWindow::closeEvent(QCloseEvent *event) {
 
 void MainWindow::setGalleryImageModel(GalleryImageModel* model) {
     this->ui->galleryLeft->setModel(model);
+    connect(ui->galleryLeft, &Gallery::visibleItemsChanged,
+            model, &GalleryImageModel::setVisibleRows);
 }
 
 void MainWindow::setGalleryObjectModelModel(GalleryObjectModelModel* model) {
@@ -228,11 +231,19 @@ Gallery *MainWindow::galleryImages() {
 
 void MainWindow::showDataLoadingProgressView(bool show) {
     progressDialog->setLabelText(tr("Loading data..."));
+    // Busy indicator until the first progress arrives
+    progressDialog->setRange(0, 0);
     showProgressView(show);
 }
 
+void MainWindow::setDataLoadingProgress(int progress) {
+    progressDialog->setRange(0, 100);
+    progressDialog->setValue(progress);
+}
+
 void MainWindow::showPoseRecoveringProgressView(bool show) {
     progressDialog->setLabelText(tr("Recovering pose..."));
+    progressDialog->setRange(0, 0);
     showProgressView(show);
 }
 
@@ -278,9 +289,17 @@ void MainWindow::setPathsOnGalleriesAndBreadcrumbs() {
 
 void MainWindow::onSettingsChanged(SettingsPtr settings) {
     galleryObjectModelModel->setSegmentationCodesForObjectModels(settings->segmentationCodes());
+    setThumbnailCacheSizes(settings);
     setPathsOnGalleriesAndBreadcrumbs();
 }
 
+void MainWindow::setThumbnailCacheSizes(SettingsPtr settings) {
+    // Both galleries get the full budget, there are usually far fewer object models than images
+    qint64 bytes = qint64(settings->thumbnailCacheSize()) * 1024 * 1024;
+    galleryImageModel->setThumbnailCacheSize(bytes);
+    galleryObjectModelModel->setRenderingsCacheSize(bytes);
+}
+
 void MainWindow::onActionAboutTriggered() {
     QMessageBox about;
     about.setText(tr("What is 6D-PAT?"));
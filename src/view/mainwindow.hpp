@@ -52,6 +52,8 @@ public:
     GalleryObjectModels *galleryObjectModels();
     Gallery *galleryImages();
     void showDataLoadingProgressView(bool show);
+    //! Turns the busy indicator of the data loading progress view into a percentage
+    void setDataLoadingProgress(int progress);
     void showPoseRecoveringProgressView(bool show);
 
 public Q_SLOTS:
@@ -141,6 +143,7 @@ private:
 
     void setGalleryImageModel(GalleryImageModel* model);
     void setGalleryObjectModelModel(GalleryObjectModelModel* model);
+    void setThumbnailCacheSizes(SettingsPtr settings);
 
     // Used to write and read main view related settings, like position etc.
     void writeSettings();
@@ -22,6 +22,14 @@ QPoint MouseCoordinatesModificationEventFilter::offset() {
     return QPoint(m_offsetX, m_offsetY);
 }
 
+void MouseCoordinatesModificationEventFilter::setScale(float scale) {
+    m_scale = scale;
+}
+
+float MouseCoordinatesModificationEventFilter::scale() {
+    return m_scale;
+}
+
 bool MouseCoordinatesModificationEventFilter::eventFilter(QObject *obj, QEvent *event) {
     if (event->type() == QEvent::HoverMove ||
         event->type() == QEvent::MouseMove ||
@@ -29,7 +37,7 @@ bool MouseCoordinatesModificationEventFilter::eventFilter(QObject *obj, QEvent *
         event->type() == QEvent::MouseButtonRelease ||
         event->type() == QEvent::MouseButtonDblClick) {
         QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
-        QPointF offsetPos = mouseEvent->pos() - QPointF(m_offsetX, m_offsetY);
+        QPointF offsetPos = (mouseEvent->localPos() - QPointF(m_offsetX, m_offsetY)) * m_scale;
         mouseEvent->setLocalPos(offsetPos);
         return false;
     } else {
@@ -11,6 +11,9 @@ public:
     void setOffset(int x, int y);
     void setOffset(QPoint offset);
     QPoint offset();
+    //! Scales the coordinates after subtracting the offset, e.g. when rendering at a lower resolution
+    void setScale(float scale);
+    float scale();
 
 protected:
     bool eventFilter(QObject *obj, QEvent *event) override;
@@ -18,6 +21,7 @@ protected:
 private:
     int m_offsetX = 0;
     int m_offsetY = 0;
+    float m_scale = 1.f;
     QObject *m_widgetToProceedWith;
 
 };
@@ -3,6 +3,7 @@
 #include "misc/global.hpp"
 
 #include <math.h>
+#include <climits>
 #include <QtMath>
 #include <QTime>
 #include <QTimer>
@@ -10,12 +11,13 @@
 #include <QApplication>
 #include <QFrame>
 #include <QImage>
+#include <QImageReader>
 #include <QMouseEvent>
 
 #include <QOpenGLFunctions>
+#include <QOpenGLExtraFunctions>
 
 #include <Qt3DRender/QCameraLens>
-#include <Qt3DRender/QPickingSettings>
 #include <Qt3DRender/QFilterKey>
 #include <Qt3DRender/QParameter>
 
@@ -54,6 +56,20 @@ PoseViewer3DWidget::PoseViewer3DWidget(QWidget *parent)
       , m_backgroundCameraSelector(new Qt3DRender::QCameraSelector)
       , m_backgroundNoDepthMask(new Qt3DRender::QNoDepthMask)
       , m_backgroundNoPicking(new Qt3DRender::QNoPicking)
+      // Pick branch
+      , m_pickRenderTargetSelector(new Qt3DRender::QRenderTargetSelector)
+      , m_pickRenderTarget(new Qt3DRender::QRenderTarget)
+      , m_pickIdOutput(new Qt3DRender::QRenderTargetOutput)
+      , m_pickIdTexture(new Qt3DRender::QTexture2D)
+      , m_pickDepthOutput(new Qt3DRender::QRenderTargetOutput)
+      , m_pickDepthTexture(new Qt3DRender::QTexture2D)
+      , m_pickClearBuffers(new Qt3DRender::QClearBuffers)
+      , m_pickNoDraw(new Qt3DRender::QNoDraw)
+      , m_pickLayerFilter(new Qt3DRender::QLayerFilter)
+      // Owned by the scene, it would be deleted with the first pose that uses it otherwise
+      , m_pickLayer(new Qt3DRender::QLayer(m_sceneRoot))
+      , m_pickFrustumCulling(new Qt3DRender::QFrustumCulling)
+      , m_pickCameraSelector(new Qt3DRender::QCameraSelector)
       // Poses branch
       , m_posesLayerFilter(new Qt3DRender::QLayerFilter)
       , m_posesLayer(new Qt3DRender::QLayer)
@@ -73,12 +89,23 @@ PoseViewer3DWidget::PoseViewer3DWidget(QWidget *parent)
       , m_clickVisualizationRenderable(new ClickVisualizationRenderable) {
     m_samples = QSurfaceFormat::defaultFormat().samples();
     m_fpsLabel = new QLabel(this);
-    m_fpsLabel->setGeometry(QRect(10, 10, 80, 20));
+    m_fpsLabel->setGeometry(QRect(10, 10, 300, 20));
     m_fpsLabel->setAccessibleName("m_fpsLabel");
     m_elapsedTimer.start();
     connect(&m_updateFPSLabelTimer, &QTimer::timeout, [this](){
+        if (!m_fpsLabel->isVisible()) {
+            return;
+        }
         m_avgElapsed = m_fpsAlpha * m_avgElapsed + (1.0 - m_fpsAlpha) * m_elapsed;
-        m_fpsLabel->setText(QString::number((int)(1000.f / m_avgElapsed)) + " FPS");
+        m_avgCompositeTime = m_fpsAlpha * m_avgCompositeTime + (1.0 - m_fpsAlpha) * m_compositeTime;
+        QString text = QString::number((int)(1000.f / m_avgElapsed)) + " FPS";
+        if (m_compositeTimerQuery.isCreated()) {
+            text += ", " + QString::number(m_avgCompositeTime, 'f', 2) + " ms resolve";
+        }
+        if (m_resolutionScale < 1.f) {
+            text += ", " + QString::number((int) (m_resolutionScale * 100)) + "% resolution";
+        }
+        m_fpsLabel->setText(text);
     });
     m_updateFPSLabelTimer.setInterval(150);
     m_updateFPSLabelTimer.start();
@@ -88,6 +115,14 @@ PoseViewer3DWidget::~PoseViewer3DWidget() {
     makeCurrent();
     m_vao.destroy();
     m_vbo.destroy();
+    m_resolvedFramebuffer.reset();
+    if (m_multisampleFramebuffer != 0) {
+        context()->functions()->glDeleteFramebuffers(1, &m_multisampleFramebuffer);
+    }
+    if (m_pickFramebuffer != 0) {
+        context()->functions()->glDeleteFramebuffers(1, &m_pickFramebuffer);
+    }
+    m_compositeTimerQuery.destroy();
     doneCurrent();
 }
 
@@ -103,19 +138,15 @@ const char *vertexShaderSource =
         "    texc = texCoord;\n"
         "}\n";
 
+// The multisampled texture is resolved by blitting it beforehand, i.e. this only samples the
+// resolved texture, which also scales it up when rendering at a lower resolution
 const char *fragmentShaderSource =
         "#version 150\n"
-        "uniform sampler2DMS texture;\n"
+        "uniform sampler2D resolvedTexture;\n"
         "varying mediump vec2 texc;\n"
-        "uniform int samples;\n"
         "void main(void)\n"
         "{\n"
-        "   ivec2 tc = ivec2(floor(textureSize(texture) * texc));\n"
-        "   vec4 color = vec4(0.0);\n"
-        "   for(int i = 0; i < samples; i++) {\n"
-        "       color += texelFetch(texture, tc, i);\n"
-        "   }\n"
-        "   gl_FragColor = color / float(samples);\n"
+        "   gl_FragColor = texture(resolvedTexture, texc);\n"
         "}\n";
 
 void PoseViewer3DWidget::initializeGL() {
@@ -173,10 +204,15 @@ void PoseViewer3DWidget::initOpenGL() {
     m_shaderProgram->link();
 
     m_shaderProgram->bind();
-    m_shaderProgram->setUniformValue("texture", 0);
-    m_shaderProgram->setUniformValue("samples", m_samples);
+    m_shaderProgram->setUniformValue("resolvedTexture", 0);
     m_shaderProgram->release();
 
+    QOpenGLFunctions *functions = QOpenGLContext::currentContext()->functions();
+    functions->glGenFramebuffers(1, &m_multisampleFramebuffer);
+    functions->glGenFramebuffers(1, &m_pickFramebuffer);
+    // Not available on all drivers, the FPS label only misses the resolve time then
+    m_compositeTimerQuery.create();
+
 
     m_shaderProgram->bind();
     m_vao.create();
@@ -295,6 +331,7 @@ void PoseViewer3DWidget::initQt3D() {
     m_posesLayerFilter->setParent(m_viewport);
     m_posesLayerFilter->addLayer(m_backgroundLayer);
     m_posesLayerFilter->addLayer(m_clickVisualizationLayer);
+    m_posesLayerFilter->addLayer(m_pickLayer);
     m_posesLayerFilter->setFilterMode(Qt3DRender::QLayerFilter::DiscardAnyMatchingLayers);
     m_posesFrustumCulling->setParent(m_posesLayerFilter);
     m_snapshotRenderPassFilter->setParent(m_posesFrustumCulling);
@@ -327,11 +364,39 @@ void PoseViewer3DWidget::initQt3D() {
     m_clickVisualizationRenderable->addComponent(m_clickVisualizationLayer);
     m_clickVisualizationRenderable->setSize(this->size());
 
+    // Sixth branch draws the pick IDs of the poses into their own target
+    m_pickIdOutput->setAttachmentPoint(Qt3DRender::QRenderTargetOutput::Color0);
+    m_pickIdTexture->setSize(width(), height());
+    // The pick ID and the depth must not be interpolated or quantized
+    m_pickIdTexture->setFormat(Qt3DRender::QAbstractTexture::RGBA32F);
+    m_pickIdTexture->setMinificationFilter(Qt3DRender::QAbstractTexture::Nearest);
+    m_pickIdTexture->setMagnificationFilter(Qt3DRender::QAbstractTexture::Nearest);
+    m_pickIdOutput->setTexture(m_pickIdTexture);
+    m_pickRenderTarget->addOutput(m_pickIdOutput);
+    m_pickDepthOutput->setAttachmentPoint(Qt3DRender::QRenderTargetOutput::Depth);
+    m_pickDepthTexture->setSize(width(), height());
+    m_pickDepthTexture->setFormat(Qt3DRender::QAbstractTexture::DepthFormat);
+    m_pickDepthOutput->setTexture(m_pickDepthTexture);
+    m_pickRenderTarget->addOutput(m_pickDepthOutput);
+    m_pickRenderTargetSelector->setParent(m_viewport);
+    m_pickRenderTargetSelector->setTarget(m_pickRenderTarget);
+    m_pickClearBuffers->setParent(m_pickRenderTargetSelector);
+    m_pickClearBuffers->setBuffers(Qt3DRender::QClearBuffers::ColorDepthBuffer);
+    // Pick ID 0, i.e. no pose
+    m_pickClearBuffers->setClearColor(QColor(0, 0, 0, 0));
+    m_pickNoDraw->setParent(m_pickClearBuffers);
+    m_pickLayerFilter->setParent(m_pickRenderTargetSelector);
+    m_pickLayerFilter->addLayer(m_pickLayer);
+    m_pickFrustumCulling->setParent(m_pickLayerFilter);
+    m_pickCameraSelector->setParent(m_pickFrustumCulling);
+    m_pickCameraSelector->setCamera(m_posesCamera);
+
     // Global rendering config
-    m_renderSettings->pickingSettings()->setPickMethod(
-                Qt3DRender::QPickingSettings::TrianglePicking);
     // RenderStateSet is the first node of the overall framegraph
     m_renderSettings->setActiveFrameGraph(m_renderStateSet);
+    m_renderSettings->setRenderPolicy(m_continuousRendering
+                                      ? Qt3DRender::QRenderSettings::Continuous
+                                      : Qt3DRender::QRenderSettings::OnDemand);
     m_inputSettings->setEventSource(this);
 }
 
@@ -339,11 +404,30 @@ void PoseViewer3DWidget::paintGL() {
     m_elapsed = m_elapsedTimer.elapsed();
     // Restart the timer
     m_elapsedTimer.start();
+    if (m_compositeTimerQueryPending && m_compositeTimerQuery.isResultAvailable()) {
+        // Nanoseconds
+        m_compositeTime = m_compositeTimerQuery.waitForResult() / 1000000.f;
+        m_compositeTimerQueryPending = false;
+    }
+    bool measureCompositeTime = m_compositeTimerQuery.isCreated() && !m_compositeTimerQueryPending;
+    if (measureCompositeTime) {
+        m_compositeTimerQuery.begin();
+    }
+
     glClearColor(1.0, 1.0, 1.0, 1.0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_MULTISAMPLE);
     glDisable(GL_BLEND);
 
+    resolveColorTexture();
+    if (m_resolvedFramebuffer.isNull()) {
+        // Qt3D hasn't created the offscreen texture yet
+        if (measureCompositeTime) {
+            m_compositeTimerQuery.end();
+            m_compositeTimerQueryPending = true;
+        }
+        return;
+    }
+
     m_shaderProgram->bind();
     {
         QMatrix4x4 m;
@@ -355,10 +439,115 @@ void PoseViewer3DWidget::paintGL() {
         QOpenGLVertexArrayObject::Binder vaoBinder(&m_vao);
 
         m_shaderProgram->setUniformValue("matrix", m);
-        glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, m_colorTexture->handle().toUInt());
+        glBindTexture(GL_TEXTURE_2D, m_resolvedFramebuffer->texture());
         glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
     }
     m_shaderProgram->release();
+
+    if (measureCompositeTime) {
+        m_compositeTimerQuery.end();
+        m_compositeTimerQueryPending = true;
+    }
+}
+
+void PoseViewer3DWidget::resolveColorTexture() {
+    GLuint colorTexture = m_colorTexture->handle().toUInt();
+    if (colorTexture == 0 || m_renderTargetSize.isEmpty()) {
+        m_resolvedFramebuffer.reset();
+        return;
+    }
+    if (m_resolvedFramebuffer.isNull() || m_resolvedFramebuffer->size() != m_renderTargetSize) {
+        m_resolvedFramebuffer.reset(new QOpenGLFramebufferObject(m_renderTargetSize));
+        // Linear because the texture is scaled up when rendering at a lower resolution. There is
+        // nothing to minify, the offscreen textures already have the size of the zoomed image.
+        glBindTexture(GL_TEXTURE_2D, m_resolvedFramebuffer->texture());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    QOpenGLExtraFunctions *functions = context()->extraFunctions();
+    functions->glBindFramebuffer(GL_READ_FRAMEBUFFER, m_multisampleFramebuffer);
+    functions->glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                      GL_TEXTURE_2D_MULTISAMPLE, colorTexture, 0);
+    functions->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_resolvedFramebuffer->handle());
+    // Resolves all samples in one pass of the fixed function hardware instead of fetching every
+    // sample of every fragment in a shader
+    functions->glBlitFramebuffer(0, 0, m_renderTargetSize.width(), m_renderTargetSize.height(),
+                                 0, 0, m_renderTargetSize.width(), m_renderTargetSize.height(),
+                                 GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    functions->glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+}
+
+PoseRenderable *PoseViewer3DWidget::poseRenderableAt(const QPoint &position, float &depth) {
+    GLuint pickIdTexture = m_pickIdTexture->handle().toUInt();
+    if (pickIdTexture == 0 || m_renderTargetSize.isEmpty() || m_poseRenderableForPickId.isEmpty()) {
+        return Q_NULLPTR;
+    }
+    // In pixels of the render target, whose rows start at the bottom
+    QPointF positionOnTarget = QPointF(position - m_renderingPosition) * m_resolutionScale;
+    int x = (int) positionOnTarget.x();
+    int y = m_renderTargetSize.height() - 1 - (int) positionOnTarget.y();
+    if (x < 0 || y < 0 || x >= m_renderTargetSize.width() || y >= m_renderTargetSize.height()) {
+        return Q_NULLPTR;
+    }
+    int left = qMax(0, x - PICK_RADIUS);
+    int bottom = qMax(0, y - PICK_RADIUS);
+    int readWidth = qMin(m_renderTargetSize.width() - 1, x + PICK_RADIUS) - left + 1;
+    int readHeight = qMin(m_renderTargetSize.height() - 1, y + PICK_RADIUS) - bottom + 1;
+    QVector<GLfloat> pixels(readWidth * readHeight * 4);
+
+    makeCurrent();
+    QOpenGLExtraFunctions *functions = context()->extraFunctions();
+    functions->glBindFramebuffer(GL_READ_FRAMEBUFFER, m_pickFramebuffer);
+    functions->glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                      GL_TEXTURE_2D, pickIdTexture, 0);
+    // Only the few pixels around the cursor, i.e. the readback is negligible compared to the
+    // triangle picking it replaces
+    functions->glReadPixels(left, bottom, readWidth, readHeight, GL_RGBA, GL_FLOAT, pixels.data());
+    functions->glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    doneCurrent();
+
+    PoseRenderable *closestPoseRenderable = Q_NULLPTR;
+    int closestDistance = INT_MAX;
+    for (int row = 0; row < readHeight; row++) {
+        for (int column = 0; column < readWidth; column++) {
+            const GLfloat *pixel = pixels.constData() + (row * readWidth + column) * 4;
+            PoseRenderable *poseRenderable = m_poseRenderableForPickId.value(qRound(pixel[0]));
+            int dx = left + column - x;
+            int dy = bottom + row - y;
+            if (poseRenderable && dx * dx + dy * dy < closestDistance) {
+                closestPoseRenderable = poseRenderable;
+                closestDistance = dx * dx + dy * dy;
+                depth = pixel[1];
+            }
+        }
+    }
+    return closestPoseRenderable;
+}
+
+void PoseViewer3DWidget::setHoveredPoseRenderable(PoseRenderable *poseRenderable) {
+    if (poseRenderable == m_hoveredPose) {
+        return;
+    }
+    if (m_hoveredPose) {
+        setPoseRenderableHovered(m_hoveredPose, false);
+    }
+    if (poseRenderable) {
+        setPoseRenderableHovered(poseRenderable, true);
+    }
+    m_hoveredPose = poseRenderable;
+    m_mouseOverPoseRenderable = poseRenderable != Q_NULLPTR;
+}
+
+QVector3D PoseViewer3DWidget::unprojectMousePosition(const QPoint &position, float depth) {
+    QPointF pickPosition = QPointF(position - m_renderingPosition) / (m_zoom / 100.f);
+    float posY = m_imageSize.height() - pickPosition.y() - 1.0f;
+    return QVector3D(pickPosition.x(), posY, depth).unproject(m_posesCamera->viewMatrix(),
+                                                              m_projectionMatrix,
+                                                              QRect(0, 0,
+                                                                    m_imageSize.width(),
+                                                                    m_imageSize.height()));
 }
 
 void PoseViewer3DWidget::reset() {
@@ -374,32 +563,107 @@ void PoseViewer3DWidget::setSettings(SettingsPtr settings) {
     this->m_settings = settings;
     setSamples(settings->multisampleSamples());
     m_fpsLabel->setVisible(settings->showFPSLabel());
+    setInstancedRendering(settings->instancedRendering());
+    setContinuousRendering(settings->continuousRendering());
+    m_adaptiveResolution = settings->adaptiveResolution();
+    if (!m_adaptiveResolution) {
+        setResolutionScale(1.f);
+    }
+    requestRender();
+}
+
+void PoseViewer3DWidget::setContinuousRendering(bool continuousRendering) {
+    m_continuousRendering = continuousRendering;
+    m_renderSettings->setRenderPolicy(continuousRendering
+                                      ? Qt3DRender::QRenderSettings::Continuous
+                                      : Qt3DRender::QRenderSettings::OnDemand);
+}
+
+void PoseViewer3DWidget::requestRender() {
+    m_framesToPresent = FRAMES_TO_PRESENT_AFTER_CHANGE;
+}
+
+void PoseViewer3DWidget::updateRenderTargetSize() {
+    QSize scaledSize = m_imageSize * m_renderingScale;
+    m_renderTargetSize = scaledSize * m_resolutionScale;
+    m_colorTexture->setSize(m_renderTargetSize.width(), m_renderTargetSize.height());
+    m_depthTexture->setSize(m_renderTargetSize.width(), m_renderTargetSize.height());
+    m_pickIdTexture->setSize(m_renderTargetSize.width(), m_renderTargetSize.height());
+    m_pickDepthTexture->setSize(m_renderTargetSize.width(), m_renderTargetSize.height());
+    m_renderSurfaceSelector->setExternalRenderTargetSize(m_renderTargetSize);
+    // The clicks are drawn in pixels of the render target
+    m_clickVisualizationRenderable->setSize(m_renderTargetSize);
+    m_clickVisualizationCamera->lens()->setOrthographicProjection(
+                -m_renderTargetSize.width() / 2.f, m_renderTargetSize.width() / 2.f,
+                -m_renderTargetSize.height() / 2.f, m_renderTargetSize.height() / 2.f,
+                0.1f, 1000.f);
+    // Qt3D picks in pixels of the render target, too
+    if (m_mouseCoordinatesModificationEventFilter) {
+        m_mouseCoordinatesModificationEventFilter->setScale(m_resolutionScale);
+    }
+    requestRender();
+}
+
+void PoseViewer3DWidget::setResolutionScale(float resolutionScale) {
+    if (resolutionScale == m_resolutionScale) {
+        return;
+    }
+    m_resolutionScale = resolutionScale;
+    updateRenderTargetSize();
+}
+
+void PoseViewer3DWidget::setInstancedRendering(bool instancedRendering) {
+    if (instancedRendering == m_instancedRendering) {
+        return;
+    }
+    m_instancedRendering = instancedRendering;
+    // The bounding volume of the instanced entities is the one of the untransformed object model,
+    // i.e. it would be culled wrongly. Culling single instances is not possible anyways.
+    m_posesFrustumCulling->setEnabled(!instancedRendering);
+    // Recreate the renderables in the new mode
+    PosePtr selectedPose = m_selectedPose;
+    QList<PosePtr> poses;
+    for (PoseRenderable *poseRenderable : m_poseRenderables) {
+        poses.append(poseRenderable->pose());
+    }
+    setPoses(poses);
+    if (!selectedPose.isNull()) {
+        selectPose(selectedPose, PosePtr());
+    }
 }
 
 void PoseViewer3DWidget::setClicks(const QList<QPoint> &clicks) {
     m_clickVisualizationRenderable->setClicks(clicks);
+    requestRender();
 }
 
 void PoseViewer3DWidget::setBackgroundImage(const QString& image, const QMatrix3x3 &cameraMatrix,
                                             float nearPlane, float farPlane) {
-    QImage loadedImage(image);
-    this->m_imageSize = loadedImage.size();
-    setRenderingSize(loadedImage.width(), loadedImage.height());
+    // Only reads the header, the BackgroundImageRenderable decodes the image in the background
+    QSize imageSize = QImageReader(image).size();
+    if (!imageSize.isValid()) {
+        // The format doesn't store the size in its header
+        imageSize = QImage(image).size();
+    }
+    this->m_imageSize = imageSize;
+    setRenderingSize(imageSize.width(), imageSize.height());
 
     if (m_backgroundImageRenderable.isNull()) {
         m_backgroundImageRenderable = new BackgroundImageRenderable(m_sceneRoot, image);
         m_backgroundImageRenderable->addComponent(m_backgroundLayer);
+        connect(m_backgroundImageRenderable, &BackgroundImageRenderable::imageLoaded,
+                this, &PoseViewer3DWidget::requestRender);
         // Only set the image position the first time
-        int x = -loadedImage.width() / 2 + ((QWidget*) this->parent())->width() / 2;
-        int y = -loadedImage.height() / 2 + ((QWidget*) this->parent())->height() / 2;
+        int x = -imageSize.width() / 2 + ((QWidget*) this->parent())->width() / 2;
+        int y = -imageSize.height() / 2 + ((QWidget*) this->parent())->height() / 2;
         setRenderingPosition(x, y);
         m_mouseCoordinatesModificationEventFilter->setOffset(x, y);
     } else {
         m_backgroundImageRenderable->setImage(image);
     }
 
-    float w = loadedImage.width();
-    float h = loadedImage.height();
+    float w = imageSize.width();
+    float h = imageSize.height();
     float depth = (float) farPlane - nearPlane;
     float q = -(farPlane + nearPlane) / depth;
     float qn = -2 * (farPlane * nearPlane) / depth;
@@ -410,6 +674,7 @@ void PoseViewer3DWidget::setBackgroundImage(const QString& image, const QMatrix3
                                                 0,                0,                     -1, 0);
     m_posesCamera->setProjectionMatrix(m_projectionMatrix);
     m_backgroundImageRenderable->setEnabled(true);
+    requestRender();
 }
 
 void PoseViewer3DWidget::setPoses(const QList<PosePtr> &poses) {
@@ -419,69 +684,72 @@ void PoseViewer3DWidget::setPoses(const QList<PosePtr> &poses) {
         // This also deletes the renderable
         renderable->setParent((Qt3DCore::QNode *) 0);
     }
+    for (PoseInstancesRenderable *poseInstancesRenderable : m_poseInstancesRenderables) {
+        poseInstancesRenderable->setParent((Qt3DCore::QNode *) 0);
+        poseInstancesRenderable->deleteLater();
+    }
 
     // Important because for the next clicks this is relevant
     m_selectedPose.reset();
+    m_selectedPoseRenderable = Q_NULLPTR;
+    m_hoveredPose = Q_NULLPTR;
+    m_pressedPoseRenderable = Q_NULLPTR;
     m_poseRenderables.clear();
     m_poseRenderableForId.clear();
+    m_poseRenderableForPickId.clear();
+    m_poseInstancesRenderables.clear();
 
+    // The instances of every object model are uploaded once for all of its poses
+    QMap<QString, QList<PosePtr>> posesOfObjectModels;
     for (const PosePtr &pose : poses) {
-        addPose(pose);
+        addPoseRenderable(pose);
+        posesOfObjectModels[pose->objectModel()->absolutePath()].append(pose);
+    }
+    if (m_instancedRendering) {
+        for (auto posesOfObjectModel = posesOfObjectModels.begin();
+             posesOfObjectModel != posesOfObjectModels.end(); posesOfObjectModel++) {
+            poseInstancesRenderableFor(posesOfObjectModel.value().first())->addPoses(posesOfObjectModel.value());
+        }
     }
+    requestRender();
 }
 
 void PoseViewer3DWidget::addPose(PosePtr pose) {
     // TODO need to add functionality to select the pose if it is a pose
     // that has been added by creating a new pose
-    PoseRenderable *poseRenderable = new PoseRenderable(m_sceneRoot, pose);
+    addPoseRenderable(pose);
+    if (m_instancedRendering) {
+        poseInstancesRenderableFor(pose)->addPose(pose);
+    }
+    requestRender();
+}
+
+PoseInstancesRenderable *PoseViewer3DWidget::poseInstancesRenderableFor(const PosePtr &pose) {
+    const QString objectModelPath = pose->objectModel()->absolutePath();
+    PoseInstancesRenderable *poseInstancesRenderable = m_poseInstancesRenderables.value(objectModelPath);
+    if (!poseInstancesRenderable) {
+        poseInstancesRenderable = new PoseInstancesRenderable(m_sceneRoot, *pose->objectModel());
+        poseInstancesRenderable->setOpacity(m_opacity);
+        m_poseInstancesRenderables[objectModelPath] = poseInstancesRenderable;
+    }
+    return poseInstancesRenderable;
+}
+
+void PoseViewer3DWidget::addPoseRenderable(const PosePtr &pose) {
+    PoseRenderable *poseRenderable = new PoseRenderable(m_sceneRoot, pose, m_instancedRendering);
     m_poseRenderables.append(poseRenderable);
     m_poseRenderableForId[pose->id()] = poseRenderable;
-    connect(poseRenderable, &PoseRenderable::clicked,
-            [poseRenderable, this](Qt3DRender::QPickEvent *e){
-        if (e->button() == m_settings->selectPoseRenderableMouseButton()
-                && !(m_poseRenderableRotated || m_poseRenderableTranslated)) {
-            Q_EMIT poseSelected(poseRenderable->pose());
-        }
-    });
-    connect(poseRenderable, &PoseRenderable::moved,
-            [this, poseRenderable](Qt3DRender::QPickEvent *e){
-        poseRenderable->setHovered(true);
-        m_hoveredPose = poseRenderable;
-        m_mouseOverPoseRenderable = true;
+    poseRenderable->setPickId(m_nextPickId, m_pickLayer);
+    m_poseRenderableForPickId[m_nextPickId] = poseRenderable;
+    m_nextPickId++;
+    // The mesh is loaded asynchronously and the pose might be changed outside of the viewer
+    connect(poseRenderable, &ObjectModelRenderable::statusChanged,
+            this, &PoseViewer3DWidget::requestRender);
+    connect(pose.get(), &Pose::positionChanged, poseRenderable, [this]() {
+        requestRender();
     });
-    // Excited can only be handled in lambdas because
-    // it does not provide a pick event object to retrieve the pose renderable
-    connect(poseRenderable, &PoseRenderable::exited,
-            [this, poseRenderable](){
-        m_mouseOverPoseRenderable = false;
-        poseRenderable->setHovered(false);
-        m_hoveredPose = Q_NULLPTR;
-    });
-    connect(poseRenderable, &PoseRenderable::pressed,
-            [this, poseRenderable](Qt3DRender::QPickEvent *e){
-        // Needs to go here because the released event gets called before the
-        // clicked event and we need this to be true in the clicked event
-        // to prevent deselection when the user rotates or translates a pose
-        m_poseRenderableRotated = false;
-        m_poseRenderableTranslated = false;
-        if (poseRenderable == m_selectedPoseRenderable) {
-            // Simply inform that a pose renderable has been pressed
-            m_poseRenderablePressed = true;
-            // First time the move method is called, we never get to this point when
-            // the background image renderable is moved first (we check that above)
-            m_translationStartVector = e->worldIntersection();
-            m_translationDifference = QVector3D(0, 0, 0);
-            m_translationStart = poseRenderable->transform()->translation();
-            QVector3D pointOnModel = e->localIntersection();
-            QVector3D projected = pointOnModel.project(m_posesCamera->viewMatrix() * poseRenderable->transform()->matrix(),
-                                                       m_projectionMatrix,
-                                                       QRect(0, 0, m_imageSize.width(), m_imageSize.height()));
-            m_depth = projected.z();
-        }
-    });
-    connect(poseRenderable, &PoseRenderable::released,
-            [this](Qt3DRender::QPickEvent *e){
-        m_poseRenderablePressed = false;
+    connect(pose.get(), &Pose::rotationChanged, poseRenderable, [this]() {
+        requestRender();
     });
 }
 
@@ -492,8 +760,29 @@ void PoseViewer3DWidget::removePose(PosePtr pose) {
             // Remove related framegraph
             m_poseRenderables.removeAt(index);
             m_poseRenderableForId.remove(pose->id());
+            m_poseRenderableForPickId.remove(renderable->pickId());
+            if (renderable == m_selectedPoseRenderable) {
+                m_selectedPoseRenderable = Q_NULLPTR;
+            }
+            if (renderable == m_hoveredPose) {
+                m_hoveredPose = Q_NULLPTR;
+            }
+            if (renderable == m_pressedPoseRenderable) {
+                m_pressedPoseRenderable = Q_NULLPTR;
+            }
+            const QString objectModelPath = pose->objectModel()->absolutePath();
+            PoseInstancesRenderable *poseInstancesRenderable = m_poseInstancesRenderables.value(objectModelPath);
+            if (poseInstancesRenderable) {
+                poseInstancesRenderable->removePose(pose);
+                if (poseInstancesRenderable->poseCount() == 0) {
+                    m_poseInstancesRenderables.remove(objectModelPath);
+                    poseInstancesRenderable->setParent((Qt3DCore::QNode *) 0);
+                    poseInstancesRenderable->deleteLater();
+                }
+            }
             // This also deletes the renderable
             renderable->setParent((Qt3DCore::QNode *) 0);
+            requestRender();
             break;
         }
     }
@@ -502,41 +791,50 @@ void PoseViewer3DWidget::removePose(PosePtr pose) {
 void PoseViewer3DWidget::selectPose(PosePtr selected, PosePtr deselected) {
     if (!deselected.isNull()) {
         PoseRenderable *formerSelected = m_poseRenderableForId[deselected->id()];
-        formerSelected->setSelected(false);
+        setPoseRenderableSelected(formerSelected, false);
         m_selectedPoseRenderable = Q_NULLPTR;
     }
     // Check for inequality because otherwise the pose gets selected again
     // (which we don't want, if the same pose is selected again it is deselected)
     if (!selected.isNull() && selected != deselected) {
         PoseRenderable *newSelected = m_poseRenderableForId[selected->id()];
-        newSelected->setSelected(true);
+        setPoseRenderableSelected(newSelected, true);
         m_selectedPoseRenderable = newSelected;
     }
     m_selectedPose = selected;
+    requestRender();
+}
+
+void PoseViewer3DWidget::setPoseRenderableSelected(PoseRenderable *poseRenderable, bool selected) {
+    poseRenderable->setSelected(selected);
+    PoseInstancesRenderable *poseInstancesRenderable =
+            m_poseInstancesRenderables.value(poseRenderable->objectModel()->absolutePath());
+    if (poseInstancesRenderable) {
+        poseInstancesRenderable->setSelected(poseRenderable->pose(), selected);
+    }
+}
+
+void PoseViewer3DWidget::setPoseRenderableHovered(PoseRenderable *poseRenderable, bool hovered) {
+    if (poseRenderable->isHovered() != hovered) {
+        requestRender();
+    }
+    poseRenderable->setHovered(hovered);
+    PoseInstancesRenderable *poseInstancesRenderable =
+            m_poseInstancesRenderables.value(poseRenderable->objectModel()->absolutePath());
+    if (poseInstancesRenderable) {
+        poseInstancesRenderable->setHovered(poseRenderable->pose(), hovered);
+    }
 }
 
 void PoseViewer3DWidget::setSamples(int samples) {
     m_samples = round(qPow(2, (double) samples));
     m_colorTexture->setSamples(m_samples);
     m_depthTexture->setSamples(m_samples);
-    if (m_initialized) {
-        makeCurrent();
-        m_shaderProgram->bind();
-        m_shaderProgram->setUniformValue("samples", m_samples);
-        m_shaderProgram->release();
-        doneCurrent();
-    }
+    requestRender();
 }
 
-void PoseViewer3DWidget::setRenderingSize(int w, int h) {
-    QSize scaledSize = m_imageSize * m_renderingScale;
-    m_colorTexture->setSize(scaledSize.width(), scaledSize.height());
-    m_depthTexture->setSize(scaledSize.width(), scaledSize.height());
-    m_renderSurfaceSelector->setExternalRenderTargetSize(scaledSize);
-    m_clickVisualizationRenderable->setSize(scaledSize);
-    m_clickVisualizationCamera->lens()->setOrthographicProjection(-w / 2.f, w / 2.f,
-                                                                -h / 2.f, h / 2.f,
-                                                                  0.1f, 1000.f);
+void PoseViewer3DWidget::setRenderingSize(int /*w*/, int /*h*/) {
+    updateRenderTargetSize();
 }
 
 QPoint PoseViewer3DWidget::renderingPosition() {
@@ -545,6 +843,7 @@ QPoint PoseViewer3DWidget::renderingPosition() {
 
 void PoseViewer3DWidget::setRenderingPosition(float x, float y) {
     m_renderingPosition = QPoint(x, y);
+    requestRender();
 }
 
 void PoseViewer3DWidget::setRenderingPosition(QPoint position) {
@@ -582,15 +881,7 @@ void PoseViewer3DWidget::setZoom(int zoom) {
     m_zoom = zoom;
     float scale = zoom / 100.f;
     m_renderingScale = scale;
-    m_colorTexture->setSize(m_imageSize.width() * scale, m_imageSize.height() * scale);
-    m_depthTexture->setSize(m_imageSize.width() * scale, m_imageSize.height() * scale);
-    m_renderSurfaceSelector->setExternalRenderTargetSize(QSize(m_imageSize.width() * scale,
-                                                               m_imageSize.height() * scale));
-    m_clickVisualizationRenderable->setSize(m_imageSize * scale);
-    m_clickVisualizationCamera->lens()->setOrthographicProjection(
-                -(m_imageSize.width() * scale) / 2.f, (m_imageSize.width() * scale) / 2.f,
-                -(m_imageSize.height() * scale) / 2.f, (m_imageSize.height() * scale) / 2.f,
-                0.1f, 1000.f);
+    updateRenderTargetSize();
     Q_EMIT zoomChanged(zoom);
 }
 
@@ -633,6 +924,8 @@ int PoseViewer3DWidget::zoom() {
 
 void PoseViewer3DWidget::onSnapshotReady() {
     m_snapshotRenderPassFilter->removeParameter(m_removeHighlightParameter);
+    // Brings back the highlight
+    requestRender();
     m_snapshotRenderCaptureReply->saveImage(m_snapshotPath);
     delete m_snapshotRenderCaptureReply;
     Q_EMIT snapshotSaved();
@@ -644,6 +937,7 @@ void PoseViewer3DWidget::takeSnapshot(const QString &path) {
     m_snapshotRenderCaptureReply = m_snapshotRenderCapture->requestCapture();
     connect(m_snapshotRenderCaptureReply, &Qt3DRender::QRenderCaptureReply::completed,
             this, &PoseViewer3DWidget::onSnapshotReady);
+    requestRender();
 }
 
 void PoseViewer3DWidget::setObjectsOpacity(float opacity) {
@@ -651,6 +945,10 @@ void PoseViewer3DWidget::setObjectsOpacity(float opacity) {
     for (PoseRenderable *poseRenderable : m_poseRenderables) {
         poseRenderable->setOpacity(opacity);
     }
+    for (PoseInstancesRenderable *poseInstancesRenderable : m_poseInstancesRenderables) {
+        poseInstancesRenderable->setOpacity(opacity);
+    }
+    requestRender();
 }
 
 void PoseViewer3DWidget::setAnimatedObjectsOpacity(float opacity) {
@@ -693,6 +991,22 @@ void PoseViewer3DWidget::mousePressEvent(QMouseEvent *event) {
     m_mouseMoved = false;
 
     m_clickedMouseButton = event->button();
+
+    // Reset here and not on release to prevent deselection when the user rotated or translated
+    // the pose, the flags are needed when the button is released
+    m_poseRenderableRotated = false;
+    m_poseRenderableTranslated = false;
+    float depth = 0.f;
+    m_pressedPoseRenderable = poseRenderableAt(event->pos(), depth);
+    if (m_pressedPoseRenderable && m_pressedPoseRenderable == m_selectedPoseRenderable) {
+        // Simply inform that a pose renderable has been pressed
+        m_poseRenderablePressed = true;
+        // The pose is translated in the plane of the pressed point
+        m_depth = depth;
+        m_translationStartVector = unprojectMousePosition(event->pos(), m_depth);
+        m_translationDifference = QVector3D(0, 0, 0);
+        m_translationStart = m_pressedPoseRenderable->transform()->translation();
+    }
 }
 
 // We need to handle translating and rotating of objects here
@@ -724,16 +1038,8 @@ void PoseViewer3DWidget::mouseMoveEvent(QMouseEvent *event) {
         m_mouseCoordinatesModificationEventFilter->setOffset(renderingPosition().x(), renderingPosition().y());
     }
     if (translatingPose) {
-        QPointF pickPosition = mousePosOnImage / (m_zoom / 100.f);
         // Translate the object
-        float posY = m_imageSize.height() - pickPosition.y() - 1.0f;
-
-        m_translationEndVector = QVector3D(pickPosition.x(), posY, m_depth);
-        QVector3D newPos = m_translationEndVector.unproject(m_posesCamera->viewMatrix(),
-                                                            m_projectionMatrix,
-                                                            QRect(0, 0,
-                                                                  m_imageSize.width(),
-                                                                  m_imageSize.height()));
+        QVector3D newPos = unprojectMousePosition(event->pos(), m_depth);
         m_translationDifference = newPos - m_translationStartVector;
         m_translationDifference.setZ(0);
         QVector3D newTranslation = m_translationStart + m_translationDifference;
@@ -764,6 +1070,15 @@ void PoseViewer3DWidget::mouseMoveEvent(QMouseEvent *event) {
         m_poseRenderableRotated = true;
         QApplication::setOverrideCursor(Qt::BlankCursor);
     }
+    if (m_adaptiveResolution && event->buttons() != Qt::NoButton) {
+        // Full resolution again when the mouse button is released
+        setResolutionScale(DRAGGING_RESOLUTION_SCALE);
+    }
+    if (event->buttons() == Qt::NoButton) {
+        // Hovering is not shown while dragging anyways
+        float depth = 0.f;
+        setHoveredPoseRenderable(poseRenderableAt(event->pos(), depth));
+    }
     m_mouseMoved = true;
 }
 
@@ -773,13 +1088,24 @@ void PoseViewer3DWidget::mouseReleaseEvent(QMouseEvent *event) {
         Q_EMIT positionClicked(event->pos() - renderingPosition());
     }
 
+    // Like a click on an object picker, the pose has to be under the cursor on press and release
+    if (m_pressedPoseRenderable && event->button() == m_settings->selectPoseRenderableMouseButton()
+            && !(m_poseRenderableRotated || m_poseRenderableTranslated)) {
+        // Read before restoring the resolution, the ID buffer still has the dragging resolution
+        float depth = 0.f;
+        if (poseRenderableAt(event->pos(), depth) == m_pressedPoseRenderable) {
+            Q_EMIT poseSelected(m_pressedPoseRenderable->pose());
+        }
+    }
+
     QApplication::setOverrideCursor(Qt::ArrowCursor);
 
+    setResolutionScale(1.f);
     m_mouseMoved = false;
     m_poseRenderablePressed = false;
+    m_pressedPoseRenderable = Q_NULLPTR;
     // m_poseRenderableTranslated and rotated get set to false
-    // in the object picker release event because this method
-    // gets called before Qt3D's release event
+    // when the next mouse button is pressed
 
     m_clickedMouseButton = Qt::NoButton;
 }
@@ -808,7 +1134,12 @@ void PoseViewer3DWidget::showEvent(QShowEvent *event) {
         m_root->addComponent(m_frameAction);
         connect(m_frameAction, &Qt3DLogic::QFrameAction::triggered,
                 [this](){
-            this->update();
+            // Qt3D keeps ticking the frame action even if it doesn't render, only present
+            // the frames that might have changed
+            if (m_continuousRendering || m_framesToPresent > 0) {
+                m_framesToPresent = qMax(0, m_framesToPresent - 1);
+                this->update();
+            }
         });
         m_aspectEngine->setRootEntity(Qt3DCore::QEntityPtr(m_root));
 
@@ -835,11 +1166,9 @@ void PoseViewer3DWidget::showEvent(QShowEvent *event) {
 }
 
 void PoseViewer3DWidget::leaveEvent(QEvent *event) {
-    if (m_hoveredPose) {
-        // When the mouse leaves the widget the hovering
-        // color does not get removed
-        m_hoveredPose->setHovered(false);
-    }
+    // When the mouse leaves the widget the hovering
+    // color does not get removed
+    setHoveredPoseRenderable(Q_NULLPTR);
 }
 
 QSize PoseViewer3DWidget::imageSize() const {
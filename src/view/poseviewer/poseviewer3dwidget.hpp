@@ -4,6 +4,7 @@
 #include "model/pose.hpp"
 #include "view/rendering/backgroundimagerenderable.hpp"
 #include "view/rendering/poserenderable.hpp"
+#include "view/rendering/poseinstancesrenderable.hpp"
 #include "view/rendering/clickvisualizationrenderable.hpp"
 #include "mousecoordinatesmodificationeventfilter.hpp"
 #include "undomousecoordinatesmodificationeventfilter.hpp"
@@ -30,6 +31,8 @@
 #include <QOpenGLShader>
 #include <QOpenGLVertexArrayObject>
 #include <QOpenGLBuffer>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLTimerQuery>
 
 #include <Qt3DCore/QAspectEngine>
 #include <Qt3DLogic/QLogicAspect>
@@ -58,6 +61,8 @@
 #include <Qt3DRender/QParameter>
 #include <Qt3DRender/QRenderStateSet>
 #include <Qt3DRender/QFrustumCulling>
+#include <Qt3DRender/QTexture>
+#include <Qt3DRender/QPickEvent>
 
 class PoseViewer3DWidget : public QOpenGLWidget
 {
@@ -137,6 +142,29 @@ private:
     void setupZoomAnimation(int zoom);
     void setupRenderingPositionAnimation(int x, int y);
     void setupRenderingPositionAnimation(QPoint reinderingPosition);
+    // Also update the instanced rendering of the pose, if enabled
+    void setPoseRenderableSelected(PoseRenderable *poseRenderable, bool selected);
+    void setPoseRenderableHovered(PoseRenderable *poseRenderable, bool hovered);
+    void setInstancedRendering(bool instancedRendering);
+    void setContinuousRendering(bool continuousRendering);
+    // Creates the renderable that is drawn or, with instanced rendering, only picked
+    void addPoseRenderable(const PosePtr &pose);
+    // Creates the instanced rendering of the object model of the pose if it doesn't exist yet
+    PoseInstancesRenderable *poseInstancesRenderableFor(const PosePtr &pose);
+    // Presents the next frames, i.e. until Qt3D rendered the change into the offscreen texture
+    void requestRender();
+    // Sizes the offscreen textures after the image, the zoom or the resolution scale changed
+    void updateRenderTargetSize();
+    void setResolutionScale(float resolutionScale);
+    // Blits the multisampled offscreen texture into m_resolvedFramebuffer
+    void resolveColorTexture();
+    // Reads the ID buffer around the position in widget coordinates and returns the pose
+    // renderable closest to it, or null if there is none. The depth is the window depth
+    // of the pose at that pixel, like QVector3D::project returns it.
+    PoseRenderable *poseRenderableAt(const QPoint &position, float &depth);
+    void setHoveredPoseRenderable(PoseRenderable *poseRenderable);
+    // The point on the poses camera's view ray through the position at the given window depth
+    QVector3D unprojectMousePosition(const QPoint &position, float depth);
 
 private:
     PosePtr m_selectedPose;
@@ -147,10 +175,22 @@ private:
     SettingsPtr m_settings;
     QLabel *m_fpsLabel;
     QElapsedTimer m_elapsedTimer;
+    // By default the widget only presents frames after something changed, which leaves the CPU
+    // idle otherwise. Continuous rendering is only useful to profile the rendering.
+    bool m_continuousRendering = false;
+    // Qt3D renders in its own thread, i.e. a change needs a few frames until it is visible
+    static const int FRAMES_TO_PRESENT_AFTER_CHANGE = 3;
+    int m_framesToPresent = 0;
     qint64 m_elapsed = 1;
     float m_avgElapsed = 1.0;
     float m_fpsAlpha = 0.9;
     QTimer m_updateFPSLabelTimer;
+    // GPU time of resolving and drawing the offscreen texture, shown next to the FPS. The result
+    // is read a frame later to not stall the pipeline.
+    QOpenGLTimerQuery m_compositeTimerQuery;
+    bool m_compositeTimerQueryPending = false;
+    float m_compositeTime = 0.f;
+    float m_avgCompositeTime = 0.f;
 
     /*!
      *
@@ -162,6 +202,14 @@ private:
 
     int m_samples = 1;
 
+    // While the user drags the image or a pose, the scene can be rendered at a fraction of the
+    // resolution and is scaled up when drawing the offscreen texture
+    bool m_adaptiveResolution = false;
+    static constexpr float DRAGGING_RESOLUTION_SCALE = 0.5f;
+    float m_resolutionScale = 1.f;
+    // The size of the offscreen textures, i.e. the zoomed image size times the resolution scale
+    QSize m_renderTargetSize;
+
     Qt3DCore::QAspectEngine *m_aspectEngine;
 
     // Aspects
@@ -199,6 +247,9 @@ private:
     bool m_initialized;
 
     QOpenGLShaderProgram *m_shaderProgram;
+    // Read framebuffer the multisampled color texture is attached to for resolving it
+    GLuint m_multisampleFramebuffer = 0;
+    QScopedPointer<QOpenGLFramebufferObject> m_resolvedFramebuffer;
     QOpenGLVertexArrayObject m_vao;
     QOpenGLBuffer m_vbo;
     QVector<GLfloat> m_vertexData;
@@ -220,10 +271,10 @@ private:
      *
      *                                     root
      *                                      |
-     *     -------------------------------------------------------------
-     *     |                  |               |             |          |
-     *  Clear buffers   Draw background   Draw poses   Clear depth   Draw clicks
-     *                      image
+     *     ----------------------------------------------------------------------------
+     *     |                  |               |             |          |              |
+     *  Clear buffers   Draw background   Draw poses   Clear depth   Draw clicks   Draw pick IDs
+     *                      image                                                  (own target)
      *
      */
 
@@ -246,6 +297,26 @@ private:
     Qt3DRender::QNoPicking *m_backgroundNoPicking;
     QPointer<BackgroundImageRenderable> m_backgroundImageRenderable;
 
+    // Poses, i.e. entities of the pick layer, are picked from an ID buffer instead of ray casting
+    // every triangle on the CPU. The branch draws the pick IDs and the depth of the poses into a
+    // float texture of the size of the render target.
+    Qt3DRender::QRenderTargetSelector *m_pickRenderTargetSelector;
+    Qt3DRender::QRenderTarget *m_pickRenderTarget;
+    Qt3DRender::QRenderTargetOutput *m_pickIdOutput;
+    Qt3DRender::QTexture2D *m_pickIdTexture;
+    Qt3DRender::QRenderTargetOutput *m_pickDepthOutput;
+    Qt3DRender::QTexture2D *m_pickDepthTexture;
+    Qt3DRender::QClearBuffers *m_pickClearBuffers;
+    Qt3DRender::QNoDraw *m_pickNoDraw;
+    Qt3DRender::QLayerFilter *m_pickLayerFilter;
+    Qt3DRender::QLayer *m_pickLayer;
+    Qt3DRender::QFrustumCulling *m_pickFrustumCulling;
+    Qt3DRender::QCameraSelector *m_pickCameraSelector;
+    // Read framebuffer the ID texture is attached to for reading back the pixels around the cursor
+    GLuint m_pickFramebuffer = 0;
+    // Pixels read around the cursor in each direction, i.e. poses are found a bit off their edge
+    static const int PICK_RADIUS = 2;
+
     // Poses branch
     Qt3DRender::QLayerFilter *m_posesLayerFilter;
     Qt3DRender::QLayer *m_posesLayer;
@@ -276,6 +347,14 @@ private:
 
     QList<PoseRenderable *> m_poseRenderables;
     QMap<QString, PoseRenderable*> m_poseRenderableForId;
+    // Pick IDs are not reused, i.e. an ID buffer that still shows removed poses can't resolve
+    // to a new pose
+    QMap<int, PoseRenderable*> m_poseRenderableForPickId;
+    int m_nextPickId = 1;
+    // If instanced rendering is enabled, the pose renderables are only used for picking
+    // and the poses are drawn by one instances renderable per object model
+    bool m_instancedRendering = false;
+    QMap<QString, PoseInstancesRenderable*> m_poseInstancesRenderables;
     QMatrix4x4 m_projectionMatrix;
     float m_opacity = 1.0;
     // To animate opacity changes
@@ -305,6 +384,9 @@ private:
     bool m_mouseMoved = false;
     bool m_mouseOverPoseRenderable = false;
     bool m_poseRenderablePressed = false;
+    // The pose renderable under the cursor when the mouse button was pressed, selected if it is
+    // still under the cursor when the button is released
+    PoseRenderable *m_pressedPoseRenderable = Q_NULLPTR;
     bool m_poseRenderableTranslated = false;
     bool m_poseRenderableRotated = false;
 
@@ -318,7 +400,7 @@ private:
     // coordinates on the (potentially) offset image, we need to modify the mouse
     // coordinates to match the local coordinates of the image before passing
     // them on to Qt3D.
-    MouseCoordinatesModificationEventFilter *m_mouseCoordinatesModificationEventFilter;
+    MouseCoordinatesModificationEventFilter *m_mouseCoordinatesModificationEventFilter = Q_NULLPTR;
     // Afterwards we undo the modifications so that our widget receives the normal coordinates.
     // Note that we have to add the undo filter first to get it executed last
     UndoMouseCoordinatesModificationEventFilter *m_undoMouseCoordinatesModificationEventFilter;
@@ -17,8 +17,9 @@ bool UndoMouseCoordinatesModificationEventFilter::eventFilter(QObject *obj, QEve
         event->type() == QEvent::MouseButtonRelease ||
         event->type() == QEvent::MouseButtonDblClick) {
         QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
-        // Undo the offset of the mouse coordinates modificator
-        QPointF offsetPos = mouseEvent->pos() + m_coveringEventFiler->offset();
+        // Undo the offset and scale of the mouse coordinates modificator
+        QPointF offsetPos = mouseEvent->localPos() / m_coveringEventFiler->scale()
+                + QPointF(m_coveringEventFiler->offset());
         mouseEvent->setLocalPos(offsetPos);
         return false;
     } else {
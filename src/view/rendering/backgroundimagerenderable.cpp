@@ -1,4 +1,5 @@
 #include "backgroundimagerenderable.hpp"
+#include "view/rendering/imagecache.hpp"
 
 #include <QUrl>
 #include <QMatrix3x3>
@@ -13,11 +14,15 @@ BackgroundImageRenderable::BackgroundImageRenderable(Qt3DCore::QNode *parent,
     mesh->setHeight(2);
     material = new Qt3DExtras::QTextureMaterial();
     texture = new Qt3DRender::QTexture2D();
-    textureImage = new Qt3DRender::QTextureImage();
-    textureImage->setSource(QUrl::fromLocalFile(image));
-    textureImage->setMirrored(false);
+    textureImage = new DecodedTextureImage();
     texture->addTextureImage(textureImage);
     material->setTexture(texture);
+    connect(texture, &Qt3DRender::QAbstractTexture::statusChanged,
+            [this](Qt3DRender::QAbstractTexture::Status status) {
+        if (status == Qt3DRender::QAbstractTexture::Ready) {
+            Q_EMIT imageLoaded();
+        }
+    });
     transform = new Qt3DCore::QTransform();
     transform->setRotationX(90);
     objectPicker = new Qt3DRender::QObjectPicker();
@@ -45,11 +50,31 @@ BackgroundImageRenderable::BackgroundImageRenderable(Qt3DCore::QNode *parent,
     // errors still remained -> checkout the PoseViewer3DWidget's setup code, there is
     // a QNoPicking node
     //this->addComponent(objectPicker);
+    connect(ImageCache::instance(), &ImageCache::imageLoaded,
+            this, &BackgroundImageRenderable::onImageLoaded);
+    setImage(image);
 }
 
 BackgroundImageRenderable::~BackgroundImageRenderable() {
 }
 
 void BackgroundImageRenderable::setImage(const QString &image) {
-    textureImage->setSource(QUrl::fromLocalFile(image));
+    m_pendingImage = image;
+    QImage decodedImage;
+    if (ImageCache::instance()->find(image, decodedImage)) {
+        textureImage->setImage(decodedImage);
+        Q_EMIT imageLoaded();
+    } else {
+        // Continues in onImageLoaded
+        ImageCache::instance()->load(image);
+    }
+}
+
+void BackgroundImageRenderable::onImageLoaded(const QString &image) {
+    // Results of images that have been replaced in the meantime are dropped
+    QImage decodedImage;
+    if (image == m_pendingImage && ImageCache::instance()->find(image, decodedImage)) {
+        textureImage->setImage(decodedImage);
+        Q_EMIT imageLoaded();
+    }
 }
@@ -2,6 +2,7 @@
 #define BACKGROUNDIMAGERENDERABLE_H
 
 #include "model/image.hpp"
+#include "view/rendering/decodedtextureimage.hpp"
 
 #include <QString>
 #include <QMatrix4x4>
@@ -14,8 +15,14 @@
 #include <Qt3DRender/QTexture>
 #include <Qt3DExtras/QPlaneMesh>
 #include <Qt3DExtras/QTextureMaterial>
-#include <Qt3DRender/QTextureImage>
 
+/*!
+ * \brief The BackgroundImageRenderable class displays the image the poses are annotated on.
+ *
+ * The image is decoded once by the ImageCache and its pixels are handed to Qt3D directly, which
+ * means that setting an image never blocks the GUI thread. Images that have been loaded ahead are
+ * displayed immediately, otherwise the previous image stays visible until the new one is decoded.
+ */
 class BackgroundImageRenderable : public Qt3DCore::QEntity
 {
     Q_OBJECT
@@ -30,13 +37,20 @@ Q_SIGNALS:
     void clicked(Qt3DRender::QPickEvent *pickEvent);
     void moved(Qt3DRender::QPickEvent *pickEvent);
     void pressed(Qt3DRender::QPickEvent *pickEvent);
+    //! Emitted when the image has been decoded and when its texture has been uploaded
+    void imageLoaded();
+
+private Q_SLOTS:
+    void onImageLoaded(const QString &image);
 
 private:
+    //! The image that is being decoded, results of previous images are dropped
+    QString m_pendingImage;
     Qt3DExtras::QPlaneMesh *mesh;
     Qt3DCore::QTransform *transform;
     Qt3DExtras::QTextureMaterial *material;
     Qt3DRender::QTexture2D *texture;
-    Qt3DRender::QTextureImage *textureImage;
+    DecodedTextureImage *textureImage;
     Qt3DRender::QObjectPicker *objectPicker;
 };
 
@@ -0,0 +1,42 @@
+#include "decodedtextureimage.hpp"
+
+DecodedTextureImage::DecodedTextureImage(Qt3DCore::QNode *parent)
+    : Qt3DRender::QAbstractTextureImage(parent) {
+}
+
+QImage DecodedTextureImage::image() const {
+    return m_image;
+}
+
+void DecodedTextureImage::setImage(const QImage &image) {
+    if (image.cacheKey() == m_image.cacheKey()) {
+        return;
+    }
+    m_image = image;
+    notifyDataGeneratorChanged();
+}
+
+Qt3DRender::QTextureImageDataGeneratorPtr DecodedTextureImage::dataGenerator() const {
+    return Qt3DRender::QTextureImageDataGeneratorPtr(new DecodedTextureImageDataGenerator(m_image));
+}
+
+DecodedTextureImageDataGenerator::DecodedTextureImageDataGenerator(const QImage &image)
+    : m_image(image) {
+}
+
+Qt3DRender::QTextureImageDataPtr DecodedTextureImageDataGenerator::operator()() {
+    if (m_image.isNull()) {
+        return Qt3DRender::QTextureImageDataPtr();
+    }
+    Qt3DRender::QTextureImageDataPtr textureImageData =
+            Qt3DRender::QTextureImageDataPtr::create();
+    // Like QTextureImage with mirrored set to false, the first row of the image is uploaded first
+    textureImageData->setImage(m_image);
+    return textureImageData;
+}
+
+bool DecodedTextureImageDataGenerator::operator ==(const Qt3DRender::QTextureImageDataGenerator &other) const {
+    const DecodedTextureImageDataGenerator *otherGenerator =
+            Qt3DRender::functor_cast<DecodedTextureImageDataGenerator>(&other);
+    return otherGenerator && otherGenerator->m_image.cacheKey() == m_image.cacheKey();
+}
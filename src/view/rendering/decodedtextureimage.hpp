@@ -0,0 +1,52 @@
+#ifndef DECODEDTEXTUREIMAGE_H
+#define DECODEDTEXTUREIMAGE_H
+
+#include <QImage>
+
+#include <Qt3DCore/QNode>
+#include <Qt3DRender/QAbstractTextureImage>
+#include <Qt3DRender/QTextureImageDataGenerator>
+
+//!
+//! \brief The DecodedTextureImage class uploads an image that has already been decoded, unlike
+//! QTextureImage which decodes its source file again on Qt3D's side.
+//!
+//! The pixels are shared implicitly with the caller, the conversion to the texture format happens
+//! in Qt3D's threads.
+//!
+class DecodedTextureImage : public Qt3DRender::QAbstractTextureImage
+{
+    Q_OBJECT
+
+public:
+    explicit DecodedTextureImage(Qt3DCore::QNode *parent = Q_NULLPTR);
+
+    QImage image() const;
+    void setImage(const QImage &image);
+
+protected:
+    Qt3DRender::QTextureImageDataGeneratorPtr dataGenerator() const override;
+
+private:
+    QImage m_image;
+};
+
+//!
+//! \brief The DecodedTextureImageDataGenerator class provides the pixels of a DecodedTextureImage
+//! to Qt3D. Generators of the same image compare equal so that it is only uploaded once.
+//!
+class DecodedTextureImageDataGenerator : public Qt3DRender::QTextureImageDataGenerator
+{
+public:
+    explicit DecodedTextureImageDataGenerator(const QImage &image);
+
+    Qt3DRender::QTextureImageDataPtr operator()() override;
+    bool operator ==(const Qt3DRender::QTextureImageDataGenerator &other) const override;
+
+    QT3D_FUNCTOR(DecodedTextureImageDataGenerator)
+
+private:
+    QImage m_image;
+};
+
+#endif // DECODEDTEXTUREIMAGE_H
@@ -0,0 +1,81 @@
+#include "imagecache.hpp"
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <QImageReader>
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+
+ImageCache::ImageCache() {
+    // The displayed image and the one that replaces it
+    m_images.setMaxCost(2);
+}
+
+ImageCache *ImageCache::instance() {
+    static ImageCache imageCache;
+    return &imageCache;
+}
+
+bool ImageCache::find(const QString &path, QImage &image) {
+    Entry *entry = m_images.object(path);
+    if (!entry) {
+        return false;
+    }
+    QFileInfo file(path);
+    if (file.size() != entry->fileSize
+            || file.lastModified().toMSecsSinceEpoch() != entry->fileLastModified) {
+        m_images.remove(path);
+        return false;
+    }
+    image = entry->image;
+    return true;
+}
+
+bool ImageCache::isLoading(const QString &path) const {
+    return m_loading.contains(path);
+}
+
+void ImageCache::load(const QString &path) {
+    QImage image;
+    if (m_loading.contains(path) || find(path, image)) {
+        return;
+    }
+    m_loading.insert(path);
+    QFutureWatcher<Entry> *watcher = new QFutureWatcher<Entry>(this);
+    connect(watcher, &QFutureWatcher<Entry>::finished, this, [this, watcher, path]() {
+        watcher->deleteLater();
+        m_loading.remove(path);
+        const Entry entry = watcher->result();
+        if (!entry.image.isNull()) {
+            m_images.insert(path, new Entry(entry));
+        }
+        Q_EMIT imageLoaded(path);
+    });
+    watcher->setFuture(QtConcurrent::run(&ImageCache::decodeImage, path));
+}
+
+int ImageCache::maxImages() const {
+    return m_images.maxCost();
+}
+
+void ImageCache::setMaxImages(int maxImages) {
+    m_images.setMaxCost(qMax(2, maxImages));
+}
+
+ImageCache::Entry ImageCache::decodeImage(const QString &path) {
+    Entry entry;
+    // Taken before decoding, i.e. changes while decoding lead to decoding the file again
+    QFileInfo file(path);
+    entry.fileSize = file.size();
+    entry.fileLastModified = file.lastModified().toMSecsSinceEpoch();
+    QImageReader imageReader(path);
+    QImage image = imageReader.read();
+    if (image.isNull()) {
+        qDebug() << "Could not decode image" << path << ":" << imageReader.errorString();
+        return entry;
+    }
+    // Qt3D uploads RGBA8888 anyways, converting it here keeps the conversion off its threads
+    entry.image = image.convertToFormat(QImage::Format_RGBA8888);
+    return entry;
+}
@@ -0,0 +1,58 @@
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QImage>
+#include <QCache>
+#include <QSet>
+
+/*!
+ * \brief The ImageCache class holds the decoded background images of the pose viewer, i.e. the
+ * selected image and the images that have been loaded ahead of the selection.
+ *
+ * Images are decoded on the global thread pool. The cache is limited to a number of images and
+ * evicts the least recently used ones when exceeding it. Images are keyed by their absolute path
+ * and decoded again once the size or modification date of their file changes.
+ */
+class ImageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ImageCache *instance();
+
+    /*!
+     * \brief find looks up the decoded image and marks it as most recently used.
+     * \return true if the image is decoded and up to date with its file
+     */
+    bool find(const QString &path, QImage &image);
+
+    bool isLoading(const QString &path) const;
+
+    //! Decodes the image in the background if it is neither cached nor being decoded already
+    void load(const QString &path);
+
+    int maxImages() const;
+    void setMaxImages(int maxImages);
+
+Q_SIGNALS:
+    //! Emitted when decoding the image finished, also if it failed
+    void imageLoaded(const QString &path);
+
+private:
+    struct Entry {
+        QImage image;
+        qint64 fileSize = -1;
+        qint64 fileLastModified = -1;
+    };
+
+    ImageCache();
+    static Entry decodeImage(const QString &path);
+
+private:
+    QCache<QString, Entry> m_images;
+    QSet<QString> m_loading;
+};
+
+#endif // IMAGECACHE_H
@@ -0,0 +1,429 @@
+#include "meshcache.hpp"
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
+
+#include <Qt3DCore/QEntity>
+#include <Qt3DCore/QTransform>
+#include <Qt3DRender/QBuffer>
+#include <Qt3DRender/QGeometry>
+#include <Qt3DRender/QMaterial>
+#include <Qt3DRender/QTexture>
+#include <Qt3DRender/QTextureImage>
+
+//! Far more than the object models of usual datasets, bounds long sessions with many scans
+static const qint64 DEFAULT_MAX_BYTES = 512 * 1024 * 1024;
+
+qint64 MeshCache::Mesh::bytes() const {
+    qint64 bytes = 0;
+    for (const QByteArray &buffer : buffers) {
+        bytes += buffer.size();
+    }
+    return bytes;
+}
+
+MeshCache::MeshCache()
+    : m_maxBytes(DEFAULT_MAX_BYTES) {
+}
+
+MeshCache *MeshCache::instance() {
+    static MeshCache meshCache;
+    return &meshCache;
+}
+
+MeshCache::Status MeshCache::status(const QString &path) {
+    auto mesh = m_meshes.find(path);
+    if (mesh == m_meshes.end()) {
+        return NotLoaded;
+    }
+    if (mesh->status == Loading) {
+        return Loading;
+    }
+    QFileInfo file(path);
+    if (file.size() != mesh->fileSize
+            || file.lastModified().toMSecsSinceEpoch() != mesh->fileLastModified) {
+        // The file changed since it has been loaded, the scenes keep displaying the old version
+        // until their renderables load the mesh again
+        removeSceneMeshes(path);
+        m_meshes.erase(mesh);
+        return NotLoaded;
+    }
+    return mesh->status;
+}
+
+bool MeshCache::load(const QString &path) {
+    auto mesh = m_meshes.constFind(path);
+    if (!MeshLoader::canLoad(path) || (mesh != m_meshes.constEnd() && mesh->loaderFailed)) {
+        return false;
+    }
+    setLoading(path);
+    QFutureWatcher<MeshLoader::Mesh> *watcher = new QFutureWatcher<MeshLoader::Mesh>(this);
+    connect(watcher, &QFutureWatcher<MeshLoader::Mesh>::finished, this, [this, watcher, path]() {
+        watcher->deleteLater();
+        insert(path, watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run(&MeshLoader::load, path));
+    return true;
+}
+
+void MeshCache::setLoading(const QString &path) {
+    // Taken before loading, i.e. changes while loading lead to loading the file again
+    QFileInfo file(path);
+    Mesh mesh;
+    mesh.status = Loading;
+    mesh.fileSize = file.size();
+    mesh.fileLastModified = file.lastModified().toMSecsSinceEpoch();
+    m_meshes.insert(path, mesh);
+}
+
+void MeshCache::insert(const QString &path, Qt3DRender::QSceneLoader *sceneLoader) {
+    Mesh &mesh = m_meshes[path];
+    mesh.buffers.clear();
+    mesh.parts.clear();
+    if (!sceneLoader->entities().isEmpty()) {
+        QHash<Qt3DRender::QBuffer*, int> buffers;
+        extractParts(mesh, sceneLoader->entities()[0], QMatrix4x4(), buffers);
+    }
+    removeSceneMeshes(path);
+    mesh.status = mesh.parts.isEmpty() ? Failed : Loaded;
+    mesh.lastUsed = ++m_useCounter;
+    Q_EMIT meshLoaded(path);
+    evict();
+}
+
+void MeshCache::insert(const QString &path, const MeshLoader::Mesh &loadedMesh) {
+    Mesh &mesh = m_meshes[path];
+    mesh.buffers.clear();
+    mesh.parts.clear();
+    removeSceneMeshes(path);
+    if (!loadedMesh.valid) {
+        qDebug() << "Could not parse" << path << "natively, loading it with Assimp:" << loadedMesh.errorString;
+        // The renderables load it with a QSceneLoader now
+        mesh.status = NotLoaded;
+        mesh.loaderFailed = true;
+        Q_EMIT meshLoaded(path);
+        return;
+    }
+
+    mesh.buffers.append(loadedMesh.vertexData);
+    mesh.buffers.append(loadedMesh.indexData);
+    const uint byteStride = loadedMesh.byteStride();
+    const uint vertexCount = loadedMesh.vertexCount;
+    QVector<Attribute> vertexAttributes;
+    vertexAttributes.append({Qt3DRender::QAttribute::defaultPositionAttributeName(),
+                             Qt3DRender::QAttribute::VertexAttribute, Qt3DRender::QAttribute::Float,
+                             3, vertexCount, byteStride, 0, 0});
+    vertexAttributes.append({Qt3DRender::QAttribute::defaultNormalAttributeName(),
+                             Qt3DRender::QAttribute::VertexAttribute, Qt3DRender::QAttribute::Float,
+                             3, vertexCount, byteStride, 3 * sizeof(float), 0});
+    if (loadedMesh.hasTexCoords) {
+        vertexAttributes.append({Qt3DRender::QAttribute::defaultTextureCoordinateAttributeName(),
+                                 Qt3DRender::QAttribute::VertexAttribute, Qt3DRender::QAttribute::Float,
+                                 2, vertexCount, byteStride, 6 * sizeof(float), 0});
+    }
+    for (const MeshLoader::Part &loadedPart : loadedMesh.parts) {
+        MeshPart part;
+        part.attributes = vertexAttributes;
+        part.attributes.append({QString(), Qt3DRender::QAttribute::IndexAttribute,
+                                Qt3DRender::QAttribute::UnsignedInt, 1, (uint) loadedPart.indexCount,
+                                0, (uint) (loadedPart.firstIndex * sizeof(quint32)), 1});
+        part.primitiveType = Qt3DRender::QGeometryRenderer::Triangles;
+        part.vertexCount = loadedPart.indexCount;
+        part.indexOffset = 0;
+        part.firstVertex = 0;
+        part.material.ambient = loadedPart.ambient;
+        part.material.specular = loadedPart.specular;
+        if (!loadedPart.diffuseTexturePath.isEmpty()) {
+            part.material.textured = true;
+            part.diffuseTexture.source = QUrl::fromLocalFile(loadedPart.diffuseTexturePath);
+            // The texture coordinates of OBJ and PLY files start at the bottom of the image
+            part.diffuseTexture.mirrored = true;
+            part.diffuseTexture.minificationFilter = Qt3DRender::QAbstractTexture::Linear;
+            part.diffuseTexture.magnificationFilter = Qt3DRender::QAbstractTexture::Linear;
+            part.diffuseTexture.wrapMode = Qt3DRender::QTextureWrapMode::Repeat;
+        }
+        mesh.parts.append(part);
+    }
+    mesh.status = Loaded;
+    mesh.lastUsed = ++m_useCounter;
+    // The waiting renderables take their references first, i.e. the mesh isn't evicted right away
+    Q_EMIT meshLoaded(path);
+    evict();
+}
+
+void MeshCache::setFailed(const QString &path) {
+    // Not loaded again before the file changes
+    m_meshes[path].status = Failed;
+    Q_EMIT meshLoaded(path);
+}
+
+void MeshCache::abort(const QString &path) {
+    auto mesh = m_meshes.find(path);
+    if (mesh != m_meshes.end() && mesh->status == Loading) {
+        m_meshes.erase(mesh);
+        Q_EMIT meshLoaded(path);
+    }
+}
+
+void MeshCache::extractParts(Mesh &mesh, Qt3DCore::QNode *node, const QMatrix4x4 &parentTransform,
+                             QHash<Qt3DRender::QBuffer*, int> &buffers) {
+    QMatrix4x4 transform = parentTransform;
+    Qt3DCore::QEntity *entity = qobject_cast<Qt3DCore::QEntity*>(node);
+    if (entity) {
+        QVector<Qt3DCore::QTransform*> transforms = entity->componentsOfType<Qt3DCore::QTransform>();
+        if (!transforms.isEmpty()) {
+            transform = transform * transforms.first()->matrix();
+        }
+        QVector<Qt3DRender::QGeometryRenderer*> geometryRenderers =
+                entity->componentsOfType<Qt3DRender::QGeometryRenderer>();
+        if (!geometryRenderers.isEmpty() && geometryRenderers.first()->geometry()) {
+            Qt3DRender::QGeometryRenderer *geometryRenderer = geometryRenderers.first();
+            MeshPart part;
+            part.primitiveType = geometryRenderer->primitiveType();
+            part.vertexCount = geometryRenderer->vertexCount();
+            part.indexOffset = geometryRenderer->indexOffset();
+            part.firstVertex = geometryRenderer->firstVertex();
+            part.transform = transform;
+            for (Qt3DRender::QAttribute *attribute : geometryRenderer->geometry()->attributes()) {
+                Qt3DRender::QBuffer *buffer = attribute->buffer();
+                if (!buffer) {
+                    continue;
+                }
+                // Parts usually share their buffers
+                int bufferIndex = buffers.value(buffer, -1);
+                if (bufferIndex == -1) {
+                    bufferIndex = mesh.buffers.size();
+                    mesh.buffers.append(buffer->data());
+                    buffers.insert(buffer, bufferIndex);
+                }
+                part.attributes.append({attribute->name(), attribute->attributeType(),
+                                        attribute->vertexBaseType(), attribute->vertexSize(),
+                                        attribute->count(), attribute->byteStride(),
+                                        attribute->byteOffset(), bufferIndex});
+            }
+
+            QVector<Qt3DRender::QMaterial*> materials = entity->componentsOfType<Qt3DRender::QMaterial>();
+            if (!materials.isEmpty()) {
+                // The materials of the scene loader only differ in their properties, the renderables
+                // replace them with their own material anyways
+                Qt3DRender::QMaterial *material = materials.first();
+                part.material.ambient = material->property("ambient").value<QColor>();
+                part.material.specular = material->property("specular").value<QColor>();
+                QVariant textureScale = material->property("textureScale");
+                if (textureScale.isValid()) {
+                    part.material.textureScale = textureScale.toFloat();
+                }
+                // Is a color for the materials without texture
+                Qt3DRender::QAbstractTexture *texture =
+                        material->property("diffuse").value<Qt3DRender::QAbstractTexture*>();
+                if (texture) {
+                    for (Qt3DRender::QAbstractTextureImage *image : texture->textureImages()) {
+                        if (Qt3DRender::QTextureImage *textureImage = qobject_cast<Qt3DRender::QTextureImage*>(image)) {
+                            part.diffuseTexture.source = textureImage->source();
+                            part.diffuseTexture.mirrored = textureImage->isMirrored();
+                        }
+                    }
+                    if (Qt3DRender::QTextureLoader *textureLoader = qobject_cast<Qt3DRender::QTextureLoader*>(texture)) {
+                        part.diffuseTexture.source = textureLoader->source();
+                        part.diffuseTexture.mirrored = textureLoader->isMirrored();
+                    }
+                    part.diffuseTexture.minificationFilter = texture->minificationFilter();
+                    part.diffuseTexture.magnificationFilter = texture->magnificationFilter();
+                    part.diffuseTexture.wrapMode = texture->wrapMode()->x();
+                    part.material.textured = !part.diffuseTexture.source.isEmpty();
+                }
+            }
+            mesh.parts.append(part);
+        }
+    }
+    for (Qt3DCore::QNode *child : node->childNodes()) {
+        extractParts(mesh, child, transform, buffers);
+    }
+}
+
+QVector<MeshCache::Part> MeshCache::parts(const QString &path, Qt3DCore::QNode *node) {
+    QVector<Part> parts;
+    auto mesh = m_meshes.find(path);
+    if (mesh == m_meshes.end() || mesh->status != Loaded) {
+        return parts;
+    }
+    mesh->lastUsed = ++m_useCounter;
+
+    Qt3DCore::QNode *root = node;
+    while (root->parentNode()) {
+        root = root->parentNode();
+    }
+    if (!m_sceneMeshes.contains(root)) {
+        // The nodes are deleted with the root, the users are released afterwards
+        connect(root, &QObject::destroyed, this, [this, root]() {
+            m_sceneMeshes.remove(root);
+            m_outdatedSceneMeshes.remove(root);
+        });
+    }
+    QHash<QString, SceneMesh> &sceneMeshes = m_sceneMeshes[root];
+    auto sceneMesh = sceneMeshes.find(path);
+    if (sceneMesh == sceneMeshes.end()) {
+        sceneMesh = sceneMeshes.insert(path, createSceneMesh(*mesh, root));
+    }
+    if (!sceneMesh->users.contains(node)) {
+        // Only the address is used once the node is destroyed
+        sceneMesh->users.insert(node, connect(node, &QObject::destroyed, this, [this, path, node]() {
+            release(path, node);
+        }));
+    }
+
+    for (int i = 0; i < mesh->parts.size(); i++) {
+        parts.append({sceneMesh->geometryRenderers[i], sceneMesh->diffuseTextures[i],
+                      mesh->parts[i].material, mesh->parts[i].transform});
+    }
+    return parts;
+}
+
+void MeshCache::release(const QString &path, Qt3DCore::QNode *node) {
+    // There are only a few scenes, i.e. searching them is cheaper than keeping track of the roots
+    for (auto sceneMeshes = m_sceneMeshes.begin(); sceneMeshes != m_sceneMeshes.end(); sceneMeshes++) {
+        auto sceneMesh = sceneMeshes->find(path);
+        if (sceneMesh != sceneMeshes->end() && sceneMesh->users.contains(node)) {
+            disconnect(sceneMesh->users.take(node));
+            if (sceneMesh->users.isEmpty()) {
+                deleteSceneMesh(*sceneMesh);
+                sceneMeshes->erase(sceneMesh);
+                // Not displayed in this scene anymore, i.e. the mesh might be evicted now
+                evict();
+            }
+            return;
+        }
+    }
+    for (auto sceneMeshes = m_outdatedSceneMeshes.begin(); sceneMeshes != m_outdatedSceneMeshes.end(); sceneMeshes++) {
+        for (auto sceneMesh = sceneMeshes->find(path);
+             sceneMesh != sceneMeshes->end() && sceneMesh.key() == path; sceneMesh++) {
+            if (sceneMesh->users.contains(node)) {
+                disconnect(sceneMesh->users.take(node));
+                if (sceneMesh->users.isEmpty()) {
+                    deleteSceneMesh(*sceneMesh);
+                    sceneMeshes->erase(sceneMesh);
+                }
+                return;
+            }
+        }
+    }
+}
+
+qint64 MeshCache::maxBytes() const {
+    return m_maxBytes;
+}
+
+void MeshCache::setMaxBytes(qint64 maxBytes) {
+    m_maxBytes = maxBytes;
+    evict();
+}
+
+MeshCache::SceneMesh MeshCache::createSceneMesh(const Mesh &mesh, Qt3DCore::QNode *root) {
+    SceneMesh sceneMesh;
+    // Everything is parented to the root to outlive the entities, it is deleted with the last
+    // reference or with the scene
+    QVector<Qt3DRender::QBuffer*> buffers;
+    for (const QByteArray &data : mesh.buffers) {
+        Qt3DRender::QBuffer *buffer = new Qt3DRender::QBuffer(root);
+        buffer->setData(data);
+        buffers.append(buffer);
+        sceneMesh.nodes.append(buffer);
+    }
+    for (const MeshPart &part : mesh.parts) {
+        Qt3DRender::QGeometry *geometry = new Qt3DRender::QGeometry(root);
+        sceneMesh.nodes.append(geometry);
+        for (const Attribute &partAttribute : part.attributes) {
+            Qt3DRender::QAttribute *attribute = new Qt3DRender::QAttribute(geometry);
+            attribute->setName(partAttribute.name);
+            attribute->setAttributeType(partAttribute.attributeType);
+            attribute->setVertexBaseType(partAttribute.vertexBaseType);
+            attribute->setVertexSize(partAttribute.vertexSize);
+            attribute->setCount(partAttribute.count);
+            attribute->setByteStride(partAttribute.byteStride);
+            attribute->setByteOffset(partAttribute.byteOffset);
+            attribute->setBuffer(buffers[partAttribute.buffer]);
+            geometry->addAttribute(attribute);
+        }
+        Qt3DRender::QGeometryRenderer *geometryRenderer = new Qt3DRender::QGeometryRenderer(root);
+        geometryRenderer->setGeometry(geometry);
+        geometryRenderer->setPrimitiveType(part.primitiveType);
+        geometryRenderer->setVertexCount(part.vertexCount);
+        geometryRenderer->setIndexOffset(part.indexOffset);
+        geometryRenderer->setFirstVertex(part.firstVertex);
+        sceneMesh.geometryRenderers.append(geometryRenderer);
+        sceneMesh.nodes.append(geometryRenderer);
+
+        Qt3DRender::QAbstractTexture *diffuseTexture = Q_NULLPTR;
+        if (part.material.textured) {
+            Qt3DRender::QTexture2D *texture = new Qt3DRender::QTexture2D(root);
+            Qt3DRender::QTextureImage *textureImage = new Qt3DRender::QTextureImage(texture);
+            textureImage->setSource(part.diffuseTexture.source);
+            textureImage->setMirrored(part.diffuseTexture.mirrored);
+            texture->addTextureImage(textureImage);
+            texture->setMinificationFilter(part.diffuseTexture.minificationFilter);
+            texture->setMagnificationFilter(part.diffuseTexture.magnificationFilter);
+            texture->wrapMode()->setX(part.diffuseTexture.wrapMode);
+            texture->wrapMode()->setY(part.diffuseTexture.wrapMode);
+            diffuseTexture = texture;
+            sceneMesh.nodes.append(texture);
+        }
+        sceneMesh.diffuseTextures.append(diffuseTexture);
+    }
+    return sceneMesh;
+}
+
+void MeshCache::deleteSceneMesh(SceneMesh &sceneMesh) {
+    for (const QPointer<Qt3DCore::QNode> &node : sceneMesh.nodes) {
+        if (node) {
+            node->setParent((Qt3DCore::QNode *) 0);
+            node->deleteLater();
+        }
+    }
+    sceneMesh.nodes.clear();
+}
+
+void MeshCache::removeSceneMeshes(const QString &path) {
+    for (auto sceneMeshes = m_sceneMeshes.begin(); sceneMeshes != m_sceneMeshes.end(); sceneMeshes++) {
+        auto sceneMesh = sceneMeshes->find(path);
+        if (sceneMesh != sceneMeshes->end()) {
+            // The users keep displaying the outdated nodes until they load the mesh again
+            m_outdatedSceneMeshes[sceneMeshes.key()].insert(path, *sceneMesh);
+            sceneMeshes->erase(sceneMesh);
+        }
+    }
+}
+
+bool MeshCache::isDisplayed(const QString &path) const {
+    for (const QHash<QString, SceneMesh> &sceneMeshes : m_sceneMeshes) {
+        if (sceneMeshes.contains(path)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MeshCache::evict() {
+    qint64 bytes = 0;
+    for (const Mesh &mesh : m_meshes) {
+        bytes += mesh.bytes();
+    }
+    while (bytes > m_maxBytes) {
+        auto leastRecentlyUsed = m_meshes.end();
+        for (auto mesh = m_meshes.begin(); mesh != m_meshes.end(); mesh++) {
+            // The most recently used mesh is kept even if it exceeds the limit on its own
+            if (mesh->status == Loaded && mesh->lastUsed != m_useCounter && !isDisplayed(mesh.key())
+                    && (leastRecentlyUsed == m_meshes.end() || mesh->lastUsed < leastRecentlyUsed->lastUsed)) {
+                leastRecentlyUsed = mesh;
+            }
+        }
+        if (leastRecentlyUsed == m_meshes.end()) {
+            // All remaining meshes are displayed
+            return;
+        }
+        bytes -= leastRecentlyUsed->bytes();
+        m_meshes.erase(leastRecentlyUsed);
+    }
+}
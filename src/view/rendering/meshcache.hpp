@@ -0,0 +1,189 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include "view/rendering/meshloader.hpp"
+
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <QColor>
+#include <QHash>
+#include <QVector>
+#include <QPointer>
+#include <QByteArray>
+#include <QMatrix4x4>
+
+#include <Qt3DCore/QNode>
+#include <Qt3DRender/QAttribute>
+#include <Qt3DRender/QAbstractTexture>
+#include <Qt3DRender/QGeometryRenderer>
+#include <Qt3DRender/QSceneLoader>
+#include <Qt3DRender/QTextureWrapMode>
+
+/*!
+ * \brief The MeshCache class makes sure that every mesh file is only parsed once per process and
+ * only uploaded once per scene, no matter how many ObjectModelRenderables display it.
+ *
+ * PLY and OBJ files are parsed by the MeshLoader in the background when a renderable first needs
+ * them. Other formats, and files the MeshLoader fails on, are loaded by the first renderable with a
+ * QSceneLoader, which hands the loaded scene to the cache. The cache keeps the vertex data and the
+ * materials of all parts of the mesh. All other renderables wait for the meshLoaded signal instead
+ * of loading the file themselves.
+ *
+ * Qt3D nodes can't be shared across aspect engines, which is why the geometry renderers and
+ * textures are created once per scene, i.e. per root node. They are parented to the root and shared
+ * by all entities of that scene. Every node that obtains the parts holds a reference on them until
+ * it releases them or is destroyed, the nodes are deleted with the last reference. The vertex data
+ * itself is shared by all scenes.
+ *
+ * Meshes are keyed by the absolute path of the object model. A mesh is loaded again once the size
+ * or modification date of its file changes. The vertex data of meshes that no scene displays is
+ * evicted least recently used first once all meshes exceed the maximum number of bytes.
+ */
+class MeshCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Status {
+        NotLoaded,
+        Loading,
+        Loaded,
+        Failed
+    };
+
+    struct Material {
+        bool textured = false;
+        QColor ambient;
+        QColor specular;
+        float textureScale = 1.f;
+    };
+
+    //! A part of a mesh as it has to be added to an entity of a certain scene
+    struct Part {
+        Qt3DRender::QGeometryRenderer *geometryRenderer;
+        //! Null if the part is not textured
+        Qt3DRender::QAbstractTexture *diffuseTexture;
+        Material material;
+        QMatrix4x4 transform;
+    };
+
+    static MeshCache *instance();
+
+    Status status(const QString &path);
+
+    /*!
+     * \brief load parses the mesh in the background with the MeshLoader, meshLoaded is emitted
+     * once it is done.
+     * \return false if the MeshLoader can't load the file, it has to be loaded with a QSceneLoader
+     */
+    bool load(const QString &path);
+
+    //! Marks the mesh as loading, i.e. the caller has to call insert, setFailed or abort afterwards
+    void setLoading(const QString &path);
+
+    //! Takes the vertex data and materials of the scene, which is not needed afterwards anymore
+    void insert(const QString &path, Qt3DRender::QSceneLoader *sceneLoader);
+
+    void setFailed(const QString &path);
+
+    //! The caller doesn't load the mesh anymore, a renderable that still waits for it has to load it
+    void abort(const QString &path);
+
+    /*!
+     * \brief parts returns the parts of the loaded mesh for the scene of the given node. The node
+     * holds a reference on the parts afterwards, which is released by release or its destruction.
+     * \return an empty list if the mesh is not loaded
+     */
+    QVector<Part> parts(const QString &path, Qt3DCore::QNode *node);
+
+    //! Releases the reference of the node on the parts of the mesh
+    void release(const QString &path, Qt3DCore::QNode *node);
+
+    //! The bytes the vertex data of all meshes may take up, meshes that are displayed are never evicted
+    qint64 maxBytes() const;
+    void setMaxBytes(qint64 maxBytes);
+
+Q_SIGNALS:
+    //! Emitted when the status of the mesh is not Loading anymore
+    void meshLoaded(const QString &path);
+
+private:
+    struct Attribute {
+        QString name;
+        Qt3DRender::QAttribute::AttributeType attributeType;
+        Qt3DRender::QAttribute::VertexBaseType vertexBaseType;
+        uint vertexSize;
+        uint count;
+        uint byteStride;
+        uint byteOffset;
+        //! Index into the buffers of the mesh
+        int buffer;
+    };
+
+    struct Texture {
+        QUrl source;
+        bool mirrored = true;
+        Qt3DRender::QAbstractTexture::Filter minificationFilter = Qt3DRender::QAbstractTexture::Nearest;
+        Qt3DRender::QAbstractTexture::Filter magnificationFilter = Qt3DRender::QAbstractTexture::Nearest;
+        Qt3DRender::QTextureWrapMode::WrapMode wrapMode = Qt3DRender::QTextureWrapMode::ClampToEdge;
+    };
+
+    struct MeshPart {
+        QVector<Attribute> attributes;
+        Qt3DRender::QGeometryRenderer::PrimitiveType primitiveType;
+        int vertexCount;
+        int indexOffset;
+        int firstVertex;
+        Material material;
+        Texture diffuseTexture;
+        QMatrix4x4 transform;
+    };
+
+    struct Mesh {
+        Status status = NotLoaded;
+        qint64 fileSize = -1;
+        qint64 fileLastModified = -1;
+        //! The raw buffers, implicitly shared with the buffers of all scenes
+        QVector<QByteArray> buffers;
+        QVector<MeshPart> parts;
+        //! Set if the MeshLoader failed on the file, it is loaded with a QSceneLoader then
+        bool loaderFailed = false;
+        //! The value of the use counter of the cache when the mesh has been used the last time
+        quint64 lastUsed = 0;
+
+        qint64 bytes() const;
+    };
+
+    //! The nodes of a mesh in one scene
+    struct SceneMesh {
+        QVector<Qt3DRender::QGeometryRenderer*> geometryRenderers;
+        QVector<Qt3DRender::QAbstractTexture*> diffuseTextures;
+        //! All nodes parented to the root, i.e. the ones to delete with the last reference
+        QVector<QPointer<Qt3DCore::QNode>> nodes;
+        //! The nodes that hold a reference, with the connection that releases it on their destruction
+        QHash<Qt3DCore::QNode*, QMetaObject::Connection> users;
+    };
+
+    MeshCache();
+    void insert(const QString &path, const MeshLoader::Mesh &loadedMesh);
+    void extractParts(Mesh &mesh, Qt3DCore::QNode *node, const QMatrix4x4 &transform,
+                      QHash<Qt3DRender::QBuffer*, int> &buffers);
+    SceneMesh createSceneMesh(const Mesh &mesh, Qt3DCore::QNode *root);
+    static void deleteSceneMesh(SceneMesh &sceneMesh);
+    //! The scene meshes of the path are kept by their users until they release them
+    void removeSceneMeshes(const QString &path);
+    bool isDisplayed(const QString &path) const;
+    //! Evicts the least recently used meshes that aren't displayed until the limit is met
+    void evict();
+
+private:
+    QHash<QString, Mesh> m_meshes;
+    QHash<Qt3DCore::QNode*, QHash<QString, SceneMesh>> m_sceneMeshes;
+    //! Scene meshes of outdated meshes that are still in use
+    QHash<Qt3DCore::QNode*, QMultiHash<QString, SceneMesh>> m_outdatedSceneMeshes;
+    qint64 m_maxBytes;
+    quint64 m_useCounter = 0;
+};
+
+#endif // MESHCACHE_H
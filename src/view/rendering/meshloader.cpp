@@ -0,0 +1,1292 @@
+#include "meshloader.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QList>
+#include <QThread>
+#include <QVarLengthArray>
+#include <QVector3D>
+#include <QtEndian>
+#include <QtConcurrent/QtConcurrent>
+
+#include <cmath>
+#include <cstring>
+
+struct MeshLoader::Geometry {
+    //! Three floats per position and normal, two per texture coordinate
+    QVector<float> positions;
+    QVector<float> normals;
+    QVector<float> texCoords;
+    //! The vertices reference their attributes through these indices, -1 if a vertex doesn't have
+    //! the attribute. If one of them is empty, the attribute is indexed by the vertex directly.
+    QVector<int> vertexPositions;
+    QVector<int> vertexNormals;
+    QVector<int> vertexTexCoords;
+    int vertexCount = 0;
+    QVector<quint32> indices;
+    QVector<Part> parts;
+};
+
+namespace {
+
+//! Files and meshes below these sizes are parsed by one thread, splitting them up costs more
+//! than it saves
+const qint64 MIN_RECORDS_PER_CHUNK = 1 << 15;
+const qint64 MIN_BYTES_PER_CHUNK = 1 << 20;
+//! Keeps the interleaved vertex buffer below the size limit of QByteArray
+const qint64 MAX_VERTEX_COUNT = 1 << 25;
+
+int chunkCountFor(qint64 count, qint64 minPerChunk) {
+    return (int) qBound((qint64) 1, count / minPerChunk, (qint64) QThread::idealThreadCount() * 4);
+}
+
+//! Calls function(chunk) for every chunk on the global thread pool and blocks until all are done
+template<typename Function>
+void forEachChunk(int chunkCount, const Function &function) {
+    if (chunkCount == 1) {
+        function(0);
+        return;
+    }
+    QVector<int> chunks;
+    for (int chunk = 0; chunk < chunkCount; chunk++) {
+        chunks.append(chunk);
+    }
+    QtConcurrent::blockingMap(chunks, [&function](int &chunk) {
+        function(chunk);
+    });
+}
+
+//! Calls function(begin, end) for consecutive ranges of [0, count) in parallel
+template<typename Function>
+void parallelFor(int count, const Function &function) {
+    const int chunkCount = chunkCountFor(count, MIN_RECORDS_PER_CHUNK);
+    forEachChunk(chunkCount, [count, chunkCount, &function](int chunk) {
+        function((int) ((qint64) count * chunk / chunkCount),
+                 (int) ((qint64) count * (chunk + 1) / chunkCount));
+    });
+}
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline void skipSpaces(const char *&p, const char *end) {
+    while (p < end && isSpace(*p)) {
+        p++;
+    }
+}
+
+inline const char *findLineEnd(const char *p, const char *end) {
+    const char *lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+    return lineEnd ? lineEnd : end;
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool parseInteger(const char *&p, const char *end, qint64 &value) {
+    skipSpaces(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end || !isDigit(*p)) {
+        return false;
+    }
+    value = 0;
+    while (p < end && isDigit(*p)) {
+        if (value < (Q_INT64_C(1) << 40)) {
+            value = value * 10 + (*p - '0');
+        }
+        p++;
+    }
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+//! Unlike strtof independent of the locale, which QCoreApplication sets from the environment
+bool parseFloat(const char *&p, const char *end, float &value) {
+    static const double POWERS_OF_TEN[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    // Enough significant digits for doubles, the remaining ones only shift the exponent
+    const quint64 MAX_MANTISSA = Q_UINT64_C(100000000000000000);
+
+    skipSpaces(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    quint64 mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    while (p < end && isDigit(*p)) {
+        if (mantissa < MAX_MANTISSA) {
+            mantissa = mantissa * 10 + (*p - '0');
+        } else {
+            exponent++;
+        }
+        digits++;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && isDigit(*p)) {
+            if (mantissa < MAX_MANTISSA) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            }
+            digits++;
+            p++;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *exponentStart = p;
+        p++;
+        qint64 explicitExponent;
+        if (parseInteger(p, end, explicitExponent)) {
+            exponent += (int) qBound((qint64) -1000, explicitExponent, (qint64) 1000);
+        } else {
+            p = exponentStart;
+        }
+    }
+    double result = (double) mantissa;
+    if (exponent > 0 && exponent <= 22) {
+        result *= POWERS_OF_TEN[exponent];
+    } else if (exponent < 0 && exponent >= -22) {
+        result /= POWERS_OF_TEN[-exponent];
+    } else if (exponent != 0) {
+        result *= std::pow(10.0, exponent);
+    }
+    value = (float) (negative ? -result : result);
+    return true;
+}
+
+// PLY
+
+enum PlyType {
+    PlyInt8,
+    PlyUInt8,
+    PlyInt16,
+    PlyUInt16,
+    PlyInt32,
+    PlyUInt32,
+    PlyFloat32,
+    PlyFloat64,
+    PlyInvalid
+};
+
+enum PlyFormat {
+    PlyAscii,
+    PlyBinaryLittleEndian,
+    PlyBinaryBigEndian
+};
+
+struct PlyProperty {
+    QByteArray name;
+    PlyType type;
+    //! PlyInvalid if the property is not a list
+    PlyType countType;
+};
+
+struct PlyElement {
+    QByteArray name;
+    qint64 count;
+    QVector<PlyProperty> properties;
+};
+
+PlyType plyType(const QByteArray &name) {
+    static const QHash<QByteArray, PlyType> types({
+        {"char", PlyInt8}, {"int8", PlyInt8},
+        {"uchar", PlyUInt8}, {"uint8", PlyUInt8},
+        {"short", PlyInt16}, {"int16", PlyInt16},
+        {"ushort", PlyUInt16}, {"uint16", PlyUInt16},
+        {"int", PlyInt32}, {"int32", PlyInt32},
+        {"uint", PlyUInt32}, {"uint32", PlyUInt32},
+        {"float", PlyFloat32}, {"float32", PlyFloat32},
+        {"double", PlyFloat64}, {"float64", PlyFloat64}});
+    return types.value(name, PlyInvalid);
+}
+
+int plyTypeSize(PlyType type) {
+    switch (type) {
+    case PlyInt8:
+    case PlyUInt8:
+        return 1;
+    case PlyInt16:
+    case PlyUInt16:
+        return 2;
+    case PlyInt32:
+    case PlyUInt32:
+    case PlyFloat32:
+        return 4;
+    case PlyFloat64:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+template<typename T, typename Raw>
+inline T readPlyScalar(const uchar *p, bool bigEndian) {
+    Raw raw = bigEndian ? qFromBigEndian<Raw>(p) : qFromLittleEndian<Raw>(p);
+    T value;
+    memcpy(&value, &raw, sizeof(T));
+    return value;
+}
+
+inline double readPlyValue(const uchar *p, PlyType type, bool bigEndian) {
+    switch (type) {
+    case PlyInt8:
+        return *reinterpret_cast<const qint8*>(p);
+    case PlyUInt8:
+        return *p;
+    case PlyInt16:
+        return readPlyScalar<qint16, quint16>(p, bigEndian);
+    case PlyUInt16:
+        return readPlyScalar<quint16, quint16>(p, bigEndian);
+    case PlyInt32:
+        return readPlyScalar<qint32, quint32>(p, bigEndian);
+    case PlyUInt32:
+        return readPlyScalar<quint32, quint32>(p, bigEndian);
+    case PlyFloat32:
+        return readPlyScalar<float, quint32>(p, bigEndian);
+    case PlyFloat64:
+        return readPlyScalar<double, quint64>(p, bigEndian);
+    default:
+        return 0.0;
+    }
+}
+
+//! Reads the values of the records of an element one after another, in any of the formats
+class PlyReader {
+public:
+    PlyReader(const uchar *position, const uchar *end, PlyFormat format)
+        : m_position(position)
+        , m_end(end)
+        , m_format(format) {
+    }
+
+    bool read(PlyType type, double &value) {
+        if (m_format == PlyAscii) {
+            const char *p = reinterpret_cast<const char*>(m_position);
+            const char *end = reinterpret_cast<const char*>(m_end);
+            bool success;
+            if (type == PlyFloat32 || type == PlyFloat64) {
+                float floatValue;
+                success = parseFloat(p, end, floatValue);
+                value = floatValue;
+            } else {
+                qint64 integerValue;
+                success = parseInteger(p, end, integerValue);
+                value = (double) integerValue;
+            }
+            m_position = reinterpret_cast<const uchar*>(p);
+            return success;
+        }
+        const int size = plyTypeSize(type);
+        if (m_end - m_position < size) {
+            return false;
+        }
+        value = readPlyValue(m_position, type, m_format == PlyBinaryBigEndian);
+        m_position += size;
+        return true;
+    }
+
+    //! Reads the count of a list property
+    bool readCount(PlyType type, int &count) {
+        double value;
+        if (!read(type, value) || value < 0 || value > 0xFFFF) {
+            return false;
+        }
+        count = (int) value;
+        return true;
+    }
+
+    bool skip(PlyType type, int count = 1) {
+        if (m_format == PlyAscii) {
+            double value;
+            for (int i = 0; i < count; i++) {
+                if (!read(type, value)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        const qint64 size = (qint64) plyTypeSize(type) * count;
+        if (m_end - m_position < size) {
+            return false;
+        }
+        m_position += size;
+        return true;
+    }
+
+    //! ASCII records end with their line, the rest of which is ignored
+    void endRecord() {
+        if (m_format == PlyAscii) {
+            const char *p = reinterpret_cast<const char*>(m_position);
+            const char *end = reinterpret_cast<const char*>(m_end);
+            const char *lineEnd = findLineEnd(p, end);
+            m_position = reinterpret_cast<const uchar*>(lineEnd < end ? lineEnd + 1 : end);
+        }
+    }
+
+    const uchar *position() const {
+        return m_position;
+    }
+
+private:
+    const uchar *m_position;
+    const uchar *m_end;
+    PlyFormat m_format;
+};
+
+/*!
+ * \brief chunkPlyElement walks over all records of the element and returns where every
+ * recordsPerChunk-th record starts, to parse the chunks of records in parallel afterwards.
+ * \param position the start of the element, the end of the element afterwards
+ * \return false if the file ends before the element
+ */
+bool chunkPlyElement(const PlyElement &element, PlyFormat format, qint64 recordsPerChunk,
+                     const uchar *&position, const uchar *end, QVector<const uchar*> &chunkStarts) {
+    bool fixedSize = format != PlyAscii;
+    qint64 recordSize = 0;
+    for (const PlyProperty &property : element.properties) {
+        fixedSize &= property.countType == PlyInvalid;
+        recordSize += plyTypeSize(property.type);
+    }
+    if (fixedSize) {
+        if (recordSize * element.count > end - position) {
+            return false;
+        }
+        for (qint64 record = 0; record < element.count; record += recordsPerChunk) {
+            chunkStarts.append(position + record * recordSize);
+        }
+        position += recordSize * element.count;
+        return true;
+    }
+
+    PlyReader reader(position, end, format);
+    for (qint64 record = 0; record < element.count; record++) {
+        if (record % recordsPerChunk == 0) {
+            chunkStarts.append(reader.position());
+        }
+        if (format == PlyAscii) {
+            if (reader.position() == end) {
+                return false;
+            }
+            reader.endRecord();
+            continue;
+        }
+        for (const PlyProperty &property : element.properties) {
+            int count = 1;
+            if (property.countType != PlyInvalid && !reader.readCount(property.countType, count)) {
+                return false;
+            }
+            if (!reader.skip(property.type, count)) {
+                return false;
+            }
+        }
+    }
+    position = reader.position();
+    return true;
+}
+
+// OBJ
+
+//! The indices of the attributes of a corner of a face, -1 if the corner doesn't have the attribute
+struct ObjCorner {
+    int position;
+    int texCoord;
+    int normal;
+};
+
+inline bool operator==(const ObjCorner &c1, const ObjCorner &c2) {
+    return c1.position == c2.position && c1.texCoord == c2.texCoord && c1.normal == c2.normal;
+}
+
+inline uint qHash(const ObjCorner &corner, uint seed = 0) {
+    return ::qHash(qMakePair(corner.position, qMakePair(corner.texCoord, corner.normal)), seed);
+}
+
+struct ObjMaterial {
+    QColor ambient;
+    QColor specular;
+    QString diffuseTexturePath;
+};
+
+enum ObjLineType {
+    ObjPosition,
+    ObjTexCoord,
+    ObjNormal,
+    ObjFace,
+    ObjUseMaterial,
+    ObjMaterialLibrary,
+    ObjOther
+};
+
+//! Moves p behind the keyword at the start of the line
+ObjLineType objLineType(const char *&p, const char *lineEnd) {
+    skipSpaces(p, lineEnd);
+    const char *keywordStart = p;
+    while (p < lineEnd && !isSpace(*p)) {
+        p++;
+    }
+    const QByteArray keyword = QByteArray::fromRawData(keywordStart, (int) (p - keywordStart));
+    if (keyword == "v") {
+        return ObjPosition;
+    } else if (keyword == "vt") {
+        return ObjTexCoord;
+    } else if (keyword == "vn") {
+        return ObjNormal;
+    } else if (keyword == "f") {
+        return ObjFace;
+    } else if (keyword == "usemtl") {
+        return ObjUseMaterial;
+    } else if (keyword == "mtllib") {
+        return ObjMaterialLibrary;
+    }
+    return ObjOther;
+}
+
+QByteArray objRestOfLine(const char *p, const char *lineEnd) {
+    return QByteArray(p, (int) (lineEnd - p)).trimmed();
+}
+
+/*!
+ * \brief parseObjIndex parses an index of a face corner.
+ * \param currentCount the count of the attribute so far, relative indices are resolved against it
+ * \param totalCount the count of the attribute in the whole file
+ */
+bool parseObjIndex(const char *&p, const char *end, int currentCount, int totalCount, int &index) {
+    qint64 value;
+    if (!parseInteger(p, end, value) || value == 0) {
+        return false;
+    }
+    value = value > 0 ? value - 1 : currentCount + value;
+    if (value < 0 || value >= totalCount) {
+        return false;
+    }
+    index = (int) value;
+    return true;
+}
+
+void parseObjMaterialLibrary(const QString &path, QHash<QByteArray, ObjMaterial> &materials) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Could not open the material library" << path;
+        return;
+    }
+    const QString directory = QFileInfo(path).absolutePath();
+    ObjMaterial *material = Q_NULLPTR;
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        const QByteArray simplified = line.simplified();
+        const int keywordEnd = simplified.indexOf(' ');
+        if (keywordEnd == -1) {
+            continue;
+        }
+        const QByteArray keyword = simplified.left(keywordEnd);
+        const QByteArray arguments = simplified.mid(keywordEnd + 1);
+        if (keyword == "newmtl") {
+            material = &materials[arguments];
+            *material = ObjMaterial();
+        } else if (!material) {
+            continue;
+        } else if (keyword == "Ka" || keyword == "Ks") {
+            const QList<QByteArray> values = arguments.split(' ');
+            if (values.size() >= 3) {
+                QColor color = QColor::fromRgbF(qBound(0.f, values[0].toFloat(), 1.f),
+                                                qBound(0.f, values[1].toFloat(), 1.f),
+                                                qBound(0.f, values[2].toFloat(), 1.f));
+                (keyword == "Ka" ? material->ambient : material->specular) = color;
+            }
+        } else if (keyword == "map_Kd") {
+            // The file name is the last argument, the ones before are options
+            const QString fileName = QString::fromUtf8(arguments.mid(arguments.lastIndexOf(' ') + 1));
+            material->diffuseTexturePath = QDir(directory).absoluteFilePath(fileName);
+        }
+    }
+}
+
+}
+
+int MeshLoader::Mesh::byteStride() const {
+    return (hasTexCoords ? 8 : 6) * (int) sizeof(float);
+}
+
+bool MeshLoader::canLoad(const QString &path) {
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == QStringLiteral("ply") || suffix == QStringLiteral("obj");
+}
+
+MeshLoader::Mesh MeshLoader::load(const QString &path) {
+    Mesh mesh;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mesh.errorString = file.errorString();
+        return mesh;
+    }
+    const qint64 size = file.size();
+    const uchar *data = size > 0 ? file.map(0, size) : Q_NULLPTR;
+    if (!data) {
+        mesh.errorString = QStringLiteral("Could not map the file.");
+        return mesh;
+    }
+
+    Geometry geometry;
+    const QString directory = QFileInfo(path).absolutePath();
+    const bool loaded = QFileInfo(path).suffix().toLower() == QStringLiteral("ply")
+            ? loadPly(data, size, directory, geometry, mesh.errorString)
+            : loadObj(data, size, directory, geometry, mesh.errorString);
+    file.unmap(const_cast<uchar*>(data));
+    if (!loaded) {
+        return mesh;
+    }
+    if (geometry.indices.isEmpty()) {
+        mesh.errorString = QStringLiteral("The file contains no faces.");
+        return mesh;
+    }
+    if (geometry.normals.isEmpty()) {
+        computeNormals(geometry);
+    }
+    interleave(geometry, mesh);
+    mesh.indexData = QByteArray(reinterpret_cast<const char*>(geometry.indices.constData()),
+                                geometry.indices.size() * (int) sizeof(quint32));
+    mesh.parts = geometry.parts;
+    mesh.valid = true;
+    return mesh;
+}
+
+QStringList MeshLoader::referencedFiles(const QString &path) {
+    QStringList files;
+    QFile file(path);
+    if (!canLoad(path) || !file.open(QIODevice::ReadOnly)) {
+        return files;
+    }
+    const QString directory = QFileInfo(path).absolutePath();
+    if (QFileInfo(path).suffix().toLower() == QStringLiteral("ply")) {
+        // Only the header references files
+        while (!file.atEnd()) {
+            const QByteArray line = file.readLine().simplified();
+            if (line == "end_header") {
+                break;
+            }
+            if (line.startsWith("comment TextureFile ")) {
+                const QString fileName = QString::fromUtf8(line.mid(line.indexOf("TextureFile") + 11).trimmed());
+                files.append(QDir(directory).absoluteFilePath(fileName));
+            }
+        }
+        return files;
+    }
+
+    const qint64 size = file.size();
+    const uchar *data = size > 0 ? file.map(0, size) : Q_NULLPTR;
+    if (!data) {
+        return files;
+    }
+    const char *p = reinterpret_cast<const char*>(data);
+    const char *end = p + size;
+    QHash<QByteArray, ObjMaterial> materials;
+    while (p < end) {
+        const char *lineEnd = findLineEnd(p, end);
+        if (objLineType(p, lineEnd) == ObjMaterialLibrary) {
+            const QString materialLibrary =
+                    QDir(directory).absoluteFilePath(QString::fromUtf8(objRestOfLine(p, lineEnd)));
+            if (!files.contains(materialLibrary)) {
+                files.append(materialLibrary);
+                parseObjMaterialLibrary(materialLibrary, materials);
+            }
+        }
+        p = lineEnd + 1;
+    }
+    file.unmap(const_cast<uchar*>(data));
+    for (const ObjMaterial &material : materials) {
+        if (!material.diffuseTexturePath.isEmpty() && !files.contains(material.diffuseTexturePath)) {
+            files.append(material.diffuseTexturePath);
+        }
+    }
+    return files;
+}
+
+bool MeshLoader::loadPly(const uchar *data, qint64 size, const QString &directory,
+                         Geometry &geometry, QString &errorString) {
+    const char *text = reinterpret_cast<const char*>(data);
+    const char *textEnd = text + size;
+    const char *p = text;
+
+    // Header
+    PlyFormat format = PlyAscii;
+    bool formatFound = false;
+    bool headerEnded = false;
+    QString texturePath;
+    QVector<PlyElement> elements;
+    bool firstLine = true;
+    while (p < textEnd && !headerEnded) {
+        const char *lineEnd = findLineEnd(p, textEnd);
+        const QByteArray line = QByteArray(p, (int) (lineEnd - p)).simplified();
+        p = lineEnd < textEnd ? lineEnd + 1 : textEnd;
+        const QList<QByteArray> tokens = line.split(' ');
+        const QByteArray &keyword = tokens[0];
+        if (firstLine) {
+            if (keyword != "ply") {
+                errorString = QStringLiteral("Not a PLY file.");
+                return false;
+            }
+            firstLine = false;
+        } else if (keyword == "format" && tokens.size() >= 2) {
+            formatFound = true;
+            if (tokens[1] == "ascii") {
+                format = PlyAscii;
+            } else if (tokens[1] == "binary_little_endian") {
+                format = PlyBinaryLittleEndian;
+            } else if (tokens[1] == "binary_big_endian") {
+                format = PlyBinaryBigEndian;
+            } else {
+                formatFound = false;
+            }
+        } else if (keyword == "comment" && tokens.size() >= 3 && tokens[1] == "TextureFile") {
+            // Written like this by MeshLab
+            const QString fileName = QString::fromUtf8(line.mid(line.indexOf("TextureFile") + 11).trimmed());
+            texturePath = QDir(directory).absoluteFilePath(fileName);
+        } else if (keyword == "element" && tokens.size() == 3) {
+            bool isNumber;
+            const qint64 count = tokens[2].toLongLong(&isNumber);
+            if (!isNumber || count < 0) {
+                errorString = QStringLiteral("Invalid element count.");
+                return false;
+            }
+            elements.append({tokens[1], count, QVector<PlyProperty>()});
+        } else if (keyword == "property" && !elements.isEmpty()) {
+            PlyProperty property;
+            if (tokens.size() == 5 && tokens[1] == "list") {
+                property = {tokens[4], plyType(tokens[3]), plyType(tokens[2])};
+                if (property.countType == PlyInvalid) {
+                    errorString = QStringLiteral("Invalid property type.");
+                    return false;
+                }
+            } else if (tokens.size() == 3) {
+                property = {tokens[2], plyType(tokens[1]), PlyInvalid};
+            } else {
+                errorString = QStringLiteral("Invalid property.");
+                return false;
+            }
+            if (property.type == PlyInvalid) {
+                errorString = QStringLiteral("Invalid property type.");
+                return false;
+            }
+            elements.last().properties.append(property);
+        } else if (keyword == "end_header") {
+            headerEnded = true;
+        }
+    }
+    if (!headerEnded || !formatFound) {
+        errorString = QStringLiteral("Invalid PLY header.");
+        return false;
+    }
+
+    qint64 vertexCount = -1;
+    for (const PlyElement &element : elements) {
+        if (element.name == "vertex") {
+            vertexCount = element.count;
+        }
+    }
+    if (vertexCount < 0 || vertexCount > MAX_VERTEX_COUNT) {
+        errorString = QStringLiteral("The file contains no or too many vertices.");
+        return false;
+    }
+
+    // The attributes of the vertices we use, in this order
+    enum VertexSlot { X, Y, Z, NX, NY, NZ, U, V, SlotCount };
+    static const QHash<QByteArray, int> VERTEX_SLOTS({
+        {"x", X}, {"y", Y}, {"z", Z}, {"nx", NX}, {"ny", NY}, {"nz", NZ},
+        {"u", U}, {"v", V}, {"s", U}, {"t", V},
+        {"texture_u", U}, {"texture_v", V}, {"texture_s", U}, {"texture_t", V}});
+
+    const uchar *position = reinterpret_cast<const uchar*>(p);
+    const uchar *end = data + size;
+    bool verticesParsed = false;
+    bool hasCornerTexCoords = false;
+    for (const PlyElement &element : elements) {
+        const int chunkCount = chunkCountFor(element.count, MIN_RECORDS_PER_CHUNK);
+        const qint64 recordsPerChunk = qMax((qint64) 1, (element.count + chunkCount - 1) / chunkCount);
+        QVector<const uchar*> chunkStarts;
+        if (!chunkPlyElement(element, format, recordsPerChunk, position, end, chunkStarts)) {
+            errorString = QStringLiteral("The file is truncated.");
+            return false;
+        }
+        const QVector<PlyProperty> &properties = element.properties;
+
+        if (element.name == "vertex") {
+            QVector<int> propertySlots;
+            QVector<bool> slotFound(SlotCount, false);
+            for (const PlyProperty &property : properties) {
+                const int slot = property.countType == PlyInvalid ? VERTEX_SLOTS.value(property.name, -1) : -1;
+                propertySlots.append(slot);
+                if (slot != -1) {
+                    slotFound[slot] = true;
+                }
+            }
+            if (!slotFound[X] || !slotFound[Y] || !slotFound[Z]) {
+                errorString = QStringLiteral("The vertices have no positions.");
+                return false;
+            }
+            const bool hasNormals = slotFound[NX] && slotFound[NY] && slotFound[NZ];
+            const bool hasTexCoords = slotFound[U] && slotFound[V];
+            geometry.vertexCount = (int) vertexCount;
+            geometry.positions.resize(3 * geometry.vertexCount);
+            if (hasNormals) {
+                geometry.normals.resize(3 * geometry.vertexCount);
+            }
+            if (hasTexCoords) {
+                geometry.texCoords.resize(2 * geometry.vertexCount);
+            }
+            float *positions = geometry.positions.data();
+            float *normals = geometry.normals.data();
+            float *texCoords = geometry.texCoords.data();
+
+            QVector<char> chunkValid(chunkStarts.size(), true);
+            forEachChunk(chunkStarts.size(), [&](int chunk) {
+                PlyReader reader(chunkStarts[chunk], end, format);
+                const qint64 first = chunk * recordsPerChunk;
+                const qint64 last = qMin(first + recordsPerChunk, vertexCount);
+                double values[SlotCount] = {};
+                for (qint64 vertex = first; vertex < last; vertex++) {
+                    for (int i = 0; i < properties.size(); i++) {
+                        const PlyProperty &property = properties[i];
+                        int count;
+                        if (property.countType != PlyInvalid) {
+                            if (!reader.readCount(property.countType, count)
+                                    || !reader.skip(property.type, count)) {
+                                chunkValid[chunk] = false;
+                                return;
+                            }
+                        } else if (propertySlots.at(i) != -1) {
+                            if (!reader.read(property.type, values[propertySlots.at(i)])) {
+                                chunkValid[chunk] = false;
+                                return;
+                            }
+                        } else if (!reader.skip(property.type)) {
+                            chunkValid[chunk] = false;
+                            return;
+                        }
+                    }
+                    reader.endRecord();
+                    positions[3 * vertex] = (float) values[X];
+                    positions[3 * vertex + 1] = (float) values[Y];
+                    positions[3 * vertex + 2] = (float) values[Z];
+                    if (hasNormals) {
+                        normals[3 * vertex] = (float) values[NX];
+                        normals[3 * vertex + 1] = (float) values[NY];
+                        normals[3 * vertex + 2] = (float) values[NZ];
+                    }
+                    if (hasTexCoords) {
+                        texCoords[2 * vertex] = (float) values[U];
+                        texCoords[2 * vertex + 1] = (float) values[V];
+                    }
+                }
+            });
+            if (chunkValid.contains(false)) {
+                errorString = QStringLiteral("Invalid vertex data.");
+                return false;
+            }
+            verticesParsed = true;
+        } else if (element.name == "face") {
+            int indicesProperty = -1;
+            int texCoordsProperty = -1;
+            for (int i = 0; i < properties.size(); i++) {
+                if (properties[i].countType == PlyInvalid) {
+                    continue;
+                }
+                if (properties[i].name == "vertex_indices" || properties[i].name == "vertex_index") {
+                    indicesProperty = i;
+                } else if (properties[i].name == "texcoord") {
+                    texCoordsProperty = i;
+                }
+            }
+            if (indicesProperty == -1 || !verticesParsed) {
+                errorString = QStringLiteral("The faces have no vertex indices or precede the vertices.");
+                return false;
+            }
+            // MeshLab stores the texture coordinates per corner of the faces, every corner becomes
+            // a vertex of its own then
+            hasCornerTexCoords = texCoordsProperty != -1;
+
+            struct FaceChunk {
+                bool valid;
+                QVector<quint32> indices;
+                QVector<int> cornerPositions;
+                QVector<float> cornerTexCoords;
+            };
+            QVector<FaceChunk> faceChunks(chunkStarts.size());
+            forEachChunk(chunkStarts.size(), [&](int chunk) {
+                FaceChunk &faceChunk = faceChunks[chunk];
+                faceChunk.valid = false;
+                PlyReader reader(chunkStarts[chunk], end, format);
+                const qint64 first = chunk * recordsPerChunk;
+                const qint64 last = qMin(first + recordsPerChunk, element.count);
+                QVarLengthArray<quint32, 16> faceIndices;
+                QVarLengthArray<float, 32> faceTexCoords;
+                for (qint64 face = first; face < last; face++) {
+                    faceIndices.clear();
+                    faceTexCoords.clear();
+                    for (int i = 0; i < properties.size(); i++) {
+                        const PlyProperty &property = properties[i];
+                        int count = 1;
+                        if (property.countType != PlyInvalid && !reader.readCount(property.countType, count)) {
+                            return;
+                        }
+                        if (i != indicesProperty && i != texCoordsProperty) {
+                            if (!reader.skip(property.type, count)) {
+                                return;
+                            }
+                            continue;
+                        }
+                        for (int j = 0; j < count; j++) {
+                            double value;
+                            if (!reader.read(property.type, value)) {
+                                return;
+                            }
+                            if (i == texCoordsProperty) {
+                                faceTexCoords.append((float) value);
+                            } else if (value < 0 || value >= vertexCount) {
+                                return;
+                            } else {
+                                faceIndices.append((quint32) value);
+                            }
+                        }
+                    }
+                    reader.endRecord();
+
+                    const int corners = faceIndices.size();
+                    quint32 firstCorner = 0;
+                    if (hasCornerTexCoords) {
+                        firstCorner = faceChunk.cornerPositions.size();
+                        const bool cornerTexCoordsComplete = faceTexCoords.size() == 2 * corners;
+                        for (int j = 0; j < corners; j++) {
+                            faceChunk.cornerPositions.append((int) faceIndices[j]);
+                            faceChunk.cornerTexCoords.append(cornerTexCoordsComplete ? faceTexCoords[2 * j] : 0.f);
+                            faceChunk.cornerTexCoords.append(cornerTexCoordsComplete ? faceTexCoords[2 * j + 1] : 0.f);
+                        }
+                    }
+                    // Fans, faces with less than three corners are points or lines
+                    for (int j = 1; j + 1 < corners; j++) {
+                        if (hasCornerTexCoords) {
+                            faceChunk.indices.append(firstCorner);
+                            faceChunk.indices.append(firstCorner + j);
+                            faceChunk.indices.append(firstCorner + j + 1);
+                        } else {
+                            faceChunk.indices.append(faceIndices[0]);
+                            faceChunk.indices.append(faceIndices[j]);
+                            faceChunk.indices.append(faceIndices[j + 1]);
+                        }
+                    }
+                }
+                faceChunk.valid = true;
+            });
+
+            qint64 indexCount = 0;
+            qint64 cornerCount = 0;
+            for (const FaceChunk &faceChunk : faceChunks) {
+                if (!faceChunk.valid) {
+                    errorString = QStringLiteral("Invalid face data.");
+                    return false;
+                }
+                indexCount += faceChunk.indices.size();
+                cornerCount += faceChunk.cornerPositions.size();
+            }
+            if (indexCount > MAX_VERTEX_COUNT * 3 || cornerCount > MAX_VERTEX_COUNT) {
+                errorString = QStringLiteral("The file contains too many faces.");
+                return false;
+            }
+            geometry.indices.reserve((int) indexCount);
+            if (hasCornerTexCoords) {
+                geometry.texCoords.clear();
+            }
+            for (const FaceChunk &faceChunk : faceChunks) {
+                // The corners of the chunks follow each other
+                const quint32 cornerOffset = geometry.vertexPositions.size();
+                for (quint32 index : faceChunk.indices) {
+                    geometry.indices.append(index + cornerOffset);
+                }
+                geometry.vertexPositions += faceChunk.cornerPositions;
+                geometry.texCoords += faceChunk.cornerTexCoords;
+            }
+        }
+        // Other elements, e.g. edges, have been skipped by chunkPlyElement already
+    }
+
+    if (hasCornerTexCoords) {
+        // Texture coordinates of the vertices, if any, are replaced by the ones of the corners
+        geometry.vertexCount = geometry.vertexPositions.size();
+        if (!geometry.normals.isEmpty()) {
+            geometry.vertexNormals = geometry.vertexPositions;
+        }
+    }
+    Part part;
+    part.indexCount = geometry.indices.size();
+    if (!geometry.texCoords.isEmpty() && !texturePath.isEmpty()) {
+        part.diffuseTexturePath = texturePath;
+    }
+    geometry.parts.append(part);
+    return true;
+}
+
+bool MeshLoader::loadObj(const uchar *data, qint64 size, const QString &directory,
+                         Geometry &geometry, QString &errorString) {
+    const char *text = reinterpret_cast<const char*>(data);
+    const char *textEnd = text + size;
+
+    // Chunks of whole lines
+    const int chunkCount = chunkCountFor(size, MIN_BYTES_PER_CHUNK);
+    QVector<const char*> chunkStarts;
+    chunkStarts.append(text);
+    for (int chunk = 1; chunk < chunkCount; chunk++) {
+        const char *chunkStart = text + size * chunk / chunkCount;
+        chunkStart = qMax(chunkStart, chunkStarts.last());
+        const char *lineEnd = findLineEnd(chunkStart, textEnd);
+        chunkStarts.append(lineEnd < textEnd ? lineEnd + 1 : textEnd);
+    }
+    chunkStarts.append(textEnd);
+
+    // The first pass counts the attributes to be able to resolve relative indices and to write
+    // the attributes of all chunks into the same arrays in the second pass
+    struct ObjChunk {
+        int positionCount;
+        int texCoordCount;
+        int normalCount;
+        QList<QByteArray> materialLibraries;
+        //! The material used at the end of the chunk, empty if the chunk doesn't switch it
+        QByteArray lastMaterial;
+        bool valid;
+        QVector<ObjCorner> corners;
+        //! Three corners per triangle
+        QVector<int> triangles;
+        //! The material of every triangle, as index into materials
+        QVector<int> triangleMaterials;
+        QList<QByteArray> materials;
+    };
+    QVector<ObjChunk> chunks(chunkCount);
+    forEachChunk(chunkCount, [&](int chunk) {
+        ObjChunk &objChunk = chunks[chunk];
+        objChunk.positionCount = 0;
+        objChunk.texCoordCount = 0;
+        objChunk.normalCount = 0;
+        const char *p = chunkStarts[chunk];
+        const char *chunkEnd = chunkStarts[chunk + 1];
+        while (p < chunkEnd) {
+            const char *lineEnd = findLineEnd(p, chunkEnd);
+            switch (objLineType(p, lineEnd)) {
+            case ObjPosition:
+                objChunk.positionCount++;
+                break;
+            case ObjTexCoord:
+                objChunk.texCoordCount++;
+                break;
+            case ObjNormal:
+                objChunk.normalCount++;
+                break;
+            case ObjUseMaterial:
+                objChunk.lastMaterial = objRestOfLine(p, lineEnd);
+                break;
+            case ObjMaterialLibrary:
+                objChunk.materialLibraries.append(objRestOfLine(p, lineEnd));
+                break;
+            default:
+                break;
+            }
+            p = lineEnd + 1;
+        }
+    });
+
+    qint64 positionCount = 0;
+    qint64 texCoordCount = 0;
+    qint64 normalCount = 0;
+    for (const ObjChunk &objChunk : chunks) {
+        positionCount += objChunk.positionCount;
+        texCoordCount += objChunk.texCoordCount;
+        normalCount += objChunk.normalCount;
+    }
+    if (positionCount > MAX_VERTEX_COUNT || texCoordCount > MAX_VERTEX_COUNT || normalCount > MAX_VERTEX_COUNT) {
+        errorString = QStringLiteral("The file contains too many vertices.");
+        return false;
+    }
+    geometry.positions.resize(3 * positionCount);
+    QVector<float> texCoords(2 * texCoordCount);
+    QVector<float> normals(3 * normalCount);
+    float *positionData = geometry.positions.data();
+    float *texCoordData = texCoords.data();
+    float *normalData = normals.data();
+
+    forEachChunk(chunkCount, [&](int chunk) {
+        ObjChunk &objChunk = chunks[chunk];
+        objChunk.valid = false;
+        int positionIndex = 0;
+        int texCoordIndex = 0;
+        int normalIndex = 0;
+        int material = -1;
+        for (int previous = 0; previous < chunk; previous++) {
+            const ObjChunk &previousChunk = chunks.at(previous);
+            positionIndex += previousChunk.positionCount;
+            texCoordIndex += previousChunk.texCoordCount;
+            normalIndex += previousChunk.normalCount;
+            if (!previousChunk.lastMaterial.isEmpty()) {
+                material = 0;
+                objChunk.materials = QList<QByteArray>() << previousChunk.lastMaterial;
+            }
+        }
+
+        QVarLengthArray<int, 16> faceCorners;
+        const char *p = chunkStarts[chunk];
+        const char *chunkEnd = chunkStarts[chunk + 1];
+        while (p < chunkEnd) {
+            const char *lineEnd = findLineEnd(p, chunkEnd);
+            const ObjLineType lineType = objLineType(p, lineEnd);
+            if (lineType == ObjPosition) {
+                float *position = positionData + 3 * positionIndex++;
+                if (!parseFloat(p, lineEnd, position[0]) || !parseFloat(p, lineEnd, position[1])
+                        || !parseFloat(p, lineEnd, position[2])) {
+                    return;
+                }
+            } else if (lineType == ObjTexCoord) {
+                float *texCoord = texCoordData + 2 * texCoordIndex++;
+                if (!parseFloat(p, lineEnd, texCoord[0])) {
+                    return;
+                }
+                // The second and third coordinate are optional
+                if (!parseFloat(p, lineEnd, texCoord[1])) {
+                    texCoord[1] = 0.f;
+                }
+            } else if (lineType == ObjNormal) {
+                float *normal = normalData + 3 * normalIndex++;
+                if (!parseFloat(p, lineEnd, normal[0]) || !parseFloat(p, lineEnd, normal[1])
+                        || !parseFloat(p, lineEnd, normal[2])) {
+                    return;
+                }
+            } else if (lineType == ObjUseMaterial) {
+                const QByteArray name = objRestOfLine(p, lineEnd);
+                material = objChunk.materials.indexOf(name);
+                if (material == -1) {
+                    material = objChunk.materials.size();
+                    objChunk.materials.append(name);
+                }
+            } else if (lineType == ObjFace) {
+                faceCorners.clear();
+                skipSpaces(p, lineEnd);
+                while (p < lineEnd) {
+                    // v, v/vt, v//vn or v/vt/vn
+                    ObjCorner corner = {-1, -1, -1};
+                    if (!parseObjIndex(p, lineEnd, positionIndex, (int) positionCount, corner.position)) {
+                        return;
+                    }
+                    if (p < lineEnd && *p == '/') {
+                        p++;
+                        if (p < lineEnd && *p != '/' && !parseObjIndex(p, lineEnd, texCoordIndex, (int) texCoordCount, corner.texCoord)) {
+                            return;
+                        }
+                        if (p < lineEnd && *p == '/') {
+                            p++;
+                            if (!parseObjIndex(p, lineEnd, normalIndex, (int) normalCount, corner.normal)) {
+                                return;
+                            }
+                        }
+                    }
+                    faceCorners.append(objChunk.corners.size());
+                    objChunk.corners.append(corner);
+                    skipSpaces(p, lineEnd);
+                }
+                for (int j = 1; j + 1 < faceCorners.size(); j++) {
+                    objChunk.triangles.append(faceCorners[0]);
+                    objChunk.triangles.append(faceCorners[j]);
+                    objChunk.triangles.append(faceCorners[j + 1]);
+                    objChunk.triangleMaterials.append(material);
+                }
+            }
+            p = lineEnd + 1;
+        }
+        objChunk.valid = true;
+    });
+
+    QHash<QByteArray, ObjMaterial> materials;
+    QList<QByteArray> materialNames;
+    bool cornersHaveTexCoords = false;
+    bool allCornersHaveNormals = true;
+    // Whether the attributes of every corner share their index, i.e. they don't need to be
+    // combined into new vertices
+    bool cornersAligned = (texCoordCount == 0 || texCoordCount == positionCount)
+            && (normalCount == 0 || normalCount == positionCount);
+    for (const ObjChunk &objChunk : chunks) {
+        if (!objChunk.valid) {
+            errorString = QStringLiteral("Invalid vertex or face data.");
+            return false;
+        }
+        for (const QByteArray &materialLibrary : objChunk.materialLibraries) {
+            parseObjMaterialLibrary(QDir(directory).absoluteFilePath(QString::fromUtf8(materialLibrary)), materials);
+        }
+        for (const QByteArray &material : objChunk.materials) {
+            if (!materialNames.contains(material)) {
+                materialNames.append(material);
+            }
+        }
+        for (const ObjCorner &corner : objChunk.corners) {
+            cornersHaveTexCoords |= corner.texCoord != -1;
+            allCornersHaveNormals &= corner.normal != -1;
+            cornersAligned &= (corner.texCoord == -1 || corner.texCoord == corner.position)
+                    && (corner.normal == -1 || corner.normal == corner.position);
+        }
+    }
+    // Combinations of some corners with and some without texture coordinates need new vertices
+    for (const ObjChunk &objChunk : chunks) {
+        for (const ObjCorner &corner : objChunk.corners) {
+            cornersAligned &= (corner.texCoord != -1) == cornersHaveTexCoords;
+        }
+    }
+
+    // Combines the attributes of the corners into vertices
+    QVector<QVector<quint32>> materialIndices(materialNames.size() + 1);
+    QHash<ObjCorner, quint32> vertices;
+    for (const ObjChunk &objChunk : chunks) {
+        QVector<quint32> cornerVertices(objChunk.corners.size());
+        for (int i = 0; i < objChunk.corners.size(); i++) {
+            const ObjCorner &corner = objChunk.corners[i];
+            if (cornersAligned) {
+                cornerVertices[i] = corner.position;
+                continue;
+            }
+            auto vertex = vertices.find(corner);
+            if (vertex == vertices.end()) {
+                vertex = vertices.insert(corner, geometry.vertexPositions.size());
+                geometry.vertexPositions.append(corner.position);
+                geometry.vertexTexCoords.append(corner.texCoord);
+                geometry.vertexNormals.append(corner.normal);
+            }
+            cornerVertices[i] = vertex.value();
+        }
+        for (int triangle = 0; triangle < objChunk.triangleMaterials.size(); triangle++) {
+            const int material = objChunk.triangleMaterials[triangle];
+            QVector<quint32> &indices = materialIndices[material == -1
+                    ? 0 : materialNames.indexOf(objChunk.materials[material]) + 1];
+            indices.append(cornerVertices[objChunk.triangles[3 * triangle]]);
+            indices.append(cornerVertices[objChunk.triangles[3 * triangle + 1]]);
+            indices.append(cornerVertices[objChunk.triangles[3 * triangle + 2]]);
+        }
+    }
+    geometry.vertexCount = cornersAligned ? (int) positionCount : geometry.vertexPositions.size();
+    if (cornersHaveTexCoords) {
+        geometry.texCoords = texCoords;
+    } else {
+        geometry.vertexTexCoords.clear();
+    }
+    if (allCornersHaveNormals && normalCount > 0) {
+        geometry.normals = normals;
+    } else {
+        // Computed for all vertices
+        geometry.vertexNormals.clear();
+    }
+
+    for (int i = 0; i < materialIndices.size(); i++) {
+        if (materialIndices[i].isEmpty()) {
+            continue;
+        }
+        Part part;
+        part.firstIndex = geometry.indices.size();
+        part.indexCount = materialIndices[i].size();
+        if (i > 0 && materials.contains(materialNames[i - 1])) {
+            const ObjMaterial &material = materials[materialNames[i - 1]];
+            if (material.ambient.isValid()) {
+                part.ambient = material.ambient;
+            }
+            if (material.specular.isValid()) {
+                part.specular = material.specular;
+            }
+            if (cornersHaveTexCoords) {
+                part.diffuseTexturePath = material.diffuseTexturePath;
+            }
+        }
+        geometry.indices += materialIndices[i];
+        geometry.parts.append(part);
+    }
+    return true;
+}
+
+void MeshLoader::computeNormals(Geometry &geometry) {
+    // Smooth normals per position, i.e. also across the seams of the texture coordinates
+    const int positionCount = geometry.positions.size() / 3;
+    QVector<float> normals(3 * positionCount, 0.f);
+    const float *positions = geometry.positions.constData();
+    const QVector<int> &vertexPositions = geometry.vertexPositions;
+    for (int i = 0; i + 2 < geometry.indices.size(); i += 3) {
+        int corners[3];
+        for (int j = 0; j < 3; j++) {
+            const int vertex = (int) geometry.indices[i + j];
+            corners[j] = vertexPositions.isEmpty() ? vertex : vertexPositions[vertex];
+        }
+        const QVector3D a(positions[3 * corners[0]], positions[3 * corners[0] + 1], positions[3 * corners[0] + 2]);
+        const QVector3D b(positions[3 * corners[1]], positions[3 * corners[1] + 1], positions[3 * corners[1] + 2]);
+        const QVector3D c(positions[3 * corners[2]], positions[3 * corners[2] + 1], positions[3 * corners[2] + 2]);
+        // Weighted by the area of the triangle
+        const QVector3D faceNormal = QVector3D::crossProduct(b - a, c - a);
+        for (int j = 0; j < 3; j++) {
+            normals[3 * corners[j]] += faceNormal.x();
+            normals[3 * corners[j] + 1] += faceNormal.y();
+            normals[3 * corners[j] + 2] += faceNormal.z();
+        }
+    }
+    float *normalData = normals.data();
+    parallelFor(positionCount, [normalData](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            float *normal = normalData + 3 * i;
+            const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length > 0.f) {
+                normal[0] /= length;
+                normal[1] /= length;
+                normal[2] /= length;
+            }
+        }
+    });
+    geometry.normals = normals;
+    geometry.vertexNormals = geometry.vertexPositions;
+}
+
+void MeshLoader::interleave(const Geometry &geometry, Mesh &mesh) {
+    mesh.vertexCount = geometry.vertexCount;
+    mesh.hasTexCoords = !geometry.texCoords.isEmpty();
+    const int floatsPerVertex = mesh.byteStride() / (int) sizeof(float);
+    mesh.vertexData.resize(mesh.vertexCount * mesh.byteStride());
+    // Detached before the threads write into it
+    float *vertexData = reinterpret_cast<float*>(mesh.vertexData.data());
+    const bool hasTexCoords = mesh.hasTexCoords;
+    parallelFor(mesh.vertexCount, [&geometry, vertexData, floatsPerVertex, hasTexCoords](int begin, int end) {
+        const float *positions = geometry.positions.constData();
+        const float *normals = geometry.normals.constData();
+        const float *texCoords = geometry.texCoords.constData();
+        for (int vertex = begin; vertex < end; vertex++) {
+            float *out = vertexData + vertex * floatsPerVertex;
+            const int position = geometry.vertexPositions.isEmpty() ? vertex : geometry.vertexPositions[vertex];
+            const int normal = geometry.vertexNormals.isEmpty() ? vertex : geometry.vertexNormals[vertex];
+            memcpy(out, positions + 3 * position, 3 * sizeof(float));
+            memcpy(out + 3, normals + 3 * normal, 3 * sizeof(float));
+            if (hasTexCoords) {
+                const int texCoord = geometry.vertexTexCoords.isEmpty() ? vertex : geometry.vertexTexCoords[vertex];
+                if (texCoord == -1) {
+                    out[6] = 0.f;
+                    out[7] = 0.f;
+                } else {
+                    memcpy(out + 6, texCoords + 2 * texCoord, 2 * sizeof(float));
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,70 @@
+#ifndef MESHLOADER_H
+#define MESHLOADER_H
+
+#include <QByteArray>
+#include <QColor>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ * \brief The MeshLoader class parses PLY (ASCII and binary) and OBJ files directly into the
+ * interleaved vertex buffer and the index buffer that are uploaded to the GPU, without building
+ * an Assimp scene first.
+ *
+ * The file is memory mapped and split into chunks that are parsed on the global thread pool.
+ * Polygons are triangulated as fans and smooth normals are computed if the file doesn't contain
+ * any. Vertex colors and other elements of the files are ignored, like the material of the
+ * ObjectModelRenderables does.
+ */
+class MeshLoader {
+
+public:
+    //! A range of the index buffer that is drawn with one material
+    struct Part {
+        int firstIndex = 0;
+        int indexCount = 0;
+        QColor ambient = QColor::fromRgbF(0.05f, 0.05f, 0.05f);
+        QColor specular = QColor::fromRgbF(0.01f, 0.01f, 0.01f);
+        //! Absolute path of the diffuse texture, empty if the part is not textured
+        QString diffuseTexturePath;
+    };
+
+    struct Mesh {
+        bool valid = false;
+        QString errorString;
+        //! Position, normal and, if hasTexCoords, texture coordinates of each vertex as floats
+        QByteArray vertexData;
+        int vertexCount = 0;
+        bool hasTexCoords = false;
+        //! Unsigned 32 bit indices of the triangles
+        QByteArray indexData;
+        QVector<Part> parts;
+
+        //! The size of one vertex in vertexData in bytes
+        int byteStride() const;
+    };
+
+    //! Whether the format of the file is supported, judged by its suffix
+    static bool canLoad(const QString &path);
+
+    //! Parses the file, blocks until it is done. Can be called from any thread.
+    static Mesh load(const QString &path);
+
+    /*!
+     * \brief referencedFiles returns the absolute paths of the material libraries and textures the
+     * file references, i.e. of the files the appearance of the mesh depends on besides the file itself.
+     */
+    static QStringList referencedFiles(const QString &path);
+
+private:
+    struct Geometry;
+    static bool loadPly(const uchar *data, qint64 size, const QString &directory,
+                        Geometry &geometry, QString &errorString);
+    static bool loadObj(const uchar *data, qint64 size, const QString &directory,
+                        Geometry &geometry, QString &errorString);
+    static void computeNormals(Geometry &geometry);
+    static void interleave(const Geometry &geometry, Mesh &mesh);
+};
+
+#endif // MESHLOADER_H
@@ -4,40 +4,36 @@
 #include <QUrl>
 
 #include <Qt3DCore/QNode>
-#include <Qt3DCore/QNodeVector>
-#include <Qt3DExtras/QPhongMaterial>
-#include <Qt3DRender/QShaderProgramBuilder>
-#include <Qt3DRender/QEffect>
-#include <Qt3DRender/QParameter>
-#include <Qt3DRender/QShaderProgram>
+#include <Qt3DCore/QTransform>
 #include <Qt3DRender/QGeometryRenderer>
-#include <Qt3DRender/QGeometry>
-#include <Qt3DRender/QAttribute>
-#include <Qt3DExtras/QDiffuseMapMaterial>
-#include <Qt3DExtras/QDiffuseSpecularMapMaterial>
-#include <Qt3DExtras/QNormalDiffuseMapMaterial>
-#include <Qt3DExtras/QNormalDiffuseMapAlphaMaterial>
-#include <Qt3DExtras/QNormalDiffuseSpecularMapMaterial>
 
 ObjectModelRenderable::ObjectModelRenderable(Qt3DCore::QEntity *parent)
     : Qt3DCore::QEntity(parent) {
     initialize();
 }
 
-ObjectModelRenderable::ObjectModelRenderable(Qt3DCore::QEntity *parent, const ObjectModel &objectModel)
-    : Qt3DCore::QEntity(parent) {
+ObjectModelRenderable::ObjectModelRenderable(Qt3DCore::QEntity *parent, const ObjectModel &objectModel,
+                                             bool pickingOnly)
+    : Qt3DCore::QEntity(parent)
+    , m_pickingOnly(pickingOnly) {
     initialize();
     setObjectModel(objectModel);
 }
 
+ObjectModelRenderable::~ObjectModelRenderable() {
+    disconnect(MeshCache::instance(), Q_NULLPTR, this, Q_NULLPTR);
+    if (m_sceneLoader) {
+        // Renderables waiting for the mesh have to load it themselves now
+        MeshCache::instance()->abort(m_objectModelPath);
+    }
+}
+
 void ObjectModelRenderable::initialize() {
-    m_sceneLoader = new Qt3DRender::QSceneLoader(this);
-    this->addComponent(m_sceneLoader);
-    connect(m_sceneLoader, &Qt3DRender::QSceneLoader::statusChanged, this, &ObjectModelRenderable::onSceneLoaderStatusChanged);
+    connect(MeshCache::instance(), &MeshCache::meshLoaded, this, &ObjectModelRenderable::onMeshLoaded);
 }
 
 Qt3DRender::QSceneLoader::Status ObjectModelRenderable::status() const {
-    return m_sceneLoader->status();
+    return m_status;
 }
 
 bool ObjectModelRenderable::isSelected() const {
@@ -51,10 +47,142 @@ bool ObjectModelRenderable::isHovered() const {
     return false;
 }
 
+int ObjectModelRenderable::pickId() const {
+    return m_pickId;
+}
+
+void ObjectModelRenderable::setPickId(int pickId, Qt3DRender::QLayer *pickLayer) {
+    m_pickId = pickId;
+    if (m_pickIdMaterial) {
+        m_pickIdMaterial->setPickId(pickId);
+        return;
+    }
+    m_pickLayer = pickLayer;
+    if (m_meshEntity) {
+        // Otherwise created with the rest of the mesh once it is loaded
+        createPickEntities(m_parts);
+    }
+}
+
 void ObjectModelRenderable::setObjectModel(const ObjectModel &objectModel) {
     m_selected = false;
-    m_sceneLoader->setEnabled(false);
-    m_sceneLoader->setSource(QUrl::fromLocalFile(objectModel.absolutePath()));
+    removeMesh();
+    m_objectModelPath = objectModel.absolutePath();
+    loadMesh();
+}
+
+void ObjectModelRenderable::loadMesh() {
+    MeshCache *meshCache = MeshCache::instance();
+    switch (meshCache->status(m_objectModelPath)) {
+    case MeshCache::Loaded:
+        createMeshEntities();
+        break;
+    case MeshCache::Loading:
+        // Another renderable loads the mesh already, we continue in onMeshLoaded
+        setStatus(Qt3DRender::QSceneLoader::Loading);
+        break;
+    case MeshCache::Failed:
+        setStatus(Qt3DRender::QSceneLoader::Error);
+        break;
+    case MeshCache::NotLoaded: {
+        setStatus(Qt3DRender::QSceneLoader::Loading);
+        if (meshCache->load(m_objectModelPath)) {
+            // Parsed in the background by the cache, we continue in onMeshLoaded
+            break;
+        }
+        meshCache->setLoading(m_objectModelPath);
+        // The loaded scene only fills the cache and is never displayed
+        Qt3DCore::QEntity *sceneLoaderEntity = new Qt3DCore::QEntity(this);
+        m_sceneLoader = new Qt3DRender::QSceneLoader(sceneLoaderEntity);
+        m_sceneLoader->setEnabled(false);
+        sceneLoaderEntity->addComponent(m_sceneLoader);
+        connect(m_sceneLoader, &Qt3DRender::QSceneLoader::statusChanged, this, &ObjectModelRenderable::onSceneLoaderStatusChanged);
+        m_sceneLoader->setSource(QUrl::fromLocalFile(m_objectModelPath));
+        break;
+    }
+    }
+}
+
+void ObjectModelRenderable::createMeshEntities() {
+    m_parts = MeshCache::instance()->parts(m_objectModelPath, this);
+    if (m_parts.isEmpty()) {
+        setStatus(Qt3DRender::QSceneLoader::Error);
+        return;
+    }
+    m_meshEntity = new Qt3DCore::QEntity(this);
+    if (m_pickLayer) {
+        createPickEntities(m_parts);
+    }
+    if (m_pickingOnly) {
+        setStatus(Qt3DRender::QSceneLoader::Ready);
+        return;
+    }
+    for (const MeshCache::Part &part : m_parts) {
+        Qt3DCore::QEntity *partEntity = new Qt3DCore::QEntity(m_meshEntity);
+        // Shared with all other renderables of the same object model in this scene
+        partEntity->addComponent(part.geometryRenderer);
+        if (!part.transform.isIdentity()) {
+            Qt3DCore::QTransform *transform = new Qt3DCore::QTransform(partEntity);
+            transform->setMatrix(part.transform);
+            partEntity->addComponent(transform);
+        }
+        // Our own material is able to visualize clicks, unlike the ones of the scene loader
+        m_material = new ObjectModelRenderableMaterial(partEntity, part.material.textured);
+        if (part.material.textured) {
+            m_material->setAmbient(part.material.ambient);
+            m_material->setDiffuseTexture(part.diffuseTexture);
+            m_material->setTextureScale(part.material.textureScale);
+        }
+        m_material->setSpecular(part.material.specular);
+        // Better visible without shininess
+        m_material->setShininess(0.f);
+        m_material->setSelected(m_selected);
+        partEntity->addComponent(m_material);
+    }
+    setStatus(Qt3DRender::QSceneLoader::Ready);
+}
+
+void ObjectModelRenderable::createPickEntities(const QVector<MeshCache::Part> &parts) {
+    // One material for all parts, the ID identifies the whole renderable
+    m_pickIdMaterial = new PickIdMaterial(m_meshEntity, m_pickId);
+    for (const MeshCache::Part &part : parts) {
+        Qt3DCore::QEntity *pickEntity = new Qt3DCore::QEntity(m_meshEntity);
+        pickEntity->addComponent(part.geometryRenderer);
+        if (!part.transform.isIdentity()) {
+            Qt3DCore::QTransform *transform = new Qt3DCore::QTransform(pickEntity);
+            transform->setMatrix(part.transform);
+            pickEntity->addComponent(transform);
+        }
+        pickEntity->addComponent(m_pickIdMaterial);
+        pickEntity->addComponent(m_pickLayer);
+    }
+}
+
+void ObjectModelRenderable::removeMesh() {
+    // Set before aborting to not react to our own abort in onMeshLoaded
+    m_status = Qt3DRender::QSceneLoader::None;
+    if (m_sceneLoader) {
+        Qt3DCore::QNode *sceneLoaderEntity = m_sceneLoader->parentNode();
+        m_sceneLoader = Q_NULLPTR;
+        sceneLoaderEntity->setParent((Qt3DCore::QNode *) 0);
+        sceneLoaderEntity->deleteLater();
+        MeshCache::instance()->abort(m_objectModelPath);
+    }
+    if (m_meshEntity) {
+        m_meshEntity->setParent((Qt3DCore::QNode *) 0);
+        m_meshEntity->deleteLater();
+        m_meshEntity = Q_NULLPTR;
+        m_pickIdMaterial = Q_NULLPTR;
+    }
+    if (!m_parts.isEmpty()) {
+        m_parts.clear();
+        MeshCache::instance()->release(m_objectModelPath, this);
+    }
+}
+
+void ObjectModelRenderable::setStatus(Qt3DRender::QSceneLoader::Status status) {
+    m_status = status;
+    Q_EMIT statusChanged(status);
 }
 
 void ObjectModelRenderable::setClicks(QList<QVector3D> clicks) {
@@ -91,63 +219,25 @@ void ObjectModelRenderable::setClickCircumference(float circumference) {
 }
 
 void ObjectModelRenderable::onSceneLoaderStatusChanged(Qt3DRender::QSceneLoader::Status status) {
-    /*
-     * This function is ugly but there is no way (that I know of) to get around it.
-     * We have to adjust the shaders of the loaded objects to be able to visualize clicks.
-     */
     if (status == Qt3DRender::QSceneLoader::Ready) {
-        m_sceneLoader->setEnabled(true);
-        Qt3DCore::QEntity *entity = m_sceneLoader->entities()[0];
-        Qt3DCore::QNodeVector children = entity->childNodes();
-        for (Qt3DCore::QNode *node : children) {
-            Qt3DCore::QNodeVector subChildren = node->childNodes();
-            for (Qt3DCore::QNode *subChild : subChildren) {
-                if (Qt3DExtras::QPhongMaterial * phongMaterial = dynamic_cast<Qt3DExtras::QPhongMaterial *>(subChild)) {
-                    // In this case, the scene loader loaded a model without texture. We'll replace that phong material
-                    // with our own that can visualize clicks.
-                    Qt3DCore::QEntity *phongMaterialParent = (Qt3DCore::QEntity *) phongMaterial->parent();
-                    phongMaterialParent->removeComponent(phongMaterial);
-
-                    m_material = new ObjectModelRenderableMaterial(phongMaterialParent, false);
-                    m_material->setSpecular(phongMaterial->specular());
-                    // Better visible without shininess
-                    m_material->setShininess(0.f);
-                    m_material->setSelected(m_selected);
-
-                    phongMaterialParent->addComponent(m_material);
-                }
-
-                Qt3DCore::QEntity *subChildEntity = (Qt3DCore::QEntity *)subChild;
-                Qt3DCore::QNodeVector subSubChildren = subChild->childNodes();
-                for (Qt3DCore::QNode *subSubChild : subSubChildren) {
-                    bool isMaterial = false;
-                    // In this case we have a textured object
-                    // This is ugly but as long as the shader graphs don't support arrays (i.e. vec3 clicks[10]) we have to check
-                    // all the default materials so that the objects get rendered properly
-                    if (dynamic_cast<Qt3DExtras::QDiffuseMapMaterial *>(subSubChild) ||
-                        dynamic_cast<Qt3DExtras::QDiffuseSpecularMapMaterial *>(subSubChild) ||
-                        dynamic_cast<Qt3DExtras::QNormalDiffuseMapMaterial *>(subSubChild) ||
-                        dynamic_cast<Qt3DExtras::QNormalDiffuseMapAlphaMaterial *>(subSubChild) ||
-                        dynamic_cast<Qt3DExtras::QNormalDiffuseSpecularMapMaterial *>(subSubChild)) {
-                        m_material = new ObjectModelRenderableMaterial(subChildEntity, true);
-                        m_material->setAmbient(subSubChild->property("ambient").value<QColor>());
-                        m_material->setDiffuseTexture(subSubChild->property("diffuse").value<Qt3DRender::QAbstractTexture*>());
-                        m_material->setSpecular(subSubChild->property("specular").value<QColor>());
-                        // Better visible without shininess
-                        m_material->setShininess(0.f);
-                        m_material->setTextureScale(subSubChild->property("textureScale").toFloat());
-                        m_material->setSelected(m_selected);
-                        isMaterial = true;
-                    }
-                    if (isMaterial) {
-                        Qt3DCore::QComponent *oldMaterial = dynamic_cast<Qt3DCore::QComponent *>(subSubChild);
-                        subChildEntity->removeComponent(oldMaterial);
-                        oldMaterial->deleteLater();
-                        subChildEntity->addComponent(m_material);
-                    }
-                }
-            }
-        }
+        // Leads to onMeshLoaded, which removes the scene loader again
+        MeshCache::instance()->insert(m_objectModelPath, m_sceneLoader);
+    } else if (status == Qt3DRender::QSceneLoader::Error) {
+        MeshCache::instance()->setFailed(m_objectModelPath);
     }
-    Q_EMIT statusChanged(status);
+}
+
+void ObjectModelRenderable::onMeshLoaded(const QString &path) {
+    if (path != m_objectModelPath || m_status != Qt3DRender::QSceneLoader::Loading) {
+        return;
+    }
+    if (m_sceneLoader) {
+        // Not needed anymore, the cache holds the mesh now
+        Qt3DCore::QNode *sceneLoaderEntity = m_sceneLoader->parentNode();
+        m_sceneLoader = Q_NULLPTR;
+        sceneLoaderEntity->setParent((Qt3DCore::QNode *) 0);
+        sceneLoaderEntity->deleteLater();
+    }
+    // Loads the mesh ourselves if the renderable that loaded it has been removed in the meantime
+    loadMesh();
 }
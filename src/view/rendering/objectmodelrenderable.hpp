@@ -4,6 +4,8 @@
 #include "misc/global.hpp"
 #include "model/objectmodel.hpp"
 #include "view/rendering/objectmodelrenderablematerial.hpp"
+#include "view/rendering/pickidmaterial.hpp"
+#include "view/rendering/meshcache.hpp"
 
 #include <QObject>
 #include <QVector3D>
@@ -15,8 +17,13 @@
 #include <Qt3DCore/QEntity>
 #include <Qt3DRender/QSceneLoader>
 #include <Qt3DRender/QTexture>
+#include <Qt3DRender/QLayer>
 #include <Qt3DRender/QObjectPicker>
 
+/*!
+ * \brief The ObjectModelRenderable class displays an object model. The mesh is obtained from the
+ * MeshCache, i.e. renderables of the same object model share their geometry.
+ */
 class ObjectModelRenderable : public Qt3DCore::QEntity
 {
     Q_OBJECT
@@ -31,10 +38,24 @@ Q_SIGNALS:
 
 public:
     ObjectModelRenderable(Qt3DCore::QEntity *parent);
-    ObjectModelRenderable(Qt3DCore::QEntity *parent, const ObjectModel &m_objectModel);
+    /*!
+     * \param pickingOnly renderables that are only used for picking are only drawn into the ID
+     * buffer (see setPickId), e.g. because their object model is drawn by a PoseInstancesRenderable
+     */
+    ObjectModelRenderable(Qt3DCore::QEntity *parent, const ObjectModel &m_objectModel,
+                          bool pickingOnly = false);
+    ~ObjectModelRenderable();
     Qt3DRender::QSceneLoader::Status status() const;
     bool isSelected() const;
     bool isHovered() const;
+    int pickId() const;
+    /*!
+     * \brief setPickId additionally draws the mesh with a PickIdMaterial into the entities of the
+     * pick layer, which only the ID buffer pass of the framegraph renders.
+     * \param pickId must be greater than 0
+     * \param pickLayer only the pick ID can be changed afterwards, not the layer
+     */
+    void setPickId(int pickId, Qt3DRender::QLayer *pickLayer);
 
 public Q_SLOTS:
     void setObjectModel(const ObjectModel &m_objectModel);
@@ -46,16 +67,33 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void onSceneLoaderStatusChanged(Qt3DRender::QSceneLoader::Status status);
+    void onMeshLoaded(const QString &path);
 
 private:
     bool m_selected = false;
+    bool m_pickingOnly = false;
+    int m_pickId = 0;
+    Qt3DRender::QLayer *m_pickLayer = Q_NULLPTR;
     QTimer timer;
 
+    QString m_objectModelPath;
+    Qt3DRender::QSceneLoader::Status m_status = Qt3DRender::QSceneLoader::None;
+    //! Only set while this renderable loads a mesh the MeshLoader can't parse for the MeshCache
     QPointer<Qt3DRender::QSceneLoader> m_sceneLoader;
+    //! Holds the entities of the parts of the mesh
+    QPointer<Qt3DCore::QEntity> m_meshEntity;
+    //! Referenced in the MeshCache as long as the mesh entity exists
+    QVector<MeshCache::Part> m_parts;
     QPointer<ObjectModelRenderableMaterial> m_material;
+    QPointer<PickIdMaterial> m_pickIdMaterial;
     Qt3DRender::QObjectPicker *m_picker;
 
     void initialize();
+    void loadMesh();
+    void createMeshEntities();
+    void createPickEntities(const QVector<MeshCache::Part> &parts);
+    void removeMesh();
+    void setStatus(Qt3DRender::QSceneLoader::Status status);
 };
 
 #endif // OBJECTRENDERABLE_H
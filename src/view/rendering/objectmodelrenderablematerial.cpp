@@ -6,7 +6,8 @@
 #include <Qt3DRender/QGraphicsApiFilter>
 #include <Qt3DRender/QAbstractTextureImage>
 
-ObjectModelRenderableMaterial::ObjectModelRenderableMaterial(Qt3DCore::QNode *parent, bool withTexture)
+ObjectModelRenderableMaterial::ObjectModelRenderableMaterial(Qt3DCore::QNode *parent, bool withTexture,
+                                                             bool instanced)
     : Qt3DRender::QMaterial(parent)
       , m_effect(new Qt3DRender::QEffect())
       , m_diffuseTexture(new Qt3DRender::QTexture2D())
@@ -30,7 +31,13 @@ ObjectModelRenderableMaterial::ObjectModelRenderableMaterial(Qt3DCore::QNode *pa
       , m_blendState(new Qt3DRender::QBlendEquationArguments())
       , m_blendEquation(new Qt3DRender::QBlendEquation())
 {
-    m_shaderProgram->setVertexShaderCode(Qt3DRender::QShaderProgram::loadSource(QUrl(QStringLiteral("qrc:/shaders/object.vert"))));
+    if (instanced) {
+        m_shaderProgram->setVertexShaderCode(Qt3DRender::QShaderProgram::loadSource(QUrl(QStringLiteral("qrc:/shaders/object_instanced.vert"))));
+        // Only masks the highlight colors of the instances
+        m_highlightColorParameter->setValue(QVector4D(1.f, 1.f, 1.f, 1.f));
+    } else {
+        m_shaderProgram->setVertexShaderCode(Qt3DRender::QShaderProgram::loadSource(QUrl(QStringLiteral("qrc:/shaders/object.vert"))));
+    }
     m_shaderProgram->setFragmentShaderCode(Qt3DRender::QShaderProgram::loadSource(QUrl(QStringLiteral("qrc:/shaders/object.frag"))));
 
     m_effect->addParameter(m_diffuseParameter);
@@ -106,7 +113,15 @@ bool ObjectModelRenderableMaterial::isSelected() const {
 }
 
 bool ObjectModelRenderableMaterial::isHovered() const {
+    return m_hovered;
+}
 
+QVector4D ObjectModelRenderableMaterial::selectedColor() const {
+    return m_selectedColor;
+}
+
+QVector4D ObjectModelRenderableMaterial::highlightColor() const {
+    return m_highlightColor;
 }
 
 void ObjectModelRenderableMaterial::setAmbient(const QColor &color) {
@@ -125,7 +140,10 @@ void ObjectModelRenderableMaterial::setShininess(float shininess) {
 }
 
 void ObjectModelRenderableMaterial::setDiffuseTexture(Qt3DRender::QAbstractTexture *diffuse) {
-    diffuse->setParent(this);
+    // Textures shared by several materials are owned by someone else already
+    if (!diffuse->parent()) {
+        diffuse->setParent(this);
+    }
     m_diffuseTextureParameter->setValue(QVariant::fromValue(diffuse));
     Q_EMIT diffuseChanged(diffuse);
 }
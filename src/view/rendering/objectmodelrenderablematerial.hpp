@@ -28,7 +28,12 @@ class ObjectModelRenderableMaterial : public Qt3DRender::QMaterial
     Q_PROPERTY(bool highlightColor READ isSelected WRITE setSelected NOTIFY selectedChanged)
 
 public:
-    ObjectModelRenderableMaterial(Qt3DCore::QNode *parent = nullptr, bool withTexture = true);
+    /*!
+     * \param instanced whether the material draws the poses of a PoseInstancesRenderable, their
+     * highlight color and opacity are set per instance then instead of through this material
+     */
+    ObjectModelRenderableMaterial(Qt3DCore::QNode *parent = nullptr, bool withTexture = true,
+                                  bool instanced = false);
     ~ObjectModelRenderableMaterial();
 
     QColor ambient() const;
@@ -38,6 +43,8 @@ public:
     float textureScale() const;
     bool isSelected() const;
     bool isHovered() const;
+    QVector4D selectedColor() const;
+    QVector4D highlightColor() const;
 
 public Q_SLOTS:
     void setAmbient(const QColor &color);
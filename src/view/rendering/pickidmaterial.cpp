@@ -0,0 +1,51 @@
+#include "pickidmaterial.hpp"
+
+#include <QUrl>
+
+#include <Qt3DRender/QGraphicsApiFilter>
+
+PickIdMaterial::PickIdMaterial(Qt3DCore::QNode *parent, int pickId)
+    : Qt3DRender::QMaterial(parent)
+    , m_pickId(pickId)
+    , m_effect(new Qt3DRender::QEffect())
+    , m_technique(new Qt3DRender::QTechnique())
+    , m_renderPass(new Qt3DRender::QRenderPass())
+    , m_shaderProgram(new Qt3DRender::QShaderProgram())
+    , m_filterKey(new Qt3DRender::QFilterKey)
+    // Floats represent all integers up to 2^24 exactly
+    , m_pickIdParameter(new Qt3DRender::QParameter(QStringLiteral("pickId"), (float) pickId)) {
+
+    m_shaderProgram->setVertexShaderCode(Qt3DRender::QShaderProgram::loadSource(QUrl(QStringLiteral("qrc:/shaders/pickid.vert"))));
+    m_shaderProgram->setFragmentShaderCode(Qt3DRender::QShaderProgram::loadSource(QUrl(QStringLiteral("qrc:/shaders/pickid.frag"))));
+
+    m_technique->graphicsApiFilter()->setApi(Qt3DRender::QGraphicsApiFilter::OpenGL);
+    m_technique->graphicsApiFilter()->setMajorVersion(3);
+    m_technique->graphicsApiFilter()->setMinorVersion(1);
+    m_technique->graphicsApiFilter()->setProfile(Qt3DRender::QGraphicsApiFilter::CoreProfile);
+
+    m_filterKey->setParent(this);
+    m_filterKey->setName(QStringLiteral("renderingStyle"));
+    m_filterKey->setValue(QStringLiteral("forward"));
+
+    m_technique->addFilterKey(m_filterKey);
+
+    // No blending, the IDs must not be mixed
+    m_renderPass->setShaderProgram(m_shaderProgram);
+
+    m_technique->addRenderPass(m_renderPass);
+
+    m_effect->addTechnique(m_technique);
+
+    m_effect->addParameter(m_pickIdParameter);
+
+    setEffect(m_effect);
+}
+
+int PickIdMaterial::pickId() const {
+    return m_pickId;
+}
+
+void PickIdMaterial::setPickId(int pickId) {
+    m_pickId = pickId;
+    m_pickIdParameter->setValue((float) pickId);
+}
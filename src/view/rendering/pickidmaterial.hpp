@@ -0,0 +1,42 @@
+#ifndef PICKIDMATERIAL_H
+#define PICKIDMATERIAL_H
+
+#include <QObject>
+
+#include <Qt3DCore/QNode>
+#include <Qt3DRender/QMaterial>
+#include <Qt3DRender/QTechnique>
+#include <Qt3DRender/QEffect>
+#include <Qt3DRender/QRenderPass>
+#include <Qt3DRender/QShaderProgram>
+#include <Qt3DRender/QFilterKey>
+#include <Qt3DRender/QParameter>
+
+/*!
+ * \brief The PickIdMaterial class draws an entity into the ID buffer that the PoseViewer3DWidget
+ * picks poses from. Every fragment stores the pick ID of the entity in the red channel and its
+ * window depth in the green channel, i.e. the depth QVector3D::project returns.
+ *
+ * A pick ID of 0 is reserved for the cleared buffer, i.e. for no entity.
+ */
+class PickIdMaterial : public Qt3DRender::QMaterial
+{
+    Q_OBJECT
+public:
+    PickIdMaterial(Qt3DCore::QNode *parent = Q_NULLPTR, int pickId = 0);
+    int pickId() const;
+    void setPickId(int pickId);
+
+private:
+    int m_pickId;
+
+    Qt3DRender::QEffect *m_effect;
+    Qt3DRender::QTechnique *m_technique;
+    Qt3DRender::QRenderPass *m_renderPass;
+    Qt3DRender::QShaderProgram *m_shaderProgram;
+    Qt3DRender::QFilterKey *m_filterKey;
+
+    Qt3DRender::QParameter *m_pickIdParameter;
+};
+
+#endif // PICKIDMATERIAL_H
@@ -0,0 +1,206 @@
+#include "poseinstancesrenderable.hpp"
+#include "view/rendering/meshcache.hpp"
+
+#include <QMatrix4x4>
+
+#include <algorithm>
+
+#include <Qt3DCore/QTransform>
+#include <Qt3DRender/QAttribute>
+#include <Qt3DRender/QGeometry>
+
+//! 16 floats model matrix, 4 floats highlight color, 1 float opacity and 3 floats padding
+static const int FLOATS_PER_INSTANCE = 24;
+static const int BYTES_PER_INSTANCE = FLOATS_PER_INSTANCE * sizeof(float);
+
+PoseInstancesRenderable::PoseInstancesRenderable(Qt3DCore::QEntity *parent, const ObjectModel &objectModel)
+    : Qt3DCore::QEntity(parent)
+    , m_objectModelPath(objectModel.absolutePath())
+    , m_instanceBuffer(new Qt3DRender::QBuffer(this)) {
+    connect(MeshCache::instance(), &MeshCache::meshLoaded, this, &PoseInstancesRenderable::onMeshLoaded);
+    // Otherwise the pose renderables that are used for picking load it
+    if (MeshCache::instance()->status(m_objectModelPath) == MeshCache::Loaded) {
+        createPartEntities();
+    }
+}
+
+void PoseInstancesRenderable::addPose(PosePtr pose) {
+    addPoses({pose});
+}
+
+void PoseInstancesRenderable::addPoses(const QList<PosePtr> &poses) {
+    for (const PosePtr &pose : poses) {
+        const Pose *posePointer = pose.get();
+        if (m_instanceIndices.contains(posePointer)) {
+            continue;
+        }
+        m_instanceIndices.insert(posePointer, m_instances.size());
+        m_instances.append({pose, false, false});
+        connect(pose.get(), &Pose::positionChanged, this, [this, posePointer]() {
+            updateInstance(indexOfPose(posePointer));
+        });
+        connect(pose.get(), &Pose::rotationChanged, this, [this, posePointer]() {
+            updateInstance(indexOfPose(posePointer));
+        });
+    }
+    updateInstances();
+}
+
+void PoseInstancesRenderable::removePose(PosePtr pose) {
+    int index = indexOfPose(pose.get());
+    if (index == -1) {
+        return;
+    }
+    disconnect(pose.get(), Q_NULLPTR, this, Q_NULLPTR);
+    m_instanceIndices.remove(pose.get());
+    // The order of the instances doesn't matter, moving the last one keeps the other indices valid
+    const int lastIndex = m_instances.size() - 1;
+    if (index != lastIndex) {
+        m_instances.swapItemsAt(index, lastIndex);
+        m_instanceIndices[m_instances[index].pose.get()] = index;
+    }
+    m_instances.removeLast();
+    updateInstances();
+}
+
+int PoseInstancesRenderable::poseCount() const {
+    return m_instances.size();
+}
+
+void PoseInstancesRenderable::setSelected(PosePtr pose, bool selected) {
+    int index = indexOfPose(pose.get());
+    if (index != -1) {
+        m_instances[index].selected = selected;
+        updateInstance(index);
+    }
+}
+
+void PoseInstancesRenderable::setHovered(PosePtr pose, bool hovered) {
+    int index = indexOfPose(pose.get());
+    if (index != -1) {
+        m_instances[index].hovered = hovered;
+        updateInstance(index);
+    }
+}
+
+void PoseInstancesRenderable::setOpacity(float opacity) {
+    m_opacity = opacity;
+    updateInstances();
+}
+
+void PoseInstancesRenderable::onMeshLoaded(const QString &path) {
+    if (path == m_objectModelPath && m_geometryRenderers.isEmpty()
+            && MeshCache::instance()->status(m_objectModelPath) == MeshCache::Loaded) {
+        createPartEntities();
+    }
+}
+
+void PoseInstancesRenderable::createPartEntities() {
+    for (const MeshCache::Part &part : MeshCache::instance()->parts(m_objectModelPath, this)) {
+        Qt3DCore::QEntity *partEntity = new Qt3DCore::QEntity(this);
+
+        // The vertex attributes are the ones of the shared geometry, only the instance
+        // attributes are our own
+        Qt3DRender::QGeometry *geometry = new Qt3DRender::QGeometry(partEntity);
+        for (Qt3DRender::QAttribute *attribute : part.geometryRenderer->geometry()->attributes()) {
+            geometry->addAttribute(attribute);
+        }
+        const QList<QPair<QString, QPair<uint, uint>>> instanceAttributes({
+            qMakePair(QStringLiteral("instanceModelMatrix"), qMakePair(16u, 0u)),
+            qMakePair(QStringLiteral("instanceHighlightColor"), qMakePair(4u, 16u)),
+            qMakePair(QStringLiteral("instanceOpacity"), qMakePair(1u, 20u))});
+        for (const auto &instanceAttribute : instanceAttributes) {
+            Qt3DRender::QAttribute *attribute = new Qt3DRender::QAttribute(geometry);
+            attribute->setName(instanceAttribute.first);
+            attribute->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
+            attribute->setVertexBaseType(Qt3DRender::QAttribute::Float);
+            attribute->setVertexSize(instanceAttribute.second.first);
+            attribute->setByteOffset(instanceAttribute.second.second * sizeof(float));
+            attribute->setByteStride(BYTES_PER_INSTANCE);
+            attribute->setDivisor(1);
+            attribute->setBuffer(m_instanceBuffer);
+            geometry->addAttribute(attribute);
+        }
+
+        Qt3DRender::QGeometryRenderer *geometryRenderer = new Qt3DRender::QGeometryRenderer(partEntity);
+        geometryRenderer->setGeometry(geometry);
+        geometryRenderer->setPrimitiveType(part.geometryRenderer->primitiveType());
+        geometryRenderer->setVertexCount(part.geometryRenderer->vertexCount());
+        geometryRenderer->setIndexOffset(part.geometryRenderer->indexOffset());
+        geometryRenderer->setFirstVertex(part.geometryRenderer->firstVertex());
+        geometryRenderer->setInstanceCount(m_instances.size());
+        partEntity->addComponent(geometryRenderer);
+        m_geometryRenderers.append(geometryRenderer);
+
+        if (!part.transform.isIdentity()) {
+            Qt3DCore::QTransform *transform = new Qt3DCore::QTransform(partEntity);
+            transform->setMatrix(part.transform);
+            partEntity->addComponent(transform);
+        }
+
+        ObjectModelRenderableMaterial *material =
+                new ObjectModelRenderableMaterial(partEntity, part.material.textured, true);
+        if (part.material.textured) {
+            material->setAmbient(part.material.ambient);
+            material->setDiffuseTexture(part.diffuseTexture);
+            material->setTextureScale(part.material.textureScale);
+        }
+        material->setSpecular(part.material.specular);
+        // Better visible without shininess
+        material->setShininess(0.f);
+        m_selectedColor = material->selectedColor();
+        m_highlightColor = material->highlightColor();
+        partEntity->addComponent(material);
+    }
+    // The highlight colors are known now
+    updateInstances();
+}
+
+int PoseInstancesRenderable::indexOfPose(const Pose *pose) const {
+    return m_instanceIndices.value(pose, -1);
+}
+
+void PoseInstancesRenderable::writeInstance(int index) {
+    const Instance &instance = m_instances[index];
+    QMatrix4x4 modelMatrix;
+    modelMatrix.translate(instance.pose->position());
+    modelMatrix.rotate(instance.pose->rotation());
+    // Like the material, hovering is not shown for the selected pose
+    QVector4D highlightColor;
+    if (instance.selected) {
+        highlightColor = m_selectedColor;
+    } else if (instance.hovered) {
+        highlightColor = m_highlightColor;
+    }
+
+    float *data = reinterpret_cast<float*>(m_instanceData.data()) + index * FLOATS_PER_INSTANCE;
+    // Column-major like OpenGL expects it
+    std::copy(modelMatrix.constData(), modelMatrix.constData() + 16, data);
+    data[16] = highlightColor.x();
+    data[17] = highlightColor.y();
+    data[18] = highlightColor.z();
+    data[19] = highlightColor.w();
+    data[20] = m_opacity;
+}
+
+void PoseInstancesRenderable::updateInstance(int index) {
+    if (index < 0 || index >= m_instances.size()) {
+        return;
+    }
+    writeInstance(index);
+    m_instanceBuffer->updateData(index * BYTES_PER_INSTANCE,
+                                 m_instanceData.mid(index * BYTES_PER_INSTANCE, BYTES_PER_INSTANCE));
+}
+
+void PoseInstancesRenderable::updateInstances() {
+    m_instanceData.fill(0, m_instances.size() * BYTES_PER_INSTANCE);
+    for (int index = 0; index < m_instances.size(); index++) {
+        writeInstance(index);
+    }
+    m_instanceBuffer->setData(m_instanceData);
+    for (const QPointer<Qt3DRender::QGeometryRenderer> &geometryRenderer : m_geometryRenderers) {
+        if (geometryRenderer) {
+            geometryRenderer->setInstanceCount(m_instances.size());
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef POSEINSTANCESRENDERABLE_H
+#define POSEINSTANCESRENDERABLE_H
+
+#include "model/pose.hpp"
+#include "model/objectmodel.hpp"
+#include "view/rendering/objectmodelrenderablematerial.hpp"
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QVector4D>
+#include <QByteArray>
+#include <QPointer>
+
+#include <Qt3DCore/QEntity>
+#include <Qt3DRender/QBuffer>
+#include <Qt3DRender/QGeometryRenderer>
+
+//!
+//! \brief The PoseInstancesRenderable class draws all poses of one object model with a single
+//! instanced draw call per part of the object model, instead of one draw call per pose.
+//!
+//! The transformation, highlight color and opacity of the poses are stored in an instance
+//! buffer. The renderable doesn't support picking, the poses need PoseRenderables that are only
+//! used for picking in addition. These also load the mesh into the MeshCache.
+//!
+class PoseInstancesRenderable : public Qt3DCore::QEntity
+{
+    Q_OBJECT
+
+public:
+    PoseInstancesRenderable(Qt3DCore::QEntity *parent, const ObjectModel &objectModel);
+
+    void addPose(PosePtr pose);
+    //! Uploads the instances only once for all poses
+    void addPoses(const QList<PosePtr> &poses);
+    void removePose(PosePtr pose);
+    int poseCount() const;
+
+    void setSelected(PosePtr pose, bool selected);
+    void setHovered(PosePtr pose, bool hovered);
+    //! Sets the opacity of all poses
+    void setOpacity(float opacity);
+
+private Q_SLOTS:
+    void onMeshLoaded(const QString &path);
+
+private:
+    struct Instance {
+        PosePtr pose;
+        bool selected;
+        bool hovered;
+    };
+
+    void createPartEntities();
+    int indexOfPose(const Pose *pose) const;
+    //! Writes the instance into the instance data and uploads it
+    void updateInstance(int index);
+    void writeInstance(int index);
+    //! Uploads all instances after instances have been added or removed
+    void updateInstances();
+
+private:
+    QString m_objectModelPath;
+    QList<Instance> m_instances;
+    //! The index of every pose in the instances
+    QHash<const Pose*, int> m_instanceIndices;
+    //! The highlight colors are the same for all materials
+    QVector4D m_selectedColor;
+    QVector4D m_highlightColor;
+    float m_opacity = 1.f;
+
+    //! Per instance: the model matrix, the highlight color and the opacity, padded to 96 bytes
+    QByteArray m_instanceData;
+    Qt3DRender::QBuffer *m_instanceBuffer;
+    QList<QPointer<Qt3DRender::QGeometryRenderer>> m_geometryRenderers;
+};
+
+#endif // POSEINSTANCESRENDERABLE_H
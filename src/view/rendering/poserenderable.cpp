@@ -1,29 +1,14 @@
 #include "poserenderable.hpp"
 
 PoseRenderable::PoseRenderable(Qt3DCore::QEntity *parent,
-                               PosePtr pose) :
-        ObjectModelRenderable(parent, *pose->objectModel()),
+                               PosePtr pose,
+                               bool pickingOnly) :
+        ObjectModelRenderable(parent, *pose->objectModel(), pickingOnly),
         m_pose(pose),
-        m_picker(new Qt3DRender::QObjectPicker),
         m_transform(new Qt3DCore::QTransform) {
     m_transform->setRotation(pose->rotation());
     m_transform->setTranslation(pose->position());
     addComponent(m_transform);
-    addComponent(m_picker);
-    m_picker->setHoverEnabled(true);
-    m_picker->setDragEnabled(true);
-    connect(m_picker, &Qt3DRender::QObjectPicker::clicked,
-            this, &PoseRenderable::clicked);
-    connect(m_picker, &Qt3DRender::QObjectPicker::moved,
-            this, &PoseRenderable::moved);
-    connect(m_picker, &Qt3DRender::QObjectPicker::pressed,
-            this, &PoseRenderable::pressed);
-    connect(m_picker, &Qt3DRender::QObjectPicker::released,
-            this, &PoseRenderable::released);
-    connect(m_picker, &Qt3DRender::QObjectPicker::entered,
-            this, &PoseRenderable::entered);
-    connect(m_picker, &Qt3DRender::QObjectPicker::exited,
-            this, &PoseRenderable::exited);
     connect(pose.get(), &Pose::positionChanged,
             m_transform, &Qt3DCore::QTransform::setTranslation);
     connect(pose.get(), &Pose::rotationChanged,
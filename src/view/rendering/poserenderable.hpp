@@ -10,22 +10,24 @@
 #include <QMatrix3x3>
 #include <QMatrix4x4>
 
-#include <Qt3DRender/QPickEvent>
 #include <Qt3DCore/QEntity>
 #include <Qt3DCore/QTransform>
-#include <Qt3DRender/QObjectPicker>
 
 //!
 //! \brief The PoseRenderable class is only an object model renderable
 //! essentially (i.e. displays an object model) but takes in a pose
 //! to compute the position of the object according to the pose.
 //!
+//! The renderable has no object picker, the PoseViewer3DWidget picks
+//! poses from an ID buffer instead (see ObjectModelRenderable::setPickId).
+//!
 class PoseRenderable : public ObjectModelRenderable
 {
     Q_OBJECT
 
 public:
-    PoseRenderable(Qt3DCore::QEntity *parent, PosePtr pose);
+    //! \param pickingOnly see ObjectModelRenderable
+    PoseRenderable(Qt3DCore::QEntity *parent, PosePtr pose, bool pickingOnly = false);
 
     QString poseID();
     ObjectModelPtr objectModel();
@@ -36,18 +38,9 @@ public:
 
     PosePtr pose() const;
 
-Q_SIGNALS:
-    void clicked(Qt3DRender::QPickEvent *pickEvent);
-    void moved(Qt3DRender::QPickEvent *pickEvent);
-    void pressed(Qt3DRender::QPickEvent *pickEvent);
-    void released(Qt3DRender::QPickEvent *pickEvent);
-    void entered();
-    void exited();
-
 private:
     PosePtr m_pose;
 
-    Qt3DRender::QObjectPicker *m_picker;
     Qt3DCore::QTransform *m_transform;
 };
 
@@ -42,6 +42,11 @@ void SettingsInterfacePage::setSettings(Settings* settings) {
     ui->doubleSpinBoxClick3DCircumference->setValue(settings->click3DSize());
     ui->checkBoxShowFPSLabel->setChecked(settings->showFPSLabel());
     ui->comboBoxMultisampling->setCurrentIndex(settings->multisampleSamples());
+    ui->spinBoxThumbnailCacheSize->setValue(settings->thumbnailCacheSize());
+    ui->checkBoxInstancedRendering->setChecked(settings->instancedRendering());
+    ui->checkBoxContinuousRendering->setChecked(settings->continuousRendering());
+    ui->spinBoxPrefetchWindow->setValue(settings->prefetchWindow());
+    ui->checkBoxAdaptiveResolution->setChecked(settings->adaptiveResolution());
 }
 
 void SettingsInterfacePage::comboBoxAddCorrespondencePointSelectedIndexChanged(int index) {
@@ -90,6 +95,36 @@ void SettingsInterfacePage::checkBoxShowFPSLabelStateChanged(int state) {
     settings->setShowFPSLabel(state == Qt::Checked);
 }
 
+void SettingsInterfacePage::spinBoxThumbnailCacheSizeValueChanged(int value) {
+    if (settings) {
+        settings->setThumbnailCacheSize(value);
+    }
+}
+
+void SettingsInterfacePage::checkBoxInstancedRenderingStateChanged(int state) {
+    if (settings) {
+        settings->setInstancedRendering(state == Qt::Checked);
+    }
+}
+
+void SettingsInterfacePage::checkBoxContinuousRenderingStateChanged(int state) {
+    if (settings) {
+        settings->setContinuousRendering(state == Qt::Checked);
+    }
+}
+
+void SettingsInterfacePage::spinBoxPrefetchWindowValueChanged(int value) {
+    if (settings) {
+        settings->setPrefetchWindow(value);
+    }
+}
+
+void SettingsInterfacePage::checkBoxAdaptiveResolutionStateChanged(int state) {
+    if (settings) {
+        settings->setAdaptiveResolution(state == Qt::Checked);
+    }
+}
+
 void SettingsInterfacePage::setComboBoxSelectedForMouseButton(QComboBox *comboBox, Qt::MouseButton button) {
     int index = Settings::MOUSE_BUTTONS[button];
     comboBox->setCurrentIndex(index);
@@ -31,6 +31,11 @@ private Q_SLOTS:
     void doubleSpinBoxClick3DCircumferenceChanged(double value);
     void comboBoxMultisampleSamlpesSelectedIndexChanged(int index);
     void checkBoxShowFPSLabelStateChanged(int state);
+    void spinBoxThumbnailCacheSizeValueChanged(int value);
+    void checkBoxInstancedRenderingStateChanged(int state);
+    void checkBoxContinuousRenderingStateChanged(int state);
+    void spinBoxPrefetchWindowValueChanged(int value);
+    void checkBoxAdaptiveResolutionStateChanged(int state);
 
 private:
     void setComboBoxSelectedForMouseButton(QComboBox *comboBox, Qt::MouseButton button);
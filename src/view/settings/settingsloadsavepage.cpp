@@ -14,6 +14,7 @@ SettingsLoadSavePage::SettingsLoadSavePage(QWidget *parent) :
     DisplayHelper::setIcon(ui->buttonPythonScript, fa::folderopen, 20);
     DisplayHelper::setIcon(ui->buttonPythonScriptHelp, fa::infocircle, 20);
     DisplayHelper::setIcon(ui->buttonDefaultJsonHelp, fa::infocircle, 20);
+    DisplayHelper::setIcon(ui->buttonJournalHelp, fa::infocircle, 20);
 }
 
 SettingsLoadSavePage::~SettingsLoadSavePage() {
@@ -26,9 +27,15 @@ void SettingsLoadSavePage::setSettings(Settings *settings) {
                                        == Settings::UsedLoadAndStoreStrategy::Default);
     ui->radioButtonPythonScript->setChecked(settings->usedLoadAndStoreStrategy()
                                        == Settings::UsedLoadAndStoreStrategy::Python);
+    ui->radioButtonJournal->setChecked(settings->usedLoadAndStoreStrategy()
+                                       == Settings::UsedLoadAndStoreStrategy::Journal);
     QString scriptPath = (settings->loadSaveScriptPath() != Global::NO_PATH ?
                           settings->loadSaveScriptPath() : PLEASE_SELECT_A_PYTHON_SCRIPT);
     ui->editPythonScriptPath->setText(scriptPath);
+    ui->spinBoxLoadingThreads->setValue(settings->loadingThreadCount());
+    ui->checkBoxLazyPoseLoading->setChecked(settings->lazyPoseLoading());
+    ui->spinBoxPoseCacheSize->setValue(settings->poseCacheSize());
+    ui->spinBoxPoseCacheSize->setEnabled(settings->lazyPoseLoading());
 }
 
 void SettingsLoadSavePage::radioButtonDefaultClicked() {
@@ -39,6 +46,23 @@ void SettingsLoadSavePage::radioButtonPythonScriptClicked() {
     settings->setUsedLoadAndStoreStrategy(Settings::UsedLoadAndStoreStrategy::Python);
 }
 
+void SettingsLoadSavePage::radioButtonJournalClicked() {
+    settings->setUsedLoadAndStoreStrategy(Settings::UsedLoadAndStoreStrategy::Journal);
+}
+
+void SettingsLoadSavePage::spinBoxLoadingThreadsValueChanged(int value) {
+    settings->setLoadingThreadCount(value);
+}
+
+void SettingsLoadSavePage::checkBoxLazyPoseLoadingStateChanged(int state) {
+    settings->setLazyPoseLoading(state == Qt::Checked);
+    ui->spinBoxPoseCacheSize->setEnabled(state == Qt::Checked);
+}
+
+void SettingsLoadSavePage::spinBoxPoseCacheSizeValueChanged(int value) {
+    settings->setPoseCacheSize(value);
+}
+
 void SettingsLoadSavePage::buttonPythonScriptClicked() {
     QString newPath;
     if (settings->loadSaveScriptPath() != Global::NO_PATH) {
@@ -89,3 +113,16 @@ QString SettingsLoadSavePage::openFileDialogForPath(QString path) {
 }
 
 const QString SettingsLoadSavePage::PLEASE_SELECT_A_PYTHON_SCRIPT = "Select a Python script...";
+
+void SettingsLoadSavePage::buttonJournalHelpClicked() {
+    QString title = "JSON loader with journal";
+    QString message = "This loader reads the same JSON files as the default JSON loader "
+                      "but does not rewrite the ground truth file on every save. Changes "
+                      "are appended to a journal file next to it (e.g. gt.json.journal) "
+                      "which is merged into the ground truth file in the background once "
+                      "it grows too large. Use this for datasets with many poses. Keep the "
+                      "journal file together with the ground truth file when copying it.";
+    std::unique_ptr<QMessageBox> messageBox = DisplayHelper::messageBox(
+                this, QMessageBox::Information, title, message, "OK", QMessageBox::AcceptRole);
+    messageBox->exec();
+}
@@ -21,9 +21,14 @@ public:
 private Q_SLOTS:
     void radioButtonDefaultClicked();
     void radioButtonPythonScriptClicked();
+    void radioButtonJournalClicked();
     void buttonPythonScriptClicked();
     void buttonDefaultJsonHelpClicked();
     void buttonPythonScriptHelpClicked();
+    void buttonJournalHelpClicked();
+    void spinBoxLoadingThreadsValueChanged(int value);
+    void checkBoxLazyPoseLoadingStateChanged(int state);
+    void spinBoxPoseCacheSizeValueChanged(int value);
 
 private:
     QString openFileDialogForPath(QString path);
@@ -9,6 +9,7 @@ HEADERS += \
     view/gallery/loadingiconmodel.hpp \
     view/gallery/galleryobjectmodels.hpp \
     view/gallery/rendering/offscreenengine.hpp \
+    view/gallery/rendering/backgroundkeyer.hpp \
     view/gallery/rendering/texturerendertarget.hpp \
     view/misc/displayhelper.hpp \
     view/mainwindow.hpp \
@@ -18,6 +19,8 @@ HEADERS += \
     view/gallery/galleryobjectmodelmodel.hpp \
     view/gallery/iconexpandinglistview.hpp \
     view/rendering/backgroundimagerenderable.hpp \
+    view/rendering/decodedtextureimage.hpp \
+    view/rendering/imagecache.hpp \
     view/rendering/objectmodelrenderablematerial.hpp \
     view/rendering/poserenderable.hpp \
     view/settings/settingsdialog.hpp \
@@ -28,7 +31,15 @@ HEADERS += \
     view/poseeditor/poseeditor.hpp \
     view/poseeditor/poseeditor3dwidget.hpp \
     view/gallery/resizeimagesrunnable.hpp \
+    view/gallery/resizeimagesqueue.hpp \
+    view/gallery/pixmapcache.hpp \
+    view/gallery/thumbnaildecoder.hpp \
+    view/gallery/thumbnailcache.hpp \
     view/rendering/objectmodelrenderable.hpp \
+    view/rendering/meshcache.hpp \
+    view/rendering/meshloader.hpp \
+    view/rendering/poseinstancesrenderable.hpp \
+    view/rendering/pickidmaterial.hpp \
     view/rendering/clickvisualizationmaterial.hpp \
     view/rendering/clickvisualizationrenderable.hpp \
     view/tutorialscreen/tutorialscreen.hpp
@@ -48,6 +59,8 @@ SOURCES += \
     view/gallery/galleryobjectmodelmodel.cpp \
     view/gallery/iconexpandinglistview.cpp \
     view/rendering/backgroundimagerenderable.cpp \
+    view/rendering/decodedtextureimage.cpp \
+    view/rendering/imagecache.cpp \
     view/rendering/poserenderable.cpp \
     view/settings/settingsdialog.cpp \
     view/settings/settingssegmentationcodespage.cpp \
@@ -57,10 +70,19 @@ SOURCES += \
     view/poseeditor/poseeditor.cpp \
     view/poseeditor/poseeditor3dwidget.cpp \
     view/gallery/resizeimagesrunnable.cpp \
+    view/gallery/resizeimagesqueue.cpp \
+    view/gallery/pixmapcache.cpp \
+    view/gallery/thumbnaildecoder.cpp \
+    view/gallery/thumbnailcache.cpp \
     view/misc/displayhelper.cpp \
     view/gallery/rendering/offscreenengine.cpp \
+    view/gallery/rendering/backgroundkeyer.cpp \
     view/gallery/rendering/texturerendertarget.cpp \
     view/rendering/objectmodelrenderable.cpp \
+    view/rendering/meshcache.cpp \
+    view/rendering/meshloader.cpp \
+    view/rendering/poseinstancesrenderable.cpp \
+    view/rendering/pickidmaterial.cpp \
     view/rendering/objectmodelrenderablematerial.cpp \
     view/rendering/clickvisualizationmaterial.cpp \
     view/rendering/clickvisualizationrenderable.cpp \
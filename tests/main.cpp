@@ -1,5 +1,44 @@
+#include "model/cachingmodelmanagerbenchmark.hpp"
+#include "model/journalloadandstorestrategytest.hpp"
+#include "model/jsonstreamreadertest.hpp"
+#include "model/posesnapshottest.hpp"
+#include "view/thumbnaildecoderbenchmark.hpp"
+#include "view/backgroundkeyerbenchmark.hpp"
+#include "view/meshloadertest.hpp"
 
+#include <QApplication>
+#include <QtTest>
 
 int main(int argc, char *argv[]) {
-    return 0;
+    QApplication application(argc, argv);
+    int status = 0;
+    {
+        CachingModelManagerBenchmark benchmark;
+        status |= QTest::qExec(&benchmark, argc, argv);
+    }
+    {
+        JournalLoadAndStoreStrategyTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        JsonStreamReaderTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        PoseSnapshotTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    {
+        ThumbnailDecoderBenchmark benchmark;
+        status |= QTest::qExec(&benchmark, argc, argv);
+    }
+    {
+        BackgroundKeyerBenchmark benchmark;
+        status |= QTest::qExec(&benchmark, argc, argv);
+    }
+    {
+        MeshLoaderTest test;
+        status |= QTest::qExec(&test, argc, argv);
+    }
+    return status;
 }
@@ -0,0 +1,65 @@
+#include "cachingmodelmanagerbenchmark.hpp"
+#include "fakeloadandstorestrategy.hpp"
+#include "model/cachingmodelmanager.hpp"
+
+#include <QtTest>
+
+//! Every image shows this many poses, the object models are shared by all images
+static const int POSES_PER_IMAGE = 10;
+static const int NUMBER_OF_OBJECT_MODELS = 10;
+
+static void addPoseCountRows() {
+    QTest::addColumn<int>("poseCount");
+    QTest::newRow("1k poses") << 1000;
+    QTest::newRow("10k poses") << 10000;
+    QTest::newRow("100k poses") << 100000;
+}
+
+static LoadAndStoreStrategyPtr createStrategy(int poseCount) {
+    return LoadAndStoreStrategyPtr(
+                new FakeLoadAndStoreStrategy(poseCount / POSES_PER_IMAGE,
+                                             NUMBER_OF_OBJECT_MODELS,
+                                             poseCount));
+}
+
+void CachingModelManagerBenchmark::benchmarkAddAndRemovePose_data() {
+    addPoseCountRows();
+}
+
+void CachingModelManagerBenchmark::benchmarkAddAndRemovePose() {
+    QFETCH(int, poseCount);
+    CachingModelManager modelManager(createStrategy(poseCount));
+    modelManager.reload();
+    QCOMPARE(modelManager.poses().size(), poseCount);
+
+    ImagePtr image = modelManager.images().first();
+    ObjectModelPtr objectModel = modelManager.objectModels().first();
+    //! The pose that is removed isn't the last one, i.e. the removal can't just drop the end of the list
+    PosePtr firstPose = modelManager.poses().first();
+    //! IDs created by the model manager only differ by the second they have been created in
+    int addedPoses = 0;
+    QBENCHMARK {
+        PosePtr pose = modelManager.addPose(Pose(QString("added_pose_%1").arg(addedPoses++),
+                                                 QVector3D(0, 0, 1000), QMatrix3x3(),
+                                                 image, objectModel));
+        modelManager.removePose(firstPose->id());
+        firstPose = pose;
+    }
+    QCOMPARE(modelManager.poses().size(), poseCount);
+}
+
+void CachingModelManagerBenchmark::benchmarkUpdatePose_data() {
+    addPoseCountRows();
+}
+
+void CachingModelManagerBenchmark::benchmarkUpdatePose() {
+    QFETCH(int, poseCount);
+    CachingModelManager modelManager(createStrategy(poseCount));
+    modelManager.reload();
+
+    const QString id = modelManager.poses()[poseCount / 2]->id();
+    float z = 1000;
+    QBENCHMARK {
+        modelManager.updatePose(id, QVector3D(0, 0, z++), QMatrix3x3());
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef CACHINGMODELMANAGERBENCHMARK_H
+#define CACHINGMODELMANAGERBENCHMARK_H
+
+#include <QObject>
+
+/*!
+ * \brief The CachingModelManagerBenchmark class measures single pose edits of the
+ * CachingModelManager for growing numbers of poses. The time of one edit should stay
+ * the same no matter how many poses the manager holds.
+ */
+class CachingModelManagerBenchmark : public QObject {
+
+    Q_OBJECT
+
+private Q_SLOTS:
+    void benchmarkAddAndRemovePose_data();
+    void benchmarkAddAndRemovePose();
+    void benchmarkUpdatePose_data();
+    void benchmarkUpdatePose();
+};
+
+#endif // CACHINGMODELMANAGERBENCHMARK_H
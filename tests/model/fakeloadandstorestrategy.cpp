@@ -0,0 +1,53 @@
+#include "fakeloadandstorestrategy.hpp"
+
+FakeLoadAndStoreStrategy::FakeLoadAndStoreStrategy(int numberOfImages,
+                                                   int numberOfObjectModels,
+                                                   int numberOfPoses)
+    : m_numberOfImages(numberOfImages),
+      m_numberOfObjectModels(numberOfObjectModels),
+      m_numberOfPoses(numberOfPoses) {
+}
+
+bool FakeLoadAndStoreStrategy::persistPose(const Pose &objectImagePose, bool deletePose) {
+    Q_UNUSED(objectImagePose)
+    Q_UNUSED(deletePose)
+    return true;
+}
+
+QList<ImagePtr> FakeLoadAndStoreStrategy::loadImages() {
+    QList<ImagePtr> images;
+    images.reserve(m_numberOfImages);
+    for (int i = 0; i < m_numberOfImages; i++) {
+        images.append(ImagePtr(new Image(QString::number(i),
+                                         QString("%1.png").arg(i, 6, 10, QChar('0')),
+                                         "/images", QMatrix3x3(), 50.f, 2000.f)));
+    }
+    return images;
+}
+
+QList<ObjectModelPtr> FakeLoadAndStoreStrategy::loadObjectModels() {
+    QList<ObjectModelPtr> objectModels;
+    objectModels.reserve(m_numberOfObjectModels);
+    for (int i = 0; i < m_numberOfObjectModels; i++) {
+        objectModels.append(ObjectModelPtr(new ObjectModel(QString::number(i),
+                                                           QString("%1.ply").arg(i),
+                                                           "/object_models")));
+    }
+    return objectModels;
+}
+
+QList<PosePtr> FakeLoadAndStoreStrategy::loadPoses(const QList<ImagePtr> &images,
+                                                   const QList<ObjectModelPtr> &objectModels) {
+    QList<PosePtr> poses;
+    if (images.isEmpty() || objectModels.isEmpty()) {
+        return poses;
+    }
+    poses.reserve(m_numberOfPoses);
+    for (int i = 0; i < m_numberOfPoses; i++) {
+        poses.append(PosePtr(new Pose(QString("pose_%1").arg(i),
+                                      QVector3D(0, 0, 1000), QMatrix3x3(),
+                                      images[i % images.size()],
+                                      objectModels[i % objectModels.size()])));
+    }
+    return poses;
+}
@@ -0,0 +1,32 @@
+#ifndef FAKELOADANDSTORESTRATEGY_H
+#define FAKELOADANDSTORESTRATEGY_H
+
+#include "model/loadandstorestrategy.hpp"
+
+/*!
+ * \brief The FakeLoadAndStoreStrategy class keeps generated entities in memory and persists
+ * nothing, i.e. benchmarks of the model manager don't measure any file access.
+ */
+class FakeLoadAndStoreStrategy : public LoadAndStoreStrategy {
+
+    Q_OBJECT
+
+public:
+    FakeLoadAndStoreStrategy(int numberOfImages, int numberOfObjectModels, int numberOfPoses);
+
+    bool persistPose(const Pose &objectImagePose, bool deletePose) override;
+
+    QList<ImagePtr> loadImages() override;
+
+    QList<ObjectModelPtr> loadObjectModels() override;
+
+    QList<PosePtr> loadPoses(const QList<ImagePtr> &images,
+                             const QList<ObjectModelPtr> &objectModels) override;
+
+private:
+    int m_numberOfImages;
+    int m_numberOfObjectModels;
+    int m_numberOfPoses;
+};
+
+#endif // FAKELOADANDSTORESTRATEGY_H
@@ -0,0 +1,180 @@
+#include "journalloadandstorestrategytest.hpp"
+#include "model/journalloadandstorestrategy.hpp"
+
+#include <QtTest>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+static const QString IMAGE_PATH = "000000.png";
+static const QString OTHER_IMAGE_PATH = "000001.png";
+static const QString OBJECT_MODEL_PATH = "obj_000001.ply";
+
+static const QByteArray POSES_JSON =
+        "{\n"
+        "    \"000000.png\": [\n"
+        "        {\"id\": \"pose_0\", \"obj\": \"obj_000001.ply\",\n"
+        "         \"R\": [1, 0, 0, 0, 1, 0, 0, 0, 1], \"t\": [0, 0, 1000]}\n"
+        "    ],\n"
+        "    \"000001.png\": [\n"
+        "        {\"id\": \"pose_1\", \"obj\": \"obj_000001.ply\",\n"
+        "         \"R\": [1, 0, 0, 0, 1, 0, 0, 0, 1], \"t\": [0, 0, 1100]}\n"
+        "    ]\n"
+        "}\n";
+
+static QList<ImagePtr> createImages() {
+    return {ImagePtr(new Image("0", IMAGE_PATH, "/images", QMatrix3x3(), 50.f, 2000.f)),
+            ImagePtr(new Image("1", OTHER_IMAGE_PATH, "/images", QMatrix3x3(), 50.f, 2000.f))};
+}
+
+static QList<ObjectModelPtr> createObjectModels() {
+    return {ObjectModelPtr(new ObjectModel("0", OBJECT_MODEL_PATH, "/object_models"))};
+}
+
+static PosePtr poseWithId(const QList<PosePtr> &poses, const QString &id) {
+    for (const PosePtr &pose : poses) {
+        if (pose->id() == id) {
+            return pose;
+        }
+    }
+    return PosePtr();
+}
+
+static int lineCount(const QString &path) {
+    QFile file(path);
+    if (!file.open(QFile::ReadOnly)) {
+        return 0;
+    }
+    return file.readAll().count('\n');
+}
+
+void JournalLoadAndStoreStrategyTest::init() {
+    m_directory = new QTemporaryDir();
+    QVERIFY(m_directory->isValid());
+    QFile posesFile(posesFilePath());
+    QVERIFY(posesFile.open(QFile::WriteOnly));
+    posesFile.write(POSES_JSON);
+}
+
+void JournalLoadAndStoreStrategyTest::cleanup() {
+    delete m_directory;
+    m_directory = Q_NULLPTR;
+}
+
+QString JournalLoadAndStoreStrategyTest::posesFilePath() const {
+    return m_directory->filePath("poses.json");
+}
+
+void JournalLoadAndStoreStrategyTest::testAppendAndReplay() {
+    QList<ImagePtr> images = createImages();
+    QList<ObjectModelPtr> objectModels = createObjectModels();
+    JournalLoadAndStoreStrategy writingStrategy;
+    writingStrategy.setPosesFilePath(posesFilePath());
+    QList<PosePtr> poses = writingStrategy.loadPoses(images, objectModels);
+    QCOMPARE(poses.size(), 2);
+
+    PosePtr addedPose(new Pose("pose_2", QVector3D(1, 2, 3), QMatrix3x3(),
+                               images[0], objectModels[0]));
+    PosePtr updatedPose(new Pose("pose_0", QVector3D(0, 0, 500), QMatrix3x3(),
+                                 images[0], objectModels[0]));
+    QVERIFY(writingStrategy.persistPoses({addedPose}, {updatedPose}, {poseWithId(poses, "pose_1")}));
+
+    //! Nothing but the journal has been written
+    QCOMPARE(lineCount(posesFilePath() + ".journal"), 3);
+    QFile posesFile(posesFilePath());
+    QVERIFY(posesFile.open(QFile::ReadOnly));
+    QCOMPARE(posesFile.readAll(), POSES_JSON);
+
+    //! A second strategy has to read the journal from disk
+    JournalLoadAndStoreStrategy readingStrategy;
+    readingStrategy.setPosesFilePath(posesFilePath());
+    QList<PosePtr> replayedPoses = readingStrategy.loadPoses(images, objectModels);
+    QCOMPARE(replayedPoses.size(), 2);
+    QVERIFY(!poseWithId(replayedPoses, "pose_1"));
+    QCOMPARE(poseWithId(replayedPoses, "pose_0")->position(), QVector3D(0, 0, 500));
+    QCOMPARE(poseWithId(replayedPoses, "pose_2")->position(), QVector3D(1, 2, 3));
+
+    //! The journal read into memory is kept in sync when persisting
+    QVERIFY(readingStrategy.persistPoses({}, {}, {poseWithId(replayedPoses, "pose_2")}));
+    replayedPoses = readingStrategy.loadPoses(images, objectModels);
+    QCOMPARE(replayedPoses.size(), 1);
+    QCOMPARE(replayedPoses.first()->id(), QString("pose_0"));
+}
+
+void JournalLoadAndStoreStrategyTest::testReplayForImage() {
+    QList<ImagePtr> images = createImages();
+    QList<ObjectModelPtr> objectModels = createObjectModels();
+    JournalLoadAndStoreStrategy writingStrategy;
+    writingStrategy.setPosesFilePath(posesFilePath());
+    PosePtr addedPose(new Pose("pose_2", QVector3D(1, 2, 3), QMatrix3x3(),
+                               images[1], objectModels[0]));
+    QVERIFY(writingStrategy.persistPoses({addedPose}, {}, {}));
+
+    JournalLoadAndStoreStrategy readingStrategy;
+    readingStrategy.setPosesFilePath(posesFilePath());
+    QList<PosePtr> poses = readingStrategy.loadPosesForImage(images[0], objectModels);
+    QCOMPARE(poses.size(), 1);
+    QCOMPARE(poses.first()->id(), QString("pose_0"));
+    poses = readingStrategy.loadPosesForImage(images[1], objectModels);
+    QCOMPARE(poses.size(), 2);
+    QVERIFY(poseWithId(poses, "pose_1"));
+    QVERIFY(poseWithId(poses, "pose_2")->image() == images[1]);
+}
+
+void JournalLoadAndStoreStrategyTest::testIncompleteLastLineIsSkipped() {
+    QList<ImagePtr> images = createImages();
+    QList<ObjectModelPtr> objectModels = createObjectModels();
+    JournalLoadAndStoreStrategy writingStrategy;
+    writingStrategy.setPosesFilePath(posesFilePath());
+    PosePtr updatedPose(new Pose("pose_0", QVector3D(0, 0, 500), QMatrix3x3(),
+                                 images[0], objectModels[0]));
+    QVERIFY(writingStrategy.persistPoses({}, {updatedPose}, {}));
+
+    //! What is left behind if the program crashes while appending
+    QFile journalFile(posesFilePath() + ".journal");
+    QVERIFY(journalFile.open(QFile::WriteOnly | QFile::Append));
+    journalFile.write("{\"op\":\"del\",\"img\":\"000000.png\",\"id\":\"pose_0\"");
+    journalFile.close();
+
+    JournalLoadAndStoreStrategy readingStrategy;
+    readingStrategy.setPosesFilePath(posesFilePath());
+    QList<PosePtr> poses = readingStrategy.loadPoses(images, objectModels);
+    QCOMPARE(poses.size(), 2);
+    QCOMPARE(poseWithId(poses, "pose_0")->position(), QVector3D(0, 0, 500));
+}
+
+void JournalLoadAndStoreStrategyTest::testCompaction() {
+    QList<ImagePtr> images = createImages();
+    QList<ObjectModelPtr> objectModels = createObjectModels();
+    JournalLoadAndStoreStrategy strategy;
+    strategy.setPosesFilePath(posesFilePath());
+    QList<PosePtr> poses = strategy.loadPoses(images, objectModels);
+    PosePtr addedPose(new Pose("pose_2", QVector3D(1, 2, 3), QMatrix3x3(),
+                               images[0], objectModels[0]));
+    PosePtr updatedPose(new Pose("pose_0", QVector3D(0, 0, 500), QMatrix3x3(),
+                                 images[0], objectModels[0]));
+    QVERIFY(strategy.persistPoses({addedPose}, {updatedPose}, {poseWithId(poses, "pose_1")}));
+
+    strategy.flush();
+    QVERIFY(!QFile::exists(posesFilePath() + ".journal"));
+    QVERIFY(!QFile::exists(posesFilePath() + ".journal.compacting"));
+
+    QFile posesFile(posesFilePath());
+    QVERIFY(posesFile.open(QFile::ReadOnly));
+    QJsonObject posesJson = QJsonDocument::fromJson(posesFile.readAll()).object();
+    QJsonArray entriesForImage = posesJson[IMAGE_PATH].toArray();
+    QCOMPARE(entriesForImage.size(), 2);
+    QCOMPARE(entriesForImage[0].toObject()["id"].toString(), QString("pose_0"));
+    QCOMPARE(entriesForImage[0].toObject()["t"].toArray()[2].toDouble(), 500.0);
+    QCOMPARE(entriesForImage[1].toObject()["id"].toString(), QString("pose_2"));
+    QVERIFY(posesJson[OTHER_IMAGE_PATH].toArray().isEmpty());
+
+    //! The compacted poses file alone holds all changes
+    JsonLoadAndStoreStrategy jsonStrategy;
+    jsonStrategy.setPosesFilePath(posesFilePath());
+    QList<PosePtr> compactedPoses = jsonStrategy.loadPoses(images, objectModels);
+    QCOMPARE(compactedPoses.size(), 2);
+    QCOMPARE(poseWithId(compactedPoses, "pose_0")->position(), QVector3D(0, 0, 500));
+    QCOMPARE(poseWithId(compactedPoses, "pose_2")->position(), QVector3D(1, 2, 3));
+}
@@ -0,0 +1,31 @@
+#ifndef JOURNALLOADANDSTORESTRATEGYTEST_H
+#define JOURNALLOADANDSTORESTRATEGYTEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+/*!
+ * \brief The JournalLoadAndStoreStrategyTest class checks that changes appended to the journal
+ * are replayed onto the poses file when loading the poses and that compacting the journal
+ * merges them into the poses file.
+ */
+class JournalLoadAndStoreStrategyTest : public QObject {
+
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testAppendAndReplay();
+    void testReplayForImage();
+    void testIncompleteLastLineIsSkipped();
+    void testCompaction();
+
+private:
+    QString posesFilePath() const;
+
+private:
+    QTemporaryDir *m_directory = Q_NULLPTR;
+};
+
+#endif // JOURNALLOADANDSTORESTRATEGYTEST_H
@@ -0,0 +1,184 @@
+#include "jsonstreamreadertest.hpp"
+#include "model/jsonstreamreader.hpp"
+#include "model/jsonloadandstorestrategy.hpp"
+
+#include <QtTest>
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+static const QString OBJECT_MODEL_PATH = "obj_000001.ply";
+
+//! Larger than the chunk size of the reader if there are enough images, i.e. tokens span chunks
+static QByteArray createPosesJson(int numberOfImages) {
+    QJsonObject posesJson;
+    for (int i = 0; i < numberOfImages; i++) {
+        QJsonObject entry;
+        entry["id"] = QString("pose_%1").arg(i);
+        entry["obj"] = OBJECT_MODEL_PATH;
+        entry["R"] = QJsonArray({0.36, 0.48, -0.8, -0.8, 0.6, 0, 0.48, 0.64, 0.6});
+        entry["t"] = QJsonArray({-12.5 * i, 0.001 * i, 1000 + i});
+        posesJson[QString("%1.png").arg(i, 6, 10, QChar('0'))] = QJsonArray({entry});
+    }
+    return QJsonDocument(posesJson).toJson();
+}
+
+//! Rebuilds the value the reader is positioned at, i.e. the current token has been read already
+static QJsonValue readValue(JsonStreamReader &reader) {
+    switch (reader.tokenType()) {
+    case JsonStreamReader::StartObject: {
+        QJsonObject object;
+        while (reader.readNext() == JsonStreamReader::Key) {
+            QString key = reader.stringValue();
+            reader.readNext();
+            object[key] = readValue(reader);
+        }
+        if (reader.tokenType() != JsonStreamReader::EndObject) {
+            return QJsonValue(QJsonValue::Undefined);
+        }
+        return object;
+    }
+    case JsonStreamReader::StartArray: {
+        QJsonArray array;
+        while (reader.readNext() != JsonStreamReader::EndArray) {
+            QJsonValue value = readValue(reader);
+            if (value.isUndefined()) {
+                return value;
+            }
+            array.append(value);
+        }
+        return array;
+    }
+    case JsonStreamReader::String:
+        return reader.stringValue();
+    case JsonStreamReader::Number:
+        return reader.numberValue();
+    case JsonStreamReader::Bool:
+        return reader.boolValue();
+    case JsonStreamReader::Null:
+        return QJsonValue(QJsonValue::Null);
+    default:
+        return QJsonValue(QJsonValue::Undefined);
+    }
+}
+
+void JsonStreamReaderTest::testSameValuesAsJsonDocument_data() {
+    QTest::addColumn<QByteArray>("json");
+    QTest::newRow("empty object") << QByteArray("{}");
+    QTest::newRow("poses of few images") << createPosesJson(10);
+    QTest::newRow("poses spanning chunks") << createPosesJson(20000);
+    QTest::newRow("literals and nesting")
+            << QByteArray("{\"a\": [true, false, null, [], {}], \"b\": {\"c\": {\"d\": [1, [2, [3]]]}}}");
+    QTest::newRow("numbers")
+            << QByteArray("[0, -0.5, 1e3, 2.5E-3, -1.25e+2, 123456789012, 3.141592653589793]");
+    QTest::newRow("escapes")
+            << QByteArray("{\"q\\\"uote\": \"a\\\\b\\/c\\n\\t\\r\\b\\f\", \"u\": \"\\u00e4\\u20ac\\ud83d\\ude00\","
+                          " \"utf8\": \"\xc3\xa4\xe2\x82\xac\"}");
+}
+
+void JsonStreamReaderTest::testSameValuesAsJsonDocument() {
+    QFETCH(QByteArray, json);
+    QJsonParseError parseError;
+    QJsonDocument jsonDocument = QJsonDocument::fromJson(json, &parseError);
+    QCOMPARE(parseError.error, QJsonParseError::NoError);
+
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QBuffer::ReadOnly));
+    JsonStreamReader reader(&buffer);
+    reader.readNext();
+    QJsonValue value = readValue(reader);
+    QVERIFY2(!value.isUndefined(), qPrintable(reader.errorString()));
+    QCOMPARE(reader.readNext(), JsonStreamReader::EndDocument);
+    QCOMPARE(reader.bytesRead(), (qint64) json.size());
+
+    if (jsonDocument.isObject()) {
+        QCOMPARE(value.toObject(), jsonDocument.object());
+    } else {
+        QCOMPARE(value.toArray(), jsonDocument.array());
+    }
+}
+
+void JsonStreamReaderTest::testSkipValue() {
+    QByteArray json = "{\"skipped\": {\"a\": [1, \"]\", {\"b\": \"}\"}]}, \"read\": [1, 2]}";
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QBuffer::ReadOnly));
+    JsonStreamReader reader(&buffer);
+    QCOMPARE(reader.readNext(), JsonStreamReader::StartObject);
+    QCOMPARE(reader.readNext(), JsonStreamReader::Key);
+    QCOMPARE(reader.stringValue(), QString("skipped"));
+    QVERIFY(reader.skipValue());
+    QCOMPARE(reader.readNext(), JsonStreamReader::Key);
+    QCOMPARE(reader.stringValue(), QString("read"));
+    QCOMPARE(reader.readNext(), JsonStreamReader::StartArray);
+    QCOMPARE(readValue(reader).toArray(), QJsonArray({1, 2}));
+    QCOMPARE(reader.readNext(), JsonStreamReader::EndObject);
+    QCOMPARE(reader.readNext(), JsonStreamReader::EndDocument);
+}
+
+void JsonStreamReaderTest::testInvalidDocument_data() {
+    QTest::addColumn<QByteArray>("json");
+    QTest::newRow("truncated") << createPosesJson(10).left(200);
+    QTest::newRow("unterminated string") << QByteArray("{\"000000.png\": [{\"id\": \"pose_0}]}");
+    QTest::newRow("mismatched brackets") << QByteArray("{\"000000.png\": [1, 2}}");
+    QTest::newRow("invalid literal") << QByteArray("{\"a\": tru}");
+    QTest::newRow("invalid escape") << QByteArray("{\"a\": \"\\uzzzz\"}");
+}
+
+void JsonStreamReaderTest::testInvalidDocument() {
+    QFETCH(QByteArray, json);
+    QVERIFY(QJsonDocument::fromJson(json).isNull());
+
+    QBuffer buffer(&json);
+    QVERIFY(buffer.open(QBuffer::ReadOnly));
+    JsonStreamReader reader(&buffer);
+    JsonStreamReader::TokenType tokenType = reader.readNext();
+    while (tokenType != JsonStreamReader::Invalid && tokenType != JsonStreamReader::EndDocument) {
+        tokenType = reader.readNext();
+    }
+    QCOMPARE(tokenType, JsonStreamReader::Invalid);
+    QVERIFY(!reader.errorString().isEmpty());
+}
+
+void JsonStreamReaderTest::testLoadedPosesMatchJsonDocument() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const int numberOfImages = 20000;
+    QByteArray json = createPosesJson(numberOfImages);
+    QString posesFilePath = directory.filePath("poses.json");
+    QFile posesFile(posesFilePath);
+    QVERIFY(posesFile.open(QFile::WriteOnly));
+    posesFile.write(json);
+    posesFile.close();
+
+    QList<ImagePtr> images;
+    for (int i = 0; i < numberOfImages; i++) {
+        QString imagePath = QString("%1.png").arg(i, 6, 10, QChar('0'));
+        images.append(ImagePtr(new Image(imagePath, imagePath, "/images", QMatrix3x3(), 50.f, 2000.f)));
+    }
+    QList<ObjectModelPtr> objectModels = {
+        ObjectModelPtr(new ObjectModel("0", OBJECT_MODEL_PATH, "/object_models"))
+    };
+
+    //! All IDs are present, i.e. the strategy streams the file
+    JsonLoadAndStoreStrategy strategy;
+    strategy.setPosesFilePath(posesFilePath);
+    QList<PosePtr> poses = strategy.loadPoses(images, objectModels);
+
+    QJsonObject posesJson = QJsonDocument::fromJson(json).object();
+    QCOMPARE(poses.size(), posesJson.size());
+    for (const PosePtr &pose : poses) {
+        QJsonObject entry = posesJson[pose->image()->imagePath()].toArray().first().toObject();
+        QCOMPARE(pose->id(), entry["id"].toString());
+        QJsonArray translation = entry["t"].toArray();
+        QCOMPARE(pose->position(), QVector3D(translation[0].toDouble(),
+                                             translation[1].toDouble(),
+                                             translation[2].toDouble()));
+        QMatrix3x3 rotation = pose->rotation().toRotationMatrix();
+        QJsonArray rotationArray = entry["R"].toArray();
+        for (int i = 0; i < 9; i++) {
+            QVERIFY(qAbs(rotation(i / 3, i % 3) - rotationArray[i].toDouble()) < 1e-5);
+        }
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef JSONSTREAMREADERTEST_H
+#define JSONSTREAMREADERTEST_H
+
+#include <QObject>
+
+/*!
+ * \brief The JsonStreamReaderTest class checks that the JsonStreamReader reads the same values
+ * as QJsonDocument from the same poses file, including documents that span several chunks, and
+ * that it reports malformed documents as invalid.
+ */
+class JsonStreamReaderTest : public QObject {
+
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testSameValuesAsJsonDocument_data();
+    void testSameValuesAsJsonDocument();
+    void testSkipValue();
+    void testInvalidDocument_data();
+    void testInvalidDocument();
+    void testLoadedPosesMatchJsonDocument();
+};
+
+#endif // JSONSTREAMREADERTEST_H
@@ -1,5 +1,45 @@
-INCLUDEPATH += $$PWD
+INCLUDEPATH += $$PWD \
+               $$PWD/../../src
 
-HEADERS +=
+HEADERS += \
+    $$PWD/../../src/misc/generalhelper.hpp \
+    $$PWD/../../src/misc/global.hpp \
+    $$PWD/../../src/model/cachingmodelmanager.hpp \
+    $$PWD/../../src/model/directorysnapshot.hpp \
+    $$PWD/../../src/model/image.hpp \
+    $$PWD/../../src/model/journalloadandstorestrategy.hpp \
+    $$PWD/../../src/model/jsonloadandstorestrategy.hpp \
+    $$PWD/../../src/model/jsonstreamreader.hpp \
+    $$PWD/../../src/model/loadandstorestrategy.hpp \
+    $$PWD/../../src/model/modelmanager.hpp \
+    $$PWD/../../src/model/objectmodel.hpp \
+    $$PWD/../../src/model/pose.hpp \
+    $$PWD/../../src/model/posesnapshot.hpp \
+    $$PWD/../../src/settings/settings.hpp \
+    $$PWD/../../src/settings/settingsstore.hpp \
+    $$PWD/cachingmodelmanagerbenchmark.hpp \
+    $$PWD/fakeloadandstorestrategy.hpp \
+    $$PWD/journalloadandstorestrategytest.hpp \
+    $$PWD/jsonstreamreadertest.hpp \
+    $$PWD/posesnapshottest.hpp
 
-SOURCES +=
+SOURCES += \
+    $$PWD/../../src/misc/generalhelper.cpp \
+    $$PWD/../../src/model/cachingmodelmanager.cpp \
+    $$PWD/../../src/model/directorysnapshot.cpp \
+    $$PWD/../../src/model/image.cpp \
+    $$PWD/../../src/model/journalloadandstorestrategy.cpp \
+    $$PWD/../../src/model/jsonloadandstorestrategy.cpp \
+    $$PWD/../../src/model/jsonstreamreader.cpp \
+    $$PWD/../../src/model/loadandstorestrategy.cpp \
+    $$PWD/../../src/model/modelmanager.cpp \
+    $$PWD/../../src/model/objectmodel.cpp \
+    $$PWD/../../src/model/pose.cpp \
+    $$PWD/../../src/model/posesnapshot.cpp \
+    $$PWD/../../src/settings/settings.cpp \
+    $$PWD/../../src/settings/settingsstore.cpp \
+    $$PWD/cachingmodelmanagerbenchmark.cpp \
+    $$PWD/fakeloadandstorestrategy.cpp \
+    $$PWD/journalloadandstorestrategytest.cpp \
+    $$PWD/jsonstreamreadertest.cpp \
+    $$PWD/posesnapshottest.cpp
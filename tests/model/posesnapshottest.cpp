@@ -0,0 +1,162 @@
+#include "posesnapshottest.hpp"
+#include "model/posesnapshot.hpp"
+#include "model/jsonloadandstorestrategy.hpp"
+
+#include <QtTest>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+static const QString IMAGE_PATH = "000000.png";
+static const QString OTHER_IMAGE_PATH = "000001.png";
+static const QString OBJECT_MODEL_PATH = "obj_000001.ply";
+
+static const QByteArray POSES_JSON =
+        "{\n"
+        "    \"000000.png\": [\n"
+        "        {\"id\": \"pose_0\", \"obj\": \"obj_000001.ply\",\n"
+        "         \"R\": [0, -1, 0, 1, 0, 0, 0, 0, 1], \"t\": [10, 20, 1000]},\n"
+        "        {\"id\": \"pose_1\", \"obj\": \"obj_000002.ply\",\n"
+        "         \"R\": [1, 0, 0, 0, 1, 0, 0, 0, 1], \"t\": [0, 0, 900]}\n"
+        "    ],\n"
+        "    \"000001.png\": [\n"
+        "        {\"id\": \"pose_2\", \"obj\": \"obj_000001.ply\",\n"
+        "         \"R\": [1, 0, 0, 0, 1, 0, 0, 0, 1], \"t\": [0, 0, 1100]}\n"
+        "    ]\n"
+        "}\n";
+
+static ImagePtr createImage(const QString &imagePath) {
+    return ImagePtr(new Image(imagePath, imagePath, "/images", QMatrix3x3(), 50.f, 2000.f));
+}
+
+static QList<ObjectModelPtr> createObjectModels() {
+    //! obj_000002.ply is not managed, i.e. its poses are skipped
+    return {ObjectModelPtr(new ObjectModel("0", OBJECT_MODEL_PATH, "/object_models"))};
+}
+
+static bool writeFile(const QString &path, const QByteArray &content) {
+    QFile file(path);
+    return file.open(QFile::WriteOnly) && file.write(content) == content.size();
+}
+
+static bool writeSnapshot(const QString &path, const QString &posesFilePath) {
+    QFile posesFile(posesFilePath);
+    if (!posesFile.open(QFile::ReadOnly)) {
+        return false;
+    }
+    QJsonObject posesJson = QJsonDocument::fromJson(posesFile.readAll()).object();
+    posesFile.close();
+    return PoseSnapshot::write(path, posesJson, QFileInfo(posesFilePath));
+}
+
+void PoseSnapshotTest::init() {
+    m_directory = new QTemporaryDir();
+    QVERIFY(m_directory->isValid());
+    QVERIFY(writeFile(posesFilePath(), POSES_JSON));
+}
+
+void PoseSnapshotTest::cleanup() {
+    delete m_directory;
+    m_directory = Q_NULLPTR;
+}
+
+QString PoseSnapshotTest::posesFilePath() const {
+    return m_directory->filePath("poses.json");
+}
+
+QString PoseSnapshotTest::snapshotFilePath() const {
+    return posesFilePath() + PoseSnapshot::FILE_SUFFIX;
+}
+
+void PoseSnapshotTest::testWriteAndLoadPosesForImage() {
+    QVERIFY(writeSnapshot(snapshotFilePath(), posesFilePath()));
+
+    PoseSnapshot snapshot;
+    QVERIFY(snapshot.open(snapshotFilePath()));
+    QVERIFY(snapshot.isUpToDateWith(QFileInfo(posesFilePath())));
+    QVERIFY(snapshot.isComplete());
+    QCOMPARE(snapshot.poseCount(), 3);
+
+    ImagePtr image = createImage(IMAGE_PATH);
+    QList<ObjectModelPtr> objectModels = createObjectModels();
+    QList<PosePtr> poses = snapshot.loadPosesForImage(image, objectModels);
+    QCOMPARE(poses.size(), 1);
+    const PosePtr &pose = poses.first();
+    QCOMPARE(pose->id(), QString("pose_0"));
+    QVERIFY(pose->image() == image);
+    QVERIFY(pose->objectModel() == objectModels.first());
+    QCOMPARE(pose->position(), QVector3D(10, 20, 1000));
+    //! The records are row-major like the poses file
+    QMatrix3x3 rotation = pose->rotation().toRotationMatrix();
+    QVERIFY(qAbs(rotation(0, 1) + 1.f) < 1e-5f);
+    QVERIFY(qAbs(rotation(1, 0) - 1.f) < 1e-5f);
+
+    poses = snapshot.loadPosesForImage(createImage(OTHER_IMAGE_PATH), objectModels);
+    QCOMPARE(poses.size(), 1);
+    QCOMPARE(poses.first()->id(), QString("pose_2"));
+    QVERIFY(snapshot.loadPosesForImage(createImage("unknown.png"), objectModels).isEmpty());
+}
+
+void PoseSnapshotTest::testIncompleteEntriesAreLeftOut() {
+    QJsonObject posesJson = QJsonDocument::fromJson(
+                "{\"000000.png\": ["
+                "{\"id\": \"pose_0\", \"obj\": \"obj_000001.ply\", \"t\": [0, 0, 1000]},"
+                "{\"id\": \"pose_1\", \"obj\": \"obj_000001.ply\","
+                " \"R\": [1, 0, 0, 0, 1, 0, 0, 0, 1], \"t\": [0, 0, 900]}]}").object();
+    QVERIFY(PoseSnapshot::write(snapshotFilePath(), posesJson, QFileInfo(posesFilePath())));
+
+    PoseSnapshot snapshot;
+    QVERIFY(snapshot.open(snapshotFilePath()));
+    QVERIFY(!snapshot.isComplete());
+    QCOMPARE(snapshot.poseCount(), 1);
+    QList<PosePtr> poses = snapshot.loadPosesForImage(createImage(IMAGE_PATH), createObjectModels());
+    QCOMPARE(poses.size(), 1);
+    QCOMPARE(poses.first()->id(), QString("pose_1"));
+}
+
+void PoseSnapshotTest::testStaleSnapshotIsRejected() {
+    QVERIFY(writeSnapshot(snapshotFilePath(), posesFilePath()));
+
+    //! Another program removes pose_0 from the poses file
+    QByteArray changedPosesJson =
+            "{\"000000.png\": [], \"000001.png\": [{\"id\": \"pose_2\", \"obj\": \"obj_000001.ply\","
+            " \"R\": [1, 0, 0, 0, 1, 0, 0, 0, 1], \"t\": [0, 0, 1100]}]}";
+    QVERIFY(writeFile(posesFilePath(), changedPosesJson));
+
+    PoseSnapshot snapshot;
+    QVERIFY(snapshot.open(snapshotFilePath()));
+    QVERIFY(!snapshot.isUpToDateWith(QFileInfo(posesFilePath())));
+
+    //! The strategy has to parse the poses file instead of serving pose_0 from the snapshot
+    JsonLoadAndStoreStrategy strategy;
+    strategy.setPosesFilePath(posesFilePath());
+    QVERIFY(strategy.loadPosesForImage(createImage(IMAGE_PATH), createObjectModels()).isEmpty());
+}
+
+void PoseSnapshotTest::testTruncatedSnapshotIsRejected_data() {
+    QTest::addColumn<int>("bytesRemoved");
+    QTest::newRow("last string byte") << 1;
+    QTest::newRow("strings") << 20;
+    QTest::newRow("pose records") << 150;
+}
+
+void PoseSnapshotTest::testTruncatedSnapshotIsRejected() {
+    QFETCH(int, bytesRemoved);
+    QVERIFY(writeSnapshot(snapshotFilePath(), posesFilePath()));
+    QFile snapshotFile(snapshotFilePath());
+    QVERIFY(snapshotFile.resize(snapshotFile.size() - bytesRemoved));
+
+    PoseSnapshot snapshot;
+    QVERIFY(!snapshot.open(snapshotFilePath()));
+    QVERIFY(!snapshot.isOpen());
+    QVERIFY(snapshot.loadPosesForImage(createImage(IMAGE_PATH), createObjectModels()).isEmpty());
+
+    //! The strategy falls back to the poses file and replaces the snapshot
+    JsonLoadAndStoreStrategy strategy;
+    strategy.setPosesFilePath(posesFilePath());
+    QList<PosePtr> poses = strategy.loadPosesForImage(createImage(IMAGE_PATH), createObjectModels());
+    QCOMPARE(poses.size(), 1);
+    QCOMPARE(poses.first()->id(), QString("pose_0"));
+    QVERIFY(snapshot.open(snapshotFilePath()));
+    QVERIFY(snapshot.isUpToDateWith(QFileInfo(posesFilePath())));
+}
@@ -0,0 +1,32 @@
+#ifndef POSESNAPSHOTTEST_H
+#define POSESNAPSHOTTEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+/*!
+ * \brief The PoseSnapshotTest class checks that the poses written to a binary snapshot are read
+ * back from the mapped file and that snapshots which are outdated or truncated are rejected.
+ */
+class PoseSnapshotTest : public QObject {
+
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testWriteAndLoadPosesForImage();
+    void testIncompleteEntriesAreLeftOut();
+    void testStaleSnapshotIsRejected();
+    void testTruncatedSnapshotIsRejected_data();
+    void testTruncatedSnapshotIsRejected();
+
+private:
+    QString posesFilePath() const;
+    QString snapshotFilePath() const;
+
+private:
+    QTemporaryDir *m_directory = Q_NULLPTR;
+};
+
+#endif // POSESNAPSHOTTEST_H
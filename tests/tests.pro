@@ -1,6 +1,9 @@
 TEMPLATE = app
-CONFIG += c++11 testcase
-QT += testlib
+CONFIG += c++11 testcase no_keywords
+QT += testlib core gui widgets concurrent
+
+unix: CONFIG += link_pkgconfig
+unix: PKGCONFIG += opencv4
 
 include(model/model.pri)
 include(view/view.pri)
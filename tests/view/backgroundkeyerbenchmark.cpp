@@ -0,0 +1,57 @@
+#include "backgroundkeyerbenchmark.hpp"
+#include "view/gallery/rendering/backgroundkeyer.hpp"
+
+#include <QtTest>
+#include <QImage>
+#include <QPainter>
+
+enum KeyingMethod {
+    PerPixel,
+    Scanlines
+};
+
+//! The keying of the background before it worked on the scanlines, as reference
+static void keyBackgroundPerPixel(QImage &image, QRgb background) {
+    for(int x = 0; x < image.width(); x++) {
+        for(int y = 0; y < image.height(); y++) {
+            if (image.pixel(x, y) == background) {
+                image.setPixel(x,y,qRgba(0, 0, 0, 0));
+            }
+        }
+    }
+}
+
+void BackgroundKeyerBenchmark::benchmarkKeyBackground_data() {
+    QTest::addColumn<int>("method");
+    QTest::addColumn<int>("size");
+    // The size of the gallery previews and the sizes of the previews on 2x and 4x displays
+    for (int size : {300, 600, 1200}) {
+        QTest::newRow(qPrintable(QString("Per pixel at %1x%1").arg(size))) << (int) PerPixel << size;
+        QTest::newRow(qPrintable(QString("Scanlines at %1x%1").arg(size))) << (int) Scanlines << size;
+    }
+}
+
+void BackgroundKeyerBenchmark::benchmarkKeyBackground() {
+    QFETCH(int, method);
+    QFETCH(int, size);
+    const QRgb background = qRgba(255, 255, 255, 255);
+    QImage capture(size, size, QImage::Format_ARGB32);
+    capture.fill(background);
+    QPainter painter(&capture);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setBrush(Qt::gray);
+    painter.drawEllipse(capture.rect().adjusted(size / 4, size / 4, -size / 4, -size / 4));
+    painter.end();
+
+    QImage image;
+    QBENCHMARK {
+        image = capture.copy();
+        if (method == PerPixel) {
+            keyBackgroundPerPixel(image, background);
+        } else {
+            BackgroundKeyer::keyBackground(image, background);
+        }
+    }
+    QCOMPARE(image.pixel(0, 0), qRgba(0, 0, 0, 0));
+    QCOMPARE(image.pixel(size / 2, size / 2), capture.pixel(size / 2, size / 2));
+}
@@ -0,0 +1,20 @@
+#ifndef BACKGROUNDKEYERBENCHMARK_H
+#define BACKGROUNDKEYERBENCHMARK_H
+
+#include <QObject>
+
+/*!
+ * \brief The BackgroundKeyerBenchmark class compares the keying of the background of the object
+ * model previews to the former per-pixel one on synthetic captures of the gallery size and of the
+ * sizes of the previews on high-DPI displays.
+ */
+class BackgroundKeyerBenchmark : public QObject {
+
+    Q_OBJECT
+
+private Q_SLOTS:
+    void benchmarkKeyBackground_data();
+    void benchmarkKeyBackground();
+};
+
+#endif // BACKGROUNDKEYERBENCHMARK_H
@@ -0,0 +1,218 @@
+#include "meshloadertest.hpp"
+#include "view/rendering/meshloader.hpp"
+
+#include <QtTest>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+
+#include <cstring>
+
+//! A unit square of four vertices, split into a quad and a triangle
+static const QVector<float> PLY_POSITIONS = {0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0};
+static const QVector<QVector<quint32>> PLY_FACES = {{0, 1, 2, 3}, {0, 1, 3}};
+//! The quad is triangulated as a fan
+static const QVector<quint32> PLY_INDICES = {0, 1, 2, 0, 2, 3, 0, 1, 3};
+
+//! Faces reference the attributes relative to the ones read so far and combine them differently,
+//! i.e. the loader has to build vertices of their own for the combinations
+static const QByteArray OBJ =
+        "mtllib square.mtl\n"
+        "v 0 0 0\n"
+        "v 1 0 0\n"
+        "v 1 1 0\n"
+        "v 0 1 0\n"
+        "vt 0 0\n"
+        "vt 1 0\n"
+        "vt 1 1\n"
+        "vt 0 1\n"
+        "usemtl textured\n"
+        "f -4/-4 -3/-3 -2/-2 -1/-1\n"
+        "v 0 0 1\n"
+        "vt 0.5 0.5\n"
+        "usemtl plain\n"
+        "f 1/2 2/3 -1/-1\n"
+        "f -5/-5 -3/-3 -1/-1\n";
+
+static const QByteArray MATERIAL_LIBRARY =
+        "newmtl textured\n"
+        "Ka 0.2 0.2 0.2\n"
+        "map_Kd texture.png\n"
+        "newmtl plain\n"
+        "Ks 0.5 0.5 0.5\n";
+
+static bool writeFile(const QString &path, const QByteArray &content) {
+    QFile file(path);
+    return file.open(QFile::WriteOnly) && file.write(content) == content.size();
+}
+
+/*!
+ * \brief plyFile returns the square in the given format. Every vertex has a color as well,
+ * which the loader has to skip.
+ */
+static QByteArray plyFile(const QByteArray &format, quint32 lastFaceIndex = 3) {
+    QVector<QVector<quint32>> faces = PLY_FACES;
+    faces.last().last() = lastFaceIndex;
+    QByteArray content =
+            "ply\n"
+            "format " + format + " 1.0\n"
+            "element vertex 4\n"
+            "property float x\n"
+            "property float y\n"
+            "property float z\n"
+            "property uchar red\n"
+            "element face 2\n"
+            "property list uchar int vertex_indices\n"
+            "end_header\n";
+    if (format == "ascii") {
+        for (int vertex = 0; vertex < 4; vertex++) {
+            content += QByteArray::number(PLY_POSITIONS[3 * vertex]) + " "
+                    + QByteArray::number(PLY_POSITIONS[3 * vertex + 1]) + " "
+                    + QByteArray::number(PLY_POSITIONS[3 * vertex + 2]) + " 255\n";
+        }
+        for (const QVector<quint32> &face : faces) {
+            content += QByteArray::number(face.size());
+            for (quint32 index : face) {
+                content += " " + QByteArray::number(index);
+            }
+            content += "\n";
+        }
+        return content;
+    }
+    QByteArray body;
+    QDataStream stream(&body, QIODevice::WriteOnly);
+    stream.setByteOrder(format == "binary_big_endian" ? QDataStream::BigEndian : QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    for (int vertex = 0; vertex < 4; vertex++) {
+        stream << PLY_POSITIONS[3 * vertex] << PLY_POSITIONS[3 * vertex + 1]
+               << PLY_POSITIONS[3 * vertex + 2] << (quint8) 255;
+    }
+    for (const QVector<quint32> &face : faces) {
+        stream << (quint8) face.size();
+        for (quint32 index : face) {
+            stream << (qint32) index;
+        }
+    }
+    return content + body;
+}
+
+static QVector<quint32> indices(const MeshLoader::Mesh &mesh) {
+    QVector<quint32> indices(mesh.indexData.size() / (int) sizeof(quint32));
+    memcpy(indices.data(), mesh.indexData.constData(), mesh.indexData.size());
+    return indices;
+}
+
+//! The position, normal and, if present, texture coordinates of the vertex
+static QVector<float> vertex(const MeshLoader::Mesh &mesh, int vertex) {
+    QVector<float> values(mesh.byteStride() / (int) sizeof(float));
+    memcpy(values.data(), mesh.vertexData.constData() + vertex * mesh.byteStride(), mesh.byteStride());
+    return values;
+}
+
+void MeshLoaderTest::init() {
+    m_directory = new QTemporaryDir();
+    QVERIFY(m_directory->isValid());
+}
+
+void MeshLoaderTest::cleanup() {
+    delete m_directory;
+    m_directory = Q_NULLPTR;
+}
+
+QString MeshLoaderTest::filePath(const QString &fileName) const {
+    return QDir(m_directory->path()).absoluteFilePath(fileName);
+}
+
+void MeshLoaderTest::testLoadPly_data() {
+    QTest::addColumn<QByteArray>("format");
+
+    QTest::newRow("ascii") << QByteArray("ascii");
+    QTest::newRow("binary little endian") << QByteArray("binary_little_endian");
+    QTest::newRow("binary big endian") << QByteArray("binary_big_endian");
+}
+
+void MeshLoaderTest::testLoadPly() {
+    QFETCH(QByteArray, format);
+
+    QVERIFY(writeFile(filePath("square.ply"), plyFile(format)));
+    MeshLoader::Mesh mesh = MeshLoader::load(filePath("square.ply"));
+    QVERIFY2(mesh.valid, qPrintable(mesh.errorString));
+    QCOMPARE(mesh.vertexCount, 4);
+    QVERIFY(!mesh.hasTexCoords);
+    QCOMPARE(mesh.vertexData.size(), 4 * mesh.byteStride());
+    QCOMPARE(mesh.indexData.size() / (int) sizeof(quint32), 9);
+    QVERIFY(indices(mesh) == PLY_INDICES);
+    QCOMPARE(mesh.parts.size(), 1);
+    QCOMPARE(mesh.parts[0].firstIndex, 0);
+    QCOMPARE(mesh.parts[0].indexCount, 9);
+    // Both faces are counter-clockwise in the xy plane, i.e. the computed normals point along z
+    QVERIFY(vertex(mesh, 2) == QVector<float>({1, 1, 0, 0, 0, 1}));
+}
+
+void MeshLoaderTest::testLoadObj() {
+    QVERIFY(writeFile(filePath("square.obj"), OBJ));
+    QVERIFY(writeFile(filePath("square.mtl"), MATERIAL_LIBRARY));
+    MeshLoader::Mesh mesh = MeshLoader::load(filePath("square.obj"));
+    QVERIFY2(mesh.valid, qPrintable(mesh.errorString));
+    // The first face uses the four aligned combinations, the second one adds three combinations
+    // and the last one reuses combinations of both
+    QCOMPARE(mesh.vertexCount, 7);
+    QVERIFY(mesh.hasTexCoords);
+    QCOMPARE(mesh.vertexData.size(), 7 * mesh.byteStride());
+    QCOMPARE(mesh.indexData.size() / (int) sizeof(quint32), 12);
+    QVERIFY(indices(mesh) == QVector<quint32>({0, 1, 2, 0, 2, 3, 4, 5, 6, 0, 2, 6}));
+    // The position and texture coordinates, the normals are computed
+    QVERIFY(vertex(mesh, 4).mid(0, 3) == QVector<float>({0, 0, 0}));
+    QVERIFY(vertex(mesh, 4).mid(6) == QVector<float>({1, 0}));
+    QVERIFY(vertex(mesh, 6).mid(0, 3) == QVector<float>({0, 0, 1}));
+    QVERIFY(vertex(mesh, 6).mid(6) == QVector<float>({0.5f, 0.5f}));
+
+    // One part per material, in the order they are used first
+    QCOMPARE(mesh.parts.size(), 2);
+    QCOMPARE(mesh.parts[0].firstIndex, 0);
+    QCOMPARE(mesh.parts[0].indexCount, 6);
+    QCOMPARE(mesh.parts[0].diffuseTexturePath, filePath("texture.png"));
+    QVERIFY(qAbs(mesh.parts[0].ambient.redF() - 0.2) < 0.01);
+    QCOMPARE(mesh.parts[1].firstIndex, 6);
+    QCOMPARE(mesh.parts[1].indexCount, 6);
+    QVERIFY(mesh.parts[1].diffuseTexturePath.isEmpty());
+    QVERIFY(qAbs(mesh.parts[1].specular.redF() - 0.5) < 0.01);
+}
+
+void MeshLoaderTest::testReferencedFiles() {
+    QVERIFY(writeFile(filePath("square.obj"), OBJ));
+    QVERIFY(writeFile(filePath("square.mtl"), MATERIAL_LIBRARY));
+    QCOMPARE(MeshLoader::referencedFiles(filePath("square.obj")),
+             QStringList({filePath("square.mtl"), filePath("texture.png")}));
+
+    QByteArray ply = plyFile("ascii");
+    ply.insert(ply.indexOf("element"), "comment TextureFile texture.png\n");
+    QVERIFY(writeFile(filePath("square.ply"), ply));
+    QCOMPARE(MeshLoader::referencedFiles(filePath("square.ply")), QStringList({filePath("texture.png")}));
+}
+
+void MeshLoaderTest::testInvalidFileIsRejected_data() {
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<QByteArray>("content");
+
+    QByteArray truncatedPly = plyFile("binary_little_endian");
+    truncatedPly.chop(3);
+    QTest::newRow("truncated binary PLY") << "square.ply" << truncatedPly;
+    QTest::newRow("PLY index out of range") << "square.ply" << plyFile("ascii", 4);
+    QTest::newRow("PLY without faces") << "square.ply" << plyFile("ascii").replace("element face 2", "element face 0");
+    QTest::newRow("OBJ index out of range")
+            << "square.obj" << QByteArray("v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 4\n");
+    QTest::newRow("OBJ relative index out of range")
+            << "square.obj" << QByteArray("v 0 0 0\nv 1 0 0\nf -1 -2 -3\nv 1 1 0\n");
+    QTest::newRow("OBJ index zero") << "square.obj" << QByteArray("v 0 0 0\nv 1 0 0\nv 1 1 0\nf 0 1 2\n");
+}
+
+void MeshLoaderTest::testInvalidFileIsRejected() {
+    QFETCH(QString, fileName);
+    QFETCH(QByteArray, content);
+
+    QVERIFY(writeFile(filePath(fileName), content));
+    MeshLoader::Mesh mesh = MeshLoader::load(filePath(fileName));
+    QVERIFY(!mesh.valid);
+    QVERIFY(!mesh.errorString.isEmpty());
+}
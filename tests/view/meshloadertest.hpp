@@ -0,0 +1,33 @@
+#ifndef MESHLOADERTEST_H
+#define MESHLOADERTEST_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+/*!
+ * \brief The MeshLoaderTest class checks the vertex and index buffers MeshLoader parses from
+ * small ASCII and binary PLY files and from an OBJ file with relative indices and materials
+ * against counts and values worked out by hand.
+ */
+class MeshLoaderTest : public QObject {
+
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testLoadPly_data();
+    void testLoadPly();
+    void testLoadObj();
+    void testReferencedFiles();
+    void testInvalidFileIsRejected_data();
+    void testInvalidFileIsRejected();
+
+private:
+    QString filePath(const QString &fileName) const;
+
+private:
+    QTemporaryDir *m_directory = Q_NULLPTR;
+};
+
+#endif // MESHLOADERTEST_H
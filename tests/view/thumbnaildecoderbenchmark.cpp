@@ -0,0 +1,54 @@
+#include "thumbnaildecoderbenchmark.hpp"
+#include "view/gallery/thumbnaildecoder.hpp"
+
+#include <QtTest>
+#include <QDir>
+#include <QImage>
+#include <QPainter>
+
+//! The height of the thumbnails of the gallery
+static const int THUMBNAIL_HEIGHT = 300;
+static const int GENERATED_IMAGES = 20;
+
+void ThumbnailDecoderBenchmark::initTestCase() {
+    QString imagesPath = qEnvironmentVariable("THUMBNAIL_BENCHMARK_IMAGES");
+    if (imagesPath.isEmpty()) {
+        QVERIFY(m_imagesDir.isValid());
+        imagesPath = m_imagesDir.path();
+        //! Some structure instead of a plain color, JPEG decoding time depends on the content
+        QImage image(1920, 1080, QImage::Format_RGB888);
+        for (int i = 0; i < GENERATED_IMAGES; i++) {
+            image.fill(QColor::fromHsv(i * 360 / GENERATED_IMAGES, 200, 200));
+            QPainter painter(&image);
+            for (int x = 0; x < image.width(); x += 40) {
+                painter.drawLine(x, 0, image.width() - x, image.height());
+            }
+            painter.end();
+            QString extension = i % 2 == 0 ? "jpg" : "png";
+            QVERIFY(image.save(QDir(imagesPath).filePath(QString("%1.%2").arg(i).arg(extension))));
+        }
+    }
+
+    const QStringList nameFilters({"*.jpg", "*.jpeg", "*.png", "*.tiff"});
+    for (const QString &fileName : QDir(imagesPath).entryList(nameFilters, QDir::Files, QDir::Name)) {
+        m_imagePaths.append(QDir(imagesPath).filePath(fileName));
+    }
+    QVERIFY2(!m_imagePaths.isEmpty(), qPrintable("No images found in " + imagesPath));
+}
+
+void ThumbnailDecoderBenchmark::benchmarkDecode_data() {
+    QTest::addColumn<int>("method");
+    QTest::newRow("QImageReader scaled read") << (int) ThumbnailDecoder::ScaledRead;
+    QTest::newRow("Reduced decoding") << (int) ThumbnailDecoder::ReducedDecode;
+}
+
+void ThumbnailDecoderBenchmark::benchmarkDecode() {
+    QFETCH(int, method);
+    QBENCHMARK {
+        for (const QString &imagePath : m_imagePaths) {
+            QImage thumbnail = ThumbnailDecoder::decode(imagePath, THUMBNAIL_HEIGHT,
+                                                        (ThumbnailDecoder::Method) method);
+            QCOMPARE(thumbnail.height(), THUMBNAIL_HEIGHT);
+        }
+    }
+}
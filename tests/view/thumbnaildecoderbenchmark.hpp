@@ -0,0 +1,27 @@
+#ifndef THUMBNAILDECODERBENCHMARK_H
+#define THUMBNAILDECODERBENCHMARK_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTemporaryDir>
+
+/*!
+ * \brief The ThumbnailDecoderBenchmark class compares the ways of decoding the thumbnails of the
+ * gallery. The images are generated, set THUMBNAIL_BENCHMARK_IMAGES to the path of a folder to
+ * decode the images of a dataset instead.
+ */
+class ThumbnailDecoderBenchmark : public QObject {
+
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void benchmarkDecode_data();
+    void benchmarkDecode();
+
+private:
+    QTemporaryDir m_imagesDir;
+    QStringList m_imagePaths;
+};
+
+#endif // THUMBNAILDECODERBENCHMARK_H
@@ -1,5 +1,17 @@
-HEADERS +=
+HEADERS += \
+    $$PWD/../../src/view/gallery/thumbnaildecoder.hpp \
+    $$PWD/../../src/view/gallery/rendering/backgroundkeyer.hpp \
+    $$PWD/../../src/view/rendering/meshloader.hpp \
+    $$PWD/thumbnaildecoderbenchmark.hpp \
+    $$PWD/backgroundkeyerbenchmark.hpp \
+    $$PWD/meshloadertest.hpp
 
-SOURCES +=
+SOURCES += \
+    $$PWD/../../src/view/gallery/thumbnaildecoder.cpp \
+    $$PWD/../../src/view/gallery/rendering/backgroundkeyer.cpp \
+    $$PWD/../../src/view/rendering/meshloader.cpp \
+    $$PWD/thumbnaildecoderbenchmark.cpp \
+    $$PWD/backgroundkeyerbenchmark.cpp \
+    $$PWD/meshloadertest.cpp
 
 FORMS +=